@@ -0,0 +1,461 @@
+#include "Assembler.hpp"
+
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#define NOP_INSTRUCTION 0x00000020 // add $zero, $zero, $zero (same as the tests/ images)
+
+static const char *s_registerNames[32] = {
+  "zero", "at", "v0", "v1", "a0", "a1", "a2", "a3",
+  "t0", "t1", "t2", "t3", "t4", "t5", "t6", "t7",
+  "s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7",
+  "t8", "t9", "k0", "k1", "gp", "sp", "fp", "ra"
+};
+
+// `name' without the `$'; e.g., "t0" or "8"
+static bool lookupRegister(const std::string &name, unsigned *reg) {
+  if (!name.empty() && isdigit((unsigned char)name[0])) {
+    char *end;
+    unsigned long index = strtoul(name.c_str(), &end, 10);
+    if (*end == '\0' && index < 32) { *reg = (unsigned)index; return true; }
+  }
+  for (unsigned i = 0; i < 32; i++) {
+    if (name == s_registerNames[i]) { *reg = i; return true; }
+  }
+  return false;
+}
+
+static std::string trim(const std::string &text) {
+  size_t begin = 0, end = text.size();
+  while (begin < end && isspace((unsigned char)text[begin])) { begin++; }
+  while (end > begin && isspace((unsigned char)text[end - 1])) { end--; }
+  return text.substr(begin, end - begin);
+}
+
+bool Assembler::assemble(const char *sourceFileName) {
+  m_sourceFileName = sourceFileName;
+  m_statements.clear();
+  m_labels.clear();
+  m_text.clear();
+  m_data.clear();
+  if (!parse(sourceFileName)) {
+    return false;
+  }
+  if (m_fillDelaySlots && m_branchPadding > 0) {
+    fillDelaySlots();
+  }
+  return layout() && encode();
+}
+
+bool Assembler::writeImages(const char *prefix) const {
+  // <prefix>_instMemFile, <prefix>_dataMemFile and an empty <prefix>_regFile, as in tests/
+  std::string names[3] = {
+    std::string(prefix) + "_instMemFile",
+    std::string(prefix) + "_dataMemFile",
+    std::string(prefix) + "_regFile"
+  };
+  FILE *files[3];
+  for (int i = 0; i < 3; i++) {
+    files[i] = fopen(names[i].c_str(), "w");
+    if (files[i] == NULL) {
+      fprintf(stderr, "ERROR: cannot open `%s' for writing\n", names[i].c_str());
+      for (int j = 0; j < i; j++) { fclose(files[j]); }
+      return false;
+    }
+  }
+  for (size_t i = 0; i < m_text.size(); i++) {
+    fprintf(files[0], "%x %08lx\n", (unsigned)(m_textBase + 4 * i), (unsigned long)m_text[i]);
+  }
+  for (size_t i = 0; i < m_data.size(); i++) {
+    if (m_data[i] != 0) { // the memory starts zeroed
+      fprintf(files[1], "%x %08lx\n", (unsigned)(m_dataBase + 4 * i), (unsigned long)m_data[i]);
+    }
+  }
+  for (int i = 0; i < 3; i++) {
+    fclose(files[i]);
+  }
+  return true;
+}
+
+std::string Assembler::disassemble(const std::uint32_t instruction, const std::uint32_t pc) {
+  unsigned opcode = instruction >> 26;
+  const char *rs = s_registerNames[(instruction >> 21) & 0x1F];
+  const char *rt = s_registerNames[(instruction >> 16) & 0x1F];
+  const char *rd = s_registerNames[(instruction >> 11) & 0x1F];
+  int immediate = (std::int16_t)(instruction & 0xFFFF);
+  char text[64];
+  switch (opcode) {
+    case 0x00: {
+      const char *mnemonic = nullptr;
+      switch (instruction & 0x3F) {
+        case 0x0C: return "syscall";
+        case 0x10:
+        case 0x12:
+          snprintf(text, sizeof(text), "%s $%s", ((instruction & 0x3F) == 0x10) ? "mfhi" : "mflo", rd);
+          return text;
+        case 0x18:
+        case 0x19:
+        case 0x1A:
+        case 0x1B: {
+          static const char *const s_mulDiv[] = {"mult", "multu", "div", "divu"};
+          snprintf(text, sizeof(text), "%s $%s, $%s", s_mulDiv[(instruction & 0x3F) - 0x18], rs, rt);
+          return text;
+        }
+        case 0x20: mnemonic = "add"; break;
+        case 0x22: mnemonic = "sub"; break;
+        case 0x24: mnemonic = "and"; break;
+        case 0x25: mnemonic = "or"; break;
+        case 0x2A: mnemonic = "slt"; break;
+      }
+      if (instruction == NOP_INSTRUCTION) {
+        return "nop";
+      }
+      if (mnemonic == nullptr) {
+        break;
+      }
+      snprintf(text, sizeof(text), "%s $%s, $%s, $%s", mnemonic, rd, rs, rt);
+      return text;
+    }
+    case 0x08:
+      snprintf(text, sizeof(text), "addi $%s, $%s, %d", rt, rs, immediate);
+      return text;
+    case 0x23:
+    case 0x2B:
+      snprintf(text, sizeof(text), "%s $%s, %d($%s)", (opcode == 0x23) ? "lw" : "sw", rt, immediate, rs);
+      return text;
+    case 0x04:
+      snprintf(text, sizeof(text), "beq $%s, $%s, 0x%x", rs, rt, (unsigned)(pc + 4 + 4 * immediate));
+      return text;
+  }
+  snprintf(text, sizeof(text), ".word 0x%08lx", (unsigned long)instruction);
+  return text;
+}
+
+bool Assembler::parse(const char *sourceFileName) {
+  FILE *sourceFile = fopen(sourceFileName, "r");
+  if (sourceFile == NULL) {
+    fprintf(stderr, "ERROR: cannot open `%s'\n", sourceFileName);
+    return false;
+  }
+  bool inText = true;
+  char buffer[1024];
+  for (int line = 1; fgets(buffer, sizeof(buffer), sourceFile) != NULL; line++) {
+    // strip the comment (a `#' outside of a string or character literal)
+    std::string text;
+    char quote = 0;
+    for (const char *p = buffer; *p != '\0' && *p != '\n'; p++) {
+      if (quote == 0 && *p == '#') { break; }
+      if (quote != 0 && *p == '\\' && p[1] != '\0') { text += *p++; }
+      else if (*p == '"' || *p == '\'') { quote = (quote == 0) ? *p : (quote == *p ? 0 : quote); }
+      text += *p;
+    }
+    text = trim(text);
+
+    Statement stmt;
+    stmt.line = line;
+    stmt.padding = 0;
+    stmt.inSlot = false;
+    // label(s)
+    size_t colon;
+    while ((colon = text.find(':')) != std::string::npos && text.find('"') > colon) {
+      std::string label = trim(text.substr(0, colon));
+      Statement labelStmt = stmt;
+      labelStmt.inText = inText;
+      labelStmt.label = label;
+      if (label.empty() || m_labels.count(label) != 0) {
+        fclose(sourceFile);
+        return error(labelStmt, "empty or duplicate label");
+      }
+      m_labels[label] = 0; // resolved in layout()
+      m_statements.push_back(labelStmt);
+      text = trim(text.substr(colon + 1));
+    }
+    if (text.empty()) { continue; }
+
+    // mnemonic and comma-separated operands
+    size_t space = 0;
+    while (space < text.size() && !isspace((unsigned char)text[space])) { space++; }
+    stmt.mnemonic = text.substr(0, space);
+    std::string rest = trim(text.substr(space));
+    std::string operand;
+    quote = 0;
+    for (size_t i = 0; i < rest.size(); i++) {
+      if (quote != 0 && rest[i] == '\\' && i + 1 < rest.size()) { operand += rest[i++]; operand += rest[i]; continue; }
+      if (rest[i] == '"' || rest[i] == '\'') { quote = (quote == 0) ? rest[i] : (quote == rest[i] ? 0 : quote); }
+      if (quote == 0 && rest[i] == ',') { stmt.operands.push_back(trim(operand)); operand.clear(); continue; }
+      operand += rest[i];
+    }
+    if (!trim(operand).empty()) { stmt.operands.push_back(trim(operand)); }
+
+    if (stmt.mnemonic == ".text") { inText = true; continue; }
+    if (stmt.mnemonic == ".data") { inText = false; continue; }
+    if (stmt.mnemonic == ".globl") { continue; }
+    stmt.inText = inText;
+    if (inText && (stmt.mnemonic == "beq" || stmt.mnemonic == "b")) {
+      stmt.padding = m_branchPadding;
+    }
+    m_statements.push_back(stmt);
+  }
+  fclose(sourceFile);
+  return true;
+}
+
+// the register an instruction writes (false for none, $zero, or malformed operands)
+static bool writtenRegister(const std::string &mnemonic, const std::vector<std::string> &operands, unsigned *reg) {
+  if (mnemonic.empty() || mnemonic[0] == '.' || mnemonic == "sw" || mnemonic == "beq" || mnemonic == "b"
+      || mnemonic == "nop" || mnemonic == "syscall" || mnemonic == "mult" || mnemonic == "multu"
+      || mnemonic == "div" || mnemonic == "divu") {
+    return false;
+  }
+  return !operands.empty() && operands[0].size() >= 2 && lookupRegister(operands[0].substr(1), reg) && *reg != 0;
+}
+
+// whether a beq reads `reg' (b reads only $zero)
+static bool branchReads(const std::vector<std::string> &operands, const unsigned reg) {
+  unsigned source;
+  for (size_t i = 0; i < 2 && i < operands.size(); i++) {
+    if (operands[i].size() >= 2 && lookupRegister(operands[i].substr(1), &source) && source == reg) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Assembler::fillDelaySlots() {
+  for (size_t i = 1; i < m_statements.size(); i++) {
+    Statement &branch = m_statements[i];
+    Statement &prev = m_statements[i - 1];
+    if (!branch.inText || (branch.mnemonic != "beq" && branch.mnemonic != "b")) { continue; }
+    // the statement right before the branch (no label in between: a jump to the branch would skip it)
+    if (!prev.inText || prev.mnemonic.empty() || prev.inSlot) { continue; }
+    const std::string &m = prev.mnemonic;
+    if (m == "nop" || m == "syscall" || m == "beq" || m == "b") { continue; }
+    unsigned dest;
+    if (branch.mnemonic == "beq") {
+      // the branch must not read what the instruction writes
+      if (writtenRegister(m, prev.operands, &dest) && branchReads(branch.operands, dest)) { continue; }
+      // nor would it gain anything if the instruction before that one then fed it right before it resolves
+      if (i >= 2 && m_statements[i - 2].inText
+          && writtenRegister(m_statements[i - 2].mnemonic, m_statements[i - 2].operands, &dest)
+          && branchReads(branch.operands, dest)) {
+        continue;
+      }
+    }
+    // branch, the moved instruction, then the rest of the padding
+    std::swap(branch, prev);
+    m_statements[i].inSlot = true;
+    m_statements[i].padding = m_statements[i - 1].padding - 1;
+    m_statements[i - 1].padding = 0;
+  }
+}
+
+unsigned Assembler::sizeOf(const Statement &stmt) const {
+  if (stmt.mnemonic.empty()) { return 0; }
+  if (stmt.inText) {
+    return 4 * (1 + stmt.padding);
+  }
+  if (stmt.mnemonic == ".word") { return 4 * stmt.operands.size(); }
+  if (stmt.mnemonic == ".space") {
+    std::int64_t size = 0;
+    parseValue(stmt, stmt.operands.empty() ? "" : stmt.operands[0], &size);
+    return (unsigned)((size + 3) & ~3);
+  }
+  if (stmt.mnemonic == ".asciiz") {
+    // the string, its terminator, then padding to the next word
+    unsigned length = 0;
+    const std::string &literal = stmt.operands.empty() ? "" : stmt.operands[0];
+    for (size_t i = 1; i + 1 < literal.size(); i++, length++) {
+      if (literal[i] == '\\') { i++; }
+    }
+    return (length + 1 + 3) & ~3u;
+  }
+  return 0;
+}
+
+bool Assembler::layout() {
+  std::uint32_t textAddr = m_textBase, dataAddr = m_dataBase;
+  for (size_t i = 0; i < m_statements.size(); i++) {
+    const Statement &stmt = m_statements[i];
+    std::uint32_t &addr = stmt.inText ? textAddr : dataAddr;
+    if (!stmt.label.empty()) {
+      m_labels[stmt.label] = addr;
+    }
+    addr += sizeOf(stmt);
+  }
+  return true;
+}
+
+bool Assembler::encode() {
+  std::uint32_t pc = m_textBase;
+  for (size_t i = 0; i < m_statements.size(); i++) {
+    const Statement &stmt = m_statements[i];
+    if (stmt.mnemonic.empty()) { continue; }
+    if (stmt.inText) {
+      if (!encodeInstruction(stmt, pc)) { return false; }
+      pc += sizeOf(stmt);
+    } else if (!encodeData(stmt)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Assembler::encodeInstruction(const Statement &stmt, std::uint32_t pc) {
+  const std::string &m = stmt.mnemonic;
+  const std::vector<std::string> &ops = stmt.operands;
+  unsigned rs = 0, rt = 0, rd = 0;
+  std::int64_t imm = 0;
+  std::uint32_t opcode = 0, funct = 0;
+
+  if (m == "add" || m == "sub" || m == "and" || m == "or" || m == "slt") {
+    if (ops.size() != 3) { return error(stmt, "expected `rd, rs, rt'"); }
+    if (!parseRegister(stmt, ops[0], &rd) || !parseRegister(stmt, ops[1], &rs)
+        || !parseRegister(stmt, ops[2], &rt)) { return false; }
+    funct = (m == "add") ? 0x20 : (m == "sub") ? 0x22 : (m == "and") ? 0x24 : (m == "or") ? 0x25 : 0x2A;
+  } else if (m == "mult" || m == "multu" || m == "div" || m == "divu") {
+    if (ops.size() != 2) { return error(stmt, "expected `rs, rt'"); }
+    if (!parseRegister(stmt, ops[0], &rs) || !parseRegister(stmt, ops[1], &rt)) { return false; }
+    funct = (m == "mult") ? 0x18 : (m == "multu") ? 0x19 : (m == "div") ? 0x1A : 0x1B;
+  } else if (m == "mfhi" || m == "mflo") {
+    if (ops.size() != 1) { return error(stmt, "expected `rd'"); }
+    if (!parseRegister(stmt, ops[0], &rd)) { return false; }
+    funct = (m == "mfhi") ? 0x10 : 0x12;
+  } else if (m == "move") {
+    if (ops.size() != 2) { return error(stmt, "expected `rd, rs'"); }
+    if (!parseRegister(stmt, ops[0], &rd) || !parseRegister(stmt, ops[1], &rs)) { return false; }
+    funct = 0x20;
+  } else if (m == "nop") {
+    m_text.push_back(NOP_INSTRUCTION);
+    return true;
+  } else if (m == "syscall") {
+    funct = 0x0C;
+  } else if (m == "addi" || m == "li" || m == "la") {
+    opcode = 0x08;
+    size_t immIndex = (m == "addi") ? 2 : 1;
+    if (ops.size() != immIndex + 1) { return error(stmt, "wrong number of operands"); }
+    if (!parseRegister(stmt, ops[0], &rt)) { return false; }
+    if (m == "addi" && !parseRegister(stmt, ops[1], &rs)) { return false; }
+    if (!parseValue(stmt, ops[immIndex], &imm)) { return false; }
+  } else if (m == "lw" || m == "sw") {
+    opcode = (m == "lw") ? 0x23 : 0x2B;
+    if (ops.size() != 2) { return error(stmt, "expected `rt, offset(rs)'"); }
+    if (!parseRegister(stmt, ops[0], &rt) || !parseMemOperand(stmt, ops[1], &imm, &rs)) { return false; }
+  } else if (m == "beq" || m == "b") {
+    opcode = 0x04;
+    std::int64_t target = 0;
+    if (m == "beq") {
+      if (ops.size() != 3) { return error(stmt, "expected `rs, rt, label'"); }
+      if (!parseRegister(stmt, ops[0], &rs) || !parseRegister(stmt, ops[1], &rt)
+          || !parseValue(stmt, ops[2], &target)) { return false; }
+    } else {
+      if (ops.size() != 1) { return error(stmt, "expected `label'"); }
+      if (!parseValue(stmt, ops[0], &target)) { return false; }
+    }
+    imm = (target - (std::int64_t)(pc + 4)) / 4;
+  } else {
+    return error(stmt, "unsupported instruction");
+  }
+
+  if (opcode != 0 && (imm < -32768 || imm > 32767)) {
+    return error(stmt, "immediate does not fit in 16 bits");
+  }
+  if (opcode == 0) {
+    m_text.push_back((rs << 21) | (rt << 16) | (rd << 11) | funct);
+  } else {
+    m_text.push_back((opcode << 26) | (rs << 21) | (rt << 16) | ((std::uint32_t)imm & 0xFFFF));
+  }
+  for (unsigned i = 0; i < stmt.padding; i++) {
+    m_text.push_back(NOP_INSTRUCTION);
+  }
+  return true;
+}
+
+bool Assembler::encodeData(const Statement &stmt) {
+  if (stmt.mnemonic == ".word") {
+    for (size_t i = 0; i < stmt.operands.size(); i++) {
+      std::int64_t value;
+      if (!parseValue(stmt, stmt.operands[i], &value)) { return false; }
+      m_data.push_back((std::uint32_t)value);
+    }
+  } else if (stmt.mnemonic == ".space") {
+    m_data.resize(m_data.size() + sizeOf(stmt) / 4, 0);
+  } else if (stmt.mnemonic == ".asciiz") {
+    if (stmt.operands.size() != 1 || stmt.operands[0].size() < 2 || stmt.operands[0][0] != '"') {
+      return error(stmt, "expected a string literal");
+    }
+    const std::string &literal = stmt.operands[0];
+    size_t base = m_data.size();
+    m_data.resize(base + sizeOf(stmt) / 4, 0);
+    unsigned offset = 0;
+    for (size_t i = 1; i + 1 < literal.size(); i++, offset++) {
+      char c = literal[i];
+      if (c == '\\') {
+        c = literal[++i];
+        c = (c == 'n') ? '\n' : (c == 't') ? '\t' : (c == '0') ? '\0' : c;
+      }
+      // little-endian packing, as the data memory is little-endian
+      m_data[base + offset / 4] |= (std::uint32_t)(std::uint8_t)c << (8 * (offset % 4));
+    }
+  } else {
+    return error(stmt, "unsupported directive");
+  }
+  return true;
+}
+
+bool Assembler::parseRegister(const Statement &stmt, const std::string &text, unsigned *reg) const {
+  if (text.size() < 2 || text[0] != '$') { return error(stmt, "expected a register"); }
+  if (lookupRegister(text.substr(1), reg)) { return true; }
+  return error(stmt, "unknown register");
+}
+
+bool Assembler::parseValue(const Statement &stmt, const std::string &text, std::int64_t *value) const {
+  if (text.empty()) { return error(stmt, "missing operand"); }
+  if (text.size() >= 3 && text[0] == '\'') {
+    char c = text[1];
+    if (c == '\\') { c = (text[2] == 'n') ? '\n' : (text[2] == 't') ? '\t' : (text[2] == '0') ? '\0' : text[2]; }
+    *value = (unsigned char)c;
+    return true;
+  }
+  if (isdigit((unsigned char)text[0]) || text[0] == '-' || text[0] == '+') {
+    char *end;
+    *value = strtoll(text.c_str(), &end, 0);
+    if (*end == '\0') { return true; }
+    return error(stmt, "malformed number");
+  }
+  // label, optionally followed by `+offset' or `-offset'
+  size_t sign = text.find_first_of("+-");
+  std::string label = trim(text.substr(0, sign));
+  std::map<std::string, std::uint32_t>::const_iterator it = m_labels.find(label);
+  if (it == m_labels.end()) { return error(stmt, "undefined label"); }
+  *value = it->second;
+  if (sign != std::string::npos) {
+    std::int64_t offset;
+    if (!parseValue(stmt, trim(text.substr(sign + 1)), &offset)) { return false; }
+    *value += (text[sign] == '+') ? offset : -offset;
+  }
+  return true;
+}
+
+bool Assembler::parseMemOperand(const Statement &stmt, const std::string &text, std::int64_t *offset,
+                                unsigned *base) const {
+  // offset($rs), ($rs), label or label($rs)
+  size_t open = text.find('(');
+  *base = 0;
+  *offset = 0;
+  if (open == std::string::npos) {
+    return parseValue(stmt, text, offset);
+  }
+  size_t close = text.find(')', open);
+  if (close == std::string::npos) { return error(stmt, "missing `)'"); }
+  if (!parseRegister(stmt, trim(text.substr(open + 1, close - open - 1)), base)) { return false; }
+  std::string offsetText = trim(text.substr(0, open));
+  return offsetText.empty() || parseValue(stmt, offsetText, offset);
+}
+
+bool Assembler::error(const Statement &stmt, const char *message) const {
+  fprintf(stderr, "ERROR: %s:%d: %s (`%s')\n", m_sourceFileName.c_str(), stmt.line, message,
+          stmt.mnemonic.empty() ? stmt.label.c_str() : stmt.mnemonic.c_str());
+  return false;
+}
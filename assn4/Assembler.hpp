@@ -0,0 +1,74 @@
+#ifndef __ASSEMBLER_HPP__
+#define __ASSEMBLER_HPP__
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+/******************************************************************************/
+/* Assembler                                                                  */
+/*   - A two-pass assembler for the MIPS subset the simulated CPUs implement */
+/*     (add, sub, and, or, slt, mult, multu, div, divu, mfhi, mflo, addi,     */
+/*     lw, sw, beq, syscall)                                                  */
+/*   - Pseudo-instructions: nop, b, li, la, move                              */
+/*   - Directives: .text, .data, .word, .space, .asciiz                       */
+/*   - Writes the instruction and data images in the memory initialization   */
+/*     file format (see Memory::Memory)                                       */
+/*   - Assembler::disassemble turns an instruction word back into text       */
+/*     (used by the profiling and tracing tools)                             */
+/******************************************************************************/
+class Assembler {
+  public:
+    Assembler(const std::uint32_t textBase = 0x0, const std::uint32_t dataBase = 0x0)
+      : m_textBase(textBase), m_dataBase(dataBase), m_branchPadding(0), m_fillDelaySlots(false) { }
+    // insert `count' nops after every branch (for pipelines without a flush; 1 = the delay slot of a
+    // CPU with enableDelaySlot)
+    void setBranchPadding(const unsigned count) { m_branchPadding = count; }
+    // move the instruction before a branch into the first nop after it when the branch does not
+    // depend on it and nothing jumps in between (needs a padding of at least 1)
+    void setFillDelaySlots(const bool fill) { m_fillDelaySlots = fill; }
+    bool assemble(const char *sourceFileName);
+    bool writeImages(const char *prefix) const;
+    const std::vector<std::uint32_t> &text() const { return m_text; }
+    const std::vector<std::uint32_t> &data() const { return m_data; }
+    std::uint32_t textBase() const { return m_textBase; }
+    std::uint32_t dataBase() const { return m_dataBase; }
+    // e.g., "lw $t0, 4($sp)"; a branch shows its target (computed from `pc'), unknown words show as .word
+    static std::string disassemble(const std::uint32_t instruction, const std::uint32_t pc);
+  private:
+    struct Statement {
+      int line;                        // source line (for error messages)
+      bool inText;                     // .text or .data
+      std::string label;               // label defined at this statement (may be empty)
+      std::string mnemonic;            // instruction or directive (may be empty)
+      std::vector<std::string> operands;
+      unsigned padding;                // nops emitted after the instruction
+      bool inSlot;                     // moved into the delay slot of the branch before it
+    };
+    bool parse(const char *sourceFileName);
+    void fillDelaySlots();
+    bool layout();
+    bool encode();
+    bool encodeInstruction(const Statement &stmt, std::uint32_t pc);
+    bool encodeData(const Statement &stmt);
+    unsigned sizeOf(const Statement &stmt) const; // in bytes
+    bool parseRegister(const Statement &stmt, const std::string &text, unsigned *reg) const;
+    bool parseValue(const Statement &stmt, const std::string &text, std::int64_t *value) const;
+    bool parseMemOperand(const Statement &stmt, const std::string &text, std::int64_t *offset,
+                         unsigned *base) const;
+    bool error(const Statement &stmt, const char *message) const;
+
+    std::uint32_t m_textBase;
+    std::uint32_t m_dataBase;
+    unsigned m_branchPadding;
+    bool m_fillDelaySlots;
+    std::string m_sourceFileName;
+    std::vector<Statement> m_statements;
+    std::map<std::string, std::uint32_t> m_labels;
+    std::vector<std::uint32_t> m_text;
+    std::vector<std::uint32_t> m_data;
+};
+
+#endif
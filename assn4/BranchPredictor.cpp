@@ -0,0 +1,115 @@
+#include "BranchPredictor.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+static bool isPowerOfTwo(const unsigned long value) {
+  return value > 0 && (value & (value - 1)) == 0;
+}
+
+BranchTargetBuffer::BranchTargetBuffer(const unsigned entries) : m_entries(entries), m_mask(entries - 1) {
+  assert(isPowerOfTwo(entries));
+  for (size_t i = 0; i < m_entries.size(); i++) {
+    m_entries[i].valid = false;
+    m_entries[i].pc = m_entries[i].target = 0;
+  }
+}
+
+std::string BranchPredictor::btbSuffix() const {
+  char suffix[32];
+  snprintf(suffix, sizeof(suffix), ",btb=%u", m_btb.size());
+  return suffix;
+}
+
+BimodalPredictor::BimodalPredictor(const unsigned entries, const unsigned btbEntries)
+  : BranchPredictor(btbEntries), m_counters(entries, 1), m_mask(entries - 1) {
+  assert(isPowerOfTwo(entries));
+}
+
+std::string BimodalPredictor::name() const {
+  char name[64];
+  snprintf(name, sizeof(name), "bimodal:%zu", m_counters.size());
+  return name + btbSuffix();
+}
+
+GSharePredictor::GSharePredictor(const unsigned entries, const unsigned historyBits, const unsigned btbEntries)
+  : BranchPredictor(btbEntries), m_counters(entries, 1), m_mask(entries - 1), m_historyBits(historyBits),
+    m_historyMask((historyBits >= 32) ? 0xFFFFFFFFu : (1u << historyBits) - 1), m_history(0) {
+  assert(isPowerOfTwo(entries));
+}
+
+std::string GSharePredictor::name() const {
+  char name[64];
+  snprintf(name, sizeof(name), "gshare:%zu:%u", m_counters.size(), m_historyBits);
+  return name + btbSuffix();
+}
+
+TournamentPredictor::TournamentPredictor(const unsigned entries, const unsigned historyBits,
+                                         const unsigned btbEntries)
+  : BranchPredictor(btbEntries), m_local(entries, 1), m_global(entries, 1), m_chooser(entries, 1),
+    m_mask(entries - 1), m_historyBits(historyBits),
+    m_historyMask((historyBits >= 32) ? 0xFFFFFFFFu : (1u << historyBits) - 1), m_history(0) {
+  assert(isPowerOfTwo(entries));
+}
+
+std::string TournamentPredictor::name() const {
+  char name[64];
+  snprintf(name, sizeof(name), "tournament:%zu:%u", m_local.size(), m_historyBits);
+  return name + btbSuffix();
+}
+
+// splits "kind:a:b,btb=n" into its parts; the missing numbers keep their defaults
+BranchPredictor *BranchPredictor::create(const std::string &spec, const unsigned btbEntries) {
+  std::string kind = spec, options;
+  size_t comma = spec.find(',');
+  if (comma != std::string::npos) {
+    kind = spec.substr(0, comma);
+    options = spec.substr(comma + 1);
+  }
+  unsigned long btb = btbEntries;
+  if (!options.empty()) {
+    if (options.compare(0, 4, "btb=") != 0) {
+      return nullptr;
+    }
+    char *end;
+    btb = strtoul(options.c_str() + 4, &end, 0);
+    if (*end != '\0') {
+      return nullptr;
+    }
+  }
+  std::vector<unsigned long> numbers;
+  size_t colon = kind.find(':');
+  std::string name = kind.substr(0, colon);
+  while (colon != std::string::npos) {
+    char *end;
+    numbers.push_back(strtoul(kind.c_str() + colon + 1, &end, 0));
+    if (*end != '\0' && *end != ':') {
+      return nullptr;
+    }
+    colon = kind.find(':', colon + 1);
+  }
+  if (!isPowerOfTwo(btb)) {
+    return nullptr;
+  }
+
+  if (name == "nt" && numbers.empty()) {
+    return new StaticNotTakenPredictor((unsigned)btb);
+  } else if (name == "btfn" && numbers.empty()) {
+    return new StaticBTFNPredictor((unsigned)btb);
+  } else if (name == "bimodal" && numbers.size() <= 1) {
+    unsigned long entries = numbers.empty() ? 4096 : numbers[0];
+    return isPowerOfTwo(entries) ? new BimodalPredictor((unsigned)entries, (unsigned)btb) : nullptr;
+  } else if ((name == "gshare" || name == "tournament") && numbers.size() <= 2) {
+    unsigned long entries = numbers.empty() ? 4096 : numbers[0];
+    unsigned long historyBits = (numbers.size() < 2) ? 12 : numbers[1];
+    if (!isPowerOfTwo(entries) || historyBits > 32) {
+      return nullptr;
+    }
+    if (name == "gshare") {
+      return new GSharePredictor((unsigned)entries, (unsigned)historyBits, (unsigned)btb);
+    }
+    return new TournamentPredictor((unsigned)entries, (unsigned)historyBits, (unsigned)btb);
+  }
+  return nullptr;
+}
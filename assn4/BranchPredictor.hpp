@@ -0,0 +1,190 @@
+#ifndef __BRANCH_PREDICTOR_HPP__
+#define __BRANCH_PREDICTOR_HPP__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/******************************************************************************/
+/* BranchTargetBuffer                                                         */
+/*   - Direct-mapped cache of the targets of the taken branches, indexed and */
+/*     tagged by the PC; filled when a branch resolves taken                */
+/******************************************************************************/
+class BranchTargetBuffer {
+  public:
+    BranchTargetBuffer(const unsigned entries);
+    bool lookup(const std::uint32_t pc, std::uint32_t *target) const {
+      const Entry &entry = m_entries[(pc >> 2) & m_mask];
+      if (entry.valid && entry.pc == pc) {
+        *target = entry.target;
+        return true;
+      }
+      return false;
+    }
+    void update(const std::uint32_t pc, const std::uint32_t target) {
+      Entry &entry = m_entries[(pc >> 2) & m_mask];
+      entry.valid = true;
+      entry.pc = pc;
+      entry.target = target;
+    }
+    unsigned size() const { return (unsigned)m_entries.size(); }
+  private:
+    struct Entry {
+      bool valid;
+      std::uint32_t pc;
+      std::uint32_t target;
+    };
+    std::vector<Entry> m_entries;
+    std::uint32_t m_mask;
+};
+
+/******************************************************************************/
+/* BranchPredictor                                                            */
+/*   - Predicts the next fetch PC in IF: the BTB supplies the target of a    */
+/*     branch seen before, the direction predictor decides whether to take */
+/*     it                                                                     */
+/*   - Trained in MEM, when the branch resolves                              */
+/*   - Direction predictors (see create): static not-taken, static BTFN     */
+/*     (backward taken, forward not taken), bimodal (2-bit counters indexed */
+/*     by the PC), gshare (2-bit counters indexed by the PC xor the global  */
+/*     history) and tournament (a bimodal and a gshare table, and 2-bit     */
+/*     counters choosing between them per PC)                                */
+/******************************************************************************/
+class BranchPredictor {
+  public:
+    BranchPredictor(const unsigned btbEntries) : m_btb(btbEntries), m_branches(0), m_mispredictions(0) { }
+    virtual ~BranchPredictor() { }
+    // the spec that creates an equal predictor, e.g., "gshare:4096:12,btb=512"
+    virtual std::string name() const = 0;
+    // the PC to fetch after the instruction at `pc'
+    std::uint32_t predict(const std::uint32_t pc) const {
+      std::uint32_t target;
+      if (m_btb.lookup(pc, &target) && predictTaken(pc, target)) {
+        return target;
+      }
+      return pc + 4;
+    }
+    // the conditional branch at `pc' resolved; `mispredicted' if IF fetched the wrong path after it
+    void resolve(const std::uint32_t pc, const bool taken, const std::uint32_t target, const bool mispredicted) {
+      m_branches++;
+      m_mispredictions += mispredicted ? 1 : 0;
+      if (taken) {
+        m_btb.update(pc, target);
+      }
+      update(pc, taken, target);
+    }
+    std::uint64_t getBranches() const { return m_branches; }
+    std::uint64_t getMispredictions() const { return m_mispredictions; }
+    double accuracy() const { return (m_branches > 0) ? 1.0 - (double)m_mispredictions / m_branches : 1.0; }
+
+    // "nt", "btfn", "bimodal[:entries]", "gshare[:entries[:historyBits]]" or
+    // "tournament[:entries[:historyBits]]", optionally followed by ",btb=entries" (default `btbEntries');
+    // the sizes are powers of two; nullptr if `spec' is malformed
+    static BranchPredictor *create(const std::string &spec, const unsigned btbEntries = 512);
+  protected:
+    virtual bool predictTaken(const std::uint32_t pc, const std::uint32_t target) const = 0;
+    virtual void update(const std::uint32_t pc, const bool taken, const std::uint32_t target) = 0;
+    std::string btbSuffix() const;
+  private:
+    BranchTargetBuffer m_btb;
+    std::uint64_t m_branches;
+    std::uint64_t m_mispredictions;
+};
+
+class StaticNotTakenPredictor final : public BranchPredictor {
+  public:
+    StaticNotTakenPredictor(const unsigned btbEntries) : BranchPredictor(btbEntries) { }
+    virtual std::string name() const { return "nt"; }
+  protected:
+    virtual bool predictTaken(const std::uint32_t, const std::uint32_t) const { return false; }
+    virtual void update(const std::uint32_t, const bool, const std::uint32_t) { }
+};
+
+class StaticBTFNPredictor final : public BranchPredictor {
+  public:
+    StaticBTFNPredictor(const unsigned btbEntries) : BranchPredictor(btbEntries) { }
+    virtual std::string name() const { return "btfn" + btbSuffix(); }
+  protected:
+    virtual bool predictTaken(const std::uint32_t pc, const std::uint32_t target) const { return target <= pc; }
+    virtual void update(const std::uint32_t, const bool, const std::uint32_t) { }
+};
+
+// 2-bit saturating counters; 0, 1 predict not taken, 2, 3 predict taken
+class BimodalPredictor final : public BranchPredictor {
+  public:
+    BimodalPredictor(const unsigned entries, const unsigned btbEntries);
+    virtual std::string name() const;
+  protected:
+    virtual bool predictTaken(const std::uint32_t pc, const std::uint32_t) const {
+      return m_counters[(pc >> 2) & m_mask] >= 2;
+    }
+    virtual void update(const std::uint32_t pc, const bool taken, const std::uint32_t) {
+      std::uint8_t &counter = m_counters[(pc >> 2) & m_mask];
+      if (taken && counter < 3) { counter++; }
+      if (!taken && counter > 0) { counter--; }
+    }
+  private:
+    std::vector<std::uint8_t> m_counters;
+    std::uint32_t m_mask;
+};
+
+// the global history is updated when a branch resolves (not speculatively in IF)
+class GSharePredictor final : public BranchPredictor {
+  public:
+    GSharePredictor(const unsigned entries, const unsigned historyBits, const unsigned btbEntries);
+    virtual std::string name() const;
+  protected:
+    virtual bool predictTaken(const std::uint32_t pc, const std::uint32_t) const {
+      return m_counters[index(pc)] >= 2;
+    }
+    virtual void update(const std::uint32_t pc, const bool taken, const std::uint32_t) {
+      std::uint8_t &counter = m_counters[index(pc)];
+      if (taken && counter < 3) { counter++; }
+      if (!taken && counter > 0) { counter--; }
+      m_history = ((m_history << 1) | (taken ? 1 : 0)) & m_historyMask;
+    }
+  private:
+    std::uint32_t index(const std::uint32_t pc) const { return ((pc >> 2) ^ m_history) & m_mask; }
+    std::vector<std::uint8_t> m_counters;
+    std::uint32_t m_mask;
+    unsigned m_historyBits;
+    std::uint32_t m_historyMask;
+    std::uint32_t m_history;
+};
+
+// the chooser counters move toward the table that was right when the two disagree (2, 3 pick gshare)
+class TournamentPredictor final : public BranchPredictor {
+  public:
+    TournamentPredictor(const unsigned entries, const unsigned historyBits, const unsigned btbEntries);
+    virtual std::string name() const;
+  protected:
+    virtual bool predictTaken(const std::uint32_t pc, const std::uint32_t) const {
+      std::uint32_t local = (pc >> 2) & m_mask;
+      return (m_chooser[local] >= 2) ? m_global[globalIndex(pc)] >= 2 : m_local[local] >= 2;
+    }
+    virtual void update(const std::uint32_t pc, const bool taken, const std::uint32_t) {
+      std::uint32_t local = (pc >> 2) & m_mask;
+      std::uint8_t &localCounter = m_local[local];
+      std::uint8_t &globalCounter = m_global[globalIndex(pc)];
+      bool localRight = (localCounter >= 2) == taken, globalRight = (globalCounter >= 2) == taken;
+      std::uint8_t &chooser = m_chooser[local];
+      if (globalRight && !localRight && chooser < 3) { chooser++; }
+      if (localRight && !globalRight && chooser > 0) { chooser--; }
+      if (taken && localCounter < 3) { localCounter++; }
+      if (!taken && localCounter > 0) { localCounter--; }
+      if (taken && globalCounter < 3) { globalCounter++; }
+      if (!taken && globalCounter > 0) { globalCounter--; }
+      m_history = ((m_history << 1) | (taken ? 1 : 0)) & m_historyMask;
+    }
+  private:
+    std::uint32_t globalIndex(const std::uint32_t pc) const { return ((pc >> 2) ^ m_history) & m_mask; }
+    std::vector<std::uint8_t> m_local;
+    std::vector<std::uint8_t> m_global;
+    std::vector<std::uint8_t> m_chooser;
+    std::uint32_t m_mask;
+    unsigned m_historyBits;
+    std::uint32_t m_historyMask;
+    std::uint32_t m_history;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#include "BranchTrace.hpp"
+
+#include <cstring>
+
+BranchTraceWriter::BranchTraceWriter(FILE *file) : m_file(file), m_numRecords(0) {
+  m_buffer.reserve(BUFFER_RECORDS);
+  std::uint64_t counts[2] = { 0, 0 }; // rewritten by finish()
+  fwrite(BRANCH_TRACE_MAGIC, 1, 8, m_file);
+  fwrite(counts, sizeof(counts), 1, m_file);
+}
+
+void BranchTraceWriter::flush() {
+  if (!m_buffer.empty()) {
+    fwrite(m_buffer.data(), sizeof(BranchRecord), m_buffer.size(), m_file);
+    m_numRecords += m_buffer.size();
+    m_buffer.clear();
+  }
+}
+
+void BranchTraceWriter::finish(const unsigned long long retired) {
+  flush();
+  std::uint64_t counts[2] = { m_numRecords, retired };
+  if (fseek(m_file, 8, SEEK_SET) != 0) {
+    printf("WARNING: cannot rewind the branch trace to write its counts\n");
+    return;
+  }
+  fwrite(counts, sizeof(counts), 1, m_file);
+  fseek(m_file, 0, SEEK_END);
+  fflush(m_file);
+}
+
+bool BranchTraceWriter::read(const char *fileName, std::vector<BranchRecord> *records, unsigned long long *retired) {
+  FILE *file = fopen(fileName, "rb");
+  if (file == NULL) {
+    fprintf(stderr, "ERROR: cannot open `%s'\n", fileName);
+    return false;
+  }
+  char magic[8];
+  std::uint64_t counts[2];
+  if (fread(magic, 1, 8, file) != 8 || memcmp(magic, BRANCH_TRACE_MAGIC, 8) != 0
+      || fread(counts, sizeof(counts), 1, file) != 1) {
+    fprintf(stderr, "ERROR: `%s' is not a branch trace\n", fileName);
+    fclose(file);
+    return false;
+  }
+  records->resize(counts[0]);
+  if (fread(records->data(), sizeof(BranchRecord), records->size(), file) != records->size()) {
+    fprintf(stderr, "ERROR: `%s' is truncated (the run did not finish?)\n", fileName);
+    fclose(file);
+    return false;
+  }
+  fclose(file);
+  *retired = counts[1];
+  return true;
+}
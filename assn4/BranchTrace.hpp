@@ -0,0 +1,53 @@
+#ifndef __BRANCH_TRACE_HPP__
+#define __BRANCH_TRACE_HPP__
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#define BRANCH_TRACE_MAGIC "MIPSBRT1"
+
+// a resolved conditional branch; the PC is word-aligned, so bit 0 holds the outcome
+struct BranchRecord {
+  std::uint32_t pcTaken;
+  std::uint32_t target;
+  std::uint32_t pc() const { return pcTaken & ~1u; }
+  bool taken() const { return (pcTaken & 1) != 0; }
+};
+
+/******************************************************************************/
+/* BranchTraceWriter                                                          */
+/*   - Records the branch stream of a run (PC, target, outcome) in program  */
+/*     order, for mipsbpsweep to replay through many predictors             */
+/*   - File: the magic "MIPSBRT1", the number of branches and the retired   */
+/*     instructions (uint64 each, filled in by finish), then one 8-byte      */
+/*     BranchRecord per branch (host byte order)                            */
+/*   - Buffered: a store per branch, a write per 64K branches               */
+/******************************************************************************/
+class BranchTraceWriter {
+  public:
+    BranchTraceWriter(FILE *file);
+    void record(const std::uint32_t pc, const std::uint32_t target, const bool taken) {
+      BranchRecord record;
+      record.pcTaken = pc | (taken ? 1 : 0);
+      record.target = target;
+      m_buffer.push_back(record);
+      if (m_buffer.size() == BUFFER_RECORDS) {
+        flush();
+      }
+    }
+    // write the rest of the records and the counts; `retired' is for the MPKI of the replays
+    void finish(const unsigned long long retired);
+
+    // the records and the retired instructions of a trace file; false (after a message) if it is malformed
+    static bool read(const char *fileName, std::vector<BranchRecord> *records, unsigned long long *retired);
+  private:
+    static const size_t BUFFER_RECORDS = 65536;
+    void flush();
+
+    FILE *m_file;
+    std::vector<BranchRecord> m_buffer;
+    unsigned long long m_numRecords;
+};
+
+#endif
@@ -1,11 +1,43 @@
 #ifndef __CPU_HPP__
 #define __CPU_HPP__
 
+#include "BranchTrace.hpp"
+#include "IntervalStats.hpp"
 #include "Memory.hpp"
+#include "MulDivUnit.hpp"
+#include "PerfCounters.hpp"
 #include "RegisterFile.hpp"
+#include "SyscallUnit.hpp"
+#include "Telemetry.hpp"
 
 #include <cstdio>
 
+// what ID extracts from an instruction before it reads the register file (see CPU::Decode)
+struct DecodedInstruction {
+  std::bitset<6> opcode;
+  std::bitset<5> rs;
+  std::bitset<5> rt;
+  std::bitset<5> rd;
+  std::bitset<6> funct;
+  std::bitset<32> immediate; // sign-extended
+  std::bitset<1> regDst;
+  std::bitset<1> branch;
+  std::bitset<1> memRead;
+  std::bitset<1> memToReg;
+  std::bitset<2> aluOp;
+  std::bitset<1> memWrite;
+  std::bitset<1> aluSrc;
+  std::bitset<1> regWrite;
+  std::bitset<1> syscall;
+  std::bitset<1> mulDiv;     // 1 for mult, multu, div, divu (they write HI and LO)
+  std::bitset<1> readsHiLo;  // 1 for mfhi, mflo
+  std::bitset<1> readsRs;    // 1 if the instruction reads the register rs names (0 for syscall)
+  std::bitset<1> readsRt;    // 1 if it reads rt (R-type, sw, beq; rt is the destination of lw and addi)
+};
+
+// The combinational primitives below (Add, SignExtend, ShiftLeft2, ALU, MulDiv) are written bit by bit, like
+// the hardware they model. Building with -DWORD_DATAPATH swaps in word-level implementations with the
+// same results; benchPrimitives measures both.
 class CPU {
   public:
     CPU(
@@ -15,8 +47,28 @@ class CPU {
         m_registerFile(new RegisterFile(regFileName)),
         m_instMemory(new Memory(Memory::LittleEndian, instMemFileName)),
         m_dataMemory(new Memory(Memory::LittleEndian, dataMemFileName)),
-        m_currCycle(0) { }
+        m_syscallUnit(new SyscallUnit(m_registerFile, m_dataMemory)),
+        m_HI(0), m_LO(0), m_numRetired(0), m_intervalStats(nullptr), m_telemetry(nullptr), m_branchTrace(nullptr), m_currCycle(0) { }
+    virtual ~CPU() {
+      if (m_intervalStats != nullptr) {
+        m_intervalStats->finish(getPerfCounters());
+        delete m_intervalStats;
+      }
+      if (m_telemetry != nullptr) {
+        m_telemetry->publish(getPerfCounters(), true);
+        delete m_telemetry;
+      }
+      if (m_branchTrace != nullptr) {
+        m_branchTrace->finish(m_numRetired);
+        delete m_branchTrace;
+      }
+      delete m_syscallUnit; // <-- flushes the output of the simulated program
+      delete m_dataMemory;
+      delete m_instMemory;
+      delete m_registerFile;
+    }
     void printPVS() {
+      HOST_PROFILE(PrintPVS);
       printf("==================== Cycle %llu ====================\n", m_currCycle);
       printf("PC = 0x%08lx\n", m_PC.to_ulong());
       printf("Registers:\n");
@@ -27,8 +79,55 @@ class CPU {
       m_instMemory->printMemory();
     }
     virtual void advanceCycle() {
+      if (m_intervalStats != nullptr && m_intervalStats->due(m_currCycle)) {
+        m_intervalStats->sample(getPerfCounters());
+      }
+      if (m_telemetry != nullptr && m_telemetry->due(m_currCycle)) {
+        m_telemetry->publish(getPerfCounters(), isHalted());
+      }
       m_currCycle++;
-      printf("INFO: Simulating cycle %llu\n", m_currCycle);
+      HOST_PROFILE_CYCLE(m_currCycle);
+      if (!quietMode()) {
+        printf("INFO: Simulating cycle %llu\n", m_currCycle);
+      }
+    }
+    // true once the simulated program has called exit/exit2
+    bool isHalted() const { return m_syscallUnit->isHalted(); }
+    int exitCode() const { return m_syscallUnit->exitCode(); }
+    unsigned long long getCurrCycle() const { return m_currCycle; }
+    unsigned long long getNumRetired() const { return m_numRetired; }
+    // a snapshot of the performance counters (see PerfCounters.hpp)
+    PerfCounters getPerfCounters() const {
+      PerfCounters counters = m_perfCounters;
+      counters.cycles = m_currCycle;
+      counters.retired = m_numRetired;
+      return counters;
+    }
+    // sample the counters every interval from now on (see IntervalStats.hpp); the CPU owns `stats'
+    void enableIntervalStats(IntervalStats *stats) {
+      delete m_intervalStats;
+      m_intervalStats = stats;
+    }
+    // publish the counters for mipstop from now on (see Telemetry.hpp); the CPU owns `telemetry'
+    void enableTelemetry(Telemetry *telemetry) {
+      delete m_telemetry;
+      m_telemetry = telemetry;
+    }
+    // record the resolved branches from now on (see BranchTrace.hpp); the CPU owns `trace'
+    void enableBranchTrace(BranchTraceWriter *trace) {
+      delete m_branchTrace;
+      m_branchTrace = trace;
+    }
+    // write the architectural state as a register file image followed by a data memory image
+    void dumpState(FILE *file) {
+      fprintf(file, "# registers\n");
+      m_registerFile->dumpRegisters(file);
+      fprintf(file, "# data memory\n");
+      m_dataMemory->dumpMemory(file);
+    }
+    // digest of the architectural state (registers and data memory)
+    std::uint64_t stateDigest() {
+      return m_registerFile->digest() ^ (m_dataMemory->digest() * 31);
     }
   protected:
     std::bitset<32> m_PC; // the Program Counter (PC) register
@@ -36,6 +135,15 @@ class CPU {
     RegisterFile *m_registerFile; // the Register File (Registers)
     Memory *m_instMemory; // the Instruction Memory
     Memory *m_dataMemory; // the Data Memory
+    SyscallUnit *m_syscallUnit; // services `syscall' at retire
+    std::bitset<32> m_HI; // the HI register; written by mult, multu, div, divu and read by mfhi
+    std::bitset<32> m_LO; // the LO register; read by mflo
+    // misc.
+    unsigned long long m_numRetired; // <-- tracks the # of instructions retired
+    PerfCounters m_perfCounters; // <-- updated through PERF_COUNT only
+    IntervalStats *m_intervalStats; // <-- nullptr unless enabled; subclasses report the data accesses
+    Telemetry *m_telemetry; // <-- nullptr unless enabled
+    BranchTraceWriter *m_branchTrace; // <-- nullptr unless enabled; subclasses record the branches as they resolve
   private:
     // misc.
     unsigned long long m_currCycle; // <-- tracks the # of cycles the CPU processed
@@ -65,6 +173,9 @@ class CPU {
       const std::bitset<BitWidth> *input0, const std::bitset<BitWidth> *input1,
       std::bitset<BitWidth> *output
     ) {
+#ifdef WORD_DATAPATH
+      (*output) = std::bitset<BitWidth>(input0->to_ullong() + input1->to_ullong());
+#else
       output->reset();
       unsigned carry = 0;
       for (size_t i = 0; i < BitWidth; i++) {
@@ -73,6 +184,7 @@ class CPU {
         output->set(i, carry % 2);
         carry /= 2;
       }
+#endif
     }
     /***********************************************************************/
     /* CPU::Mux                                                            */
@@ -87,6 +199,36 @@ class CPU {
     ) {
       (*output) = (select->none()) ? (*input0) : (*input1);
     }
+    /**************************************************/
+    /* CPU::Mux                                       */
+    /*   - Three-to-one multiplexer                   */
+    /*   - if select = 0/1/2 then output = input0/1/2 */
+    /**************************************************/
+    template<size_t N>
+    void Mux(
+      const std::bitset<N> *input0, const std::bitset<N> *input1,
+      const std::bitset<N> *input2, const std::bitset<2> *select,
+      std::bitset<N> *output
+    ) {
+      switch (select->to_ulong()) {
+        case 0:
+          (*output) = (*input0);
+          break;
+        case 1:
+          (*output) = (*input1);
+          break;
+        case 2:
+          (*output) = (*input2);
+          break;
+        default: {
+          fprintf(stderr, "ERROR: `select' %lu is out-of-range.\n",
+                  select->to_ulong());
+          fflush(stderr);
+          assert(select->to_ulong() >= 0 && select->to_ulong() < 3);
+          break;
+        }
+      }
+    }
     /***************************************************************************/
     /* CPU::SignExtend                                                         */
     /*   - Expand an InputBitWidth-bit signed integer to an OutputBitWidth-bit */
@@ -98,6 +240,13 @@ class CPU {
       const std::bitset<InputBitWidth> *input,
       std::bitset<OutputBitWidth> *output
     ) {
+#ifdef WORD_DATAPATH
+      unsigned long long value = input->to_ullong();
+      if (input->test(InputBitWidth - 1)) {
+        value |= ~0ULL << InputBitWidth;
+      }
+      (*output) = std::bitset<OutputBitWidth>(value);
+#else
       output->reset();
       for (size_t i = 0; i < InputBitWidth - 1; i++) {
         output->set(i, input->test(i));
@@ -105,6 +254,7 @@ class CPU {
       for (size_t i = InputBitWidth - 1; i < OutputBitWidth; i++) {
         output->set(i, input->test(InputBitWidth - 1));
       }
+#endif
     }
     /*******************************************************************/
     /* CPU::ShiftLeft2                                                 */
@@ -116,10 +266,14 @@ class CPU {
       const std::bitset<BitWidth> *input,
       std::bitset<BitWidth> *output
     ) {
+#ifdef WORD_DATAPATH
+      (*output) = (*input) << 2;
+#else
       output->reset();
       for (size_t i = 2; i < BitWidth - 1; i++) {
         output->set(i, input->test(i - 2));
       }
+#endif
       output->set(BitWidth - 1, input->test(BitWidth - 1));
     }
     /*****************************************************************/
@@ -132,6 +286,22 @@ class CPU {
       const std::bitset<4> *control,
       std::bitset<32> *output, std::bitset<1> *zero
     ) {
+#ifdef WORD_DATAPATH
+      std::uint32_t a = (std::uint32_t)input0->to_ulong(), b = (std::uint32_t)input1->to_ulong();
+      switch (control->to_ulong()) {
+        case 0: (*output) = a & b; break; // and
+        case 1: (*output) = a | b; break; // or
+        case 2: (*output) = a + b; break; // add
+        case 6: (*output) = a - b; break; // sub
+        case 7: (*output) = ((std::int32_t)a < (std::int32_t)b) ? 1 : 0; break; // set on less than
+        case 12: (*output) = ~(a | b); break; // nor
+        default: {
+          printf("WARNING: Unsupported `control' 0x%02lx\n", control->to_ulong());
+          fflush(stdout);
+          break;
+        }
+      }
+#else
       switch (control->to_ulong()) {
         case 0: { // and
           for (size_t i = 0; i < 32; i++) {
@@ -169,8 +339,8 @@ class CPU {
             // positive <? positive
             output->set(0, input0->to_ullong() < input1->to_ullong());
           } else if (input0->test(31) && input1->test(31)) {
-            // negative <? negative
-            output->set(0, input0->to_ullong() >= input1->to_ullong());
+            // negative <? negative (two's complement keeps the unsigned order)
+            output->set(0, input0->to_ullong() < input1->to_ullong());
           } else if (input0->test(31) && !input1->test(31)) {
             // negative <? positive
             output->set(0, true);
@@ -193,10 +363,133 @@ class CPU {
           break;
         }
       }
+#endif
     
       zero->reset();
       zero->set(0, output->none());
     }
+    /******************************************************************/
+    /* CPU::Negate                                                    */
+    /*   - Negate a BitWidth-bit signed integer (invert and add one)  */
+    /*   - output = -input;                                           */
+    /******************************************************************/
+    template<size_t BitWidth>
+    void Negate(
+      const std::bitset<BitWidth> *input,
+      std::bitset<BitWidth> *output
+    ) {
+      std::bitset<BitWidth> inverted = ~(*input), one(1);
+      Add<BitWidth>(&inverted, &one, output);
+    }
+    /**********************************************************************************/
+    /* CPU::MulDiv                                                                    */
+    /*   - Multiply or divide the two inputs w.r.t. the `funct' of mult (0x18),       */
+    /*     multu (0x19), div (0x1A) or divu (0x1B); signed for mult and div           */
+    /*   - mult(u): {hi, lo} = input0 * input1;                                       */
+    /*   - div(u):  lo = input0 / input1; hi = input0 % input1; (rounded toward zero; */
+    /*     a division by zero yields lo = 0xffffffff and hi = input0)                 */
+    /**********************************************************************************/
+    void MulDiv(
+      const std::bitset<32> *input0, const std::bitset<32> *input1,
+      const std::bitset<6> *funct,
+      std::bitset<32> *hi, std::bitset<32> *lo
+    ) {
+      if (funct->test(1) && input1->none()) { // division by zero
+        (*hi) = (*input0);
+        (*lo).set();
+        return;
+      }
+#ifdef WORD_DATAPATH
+      std::uint32_t a = (std::uint32_t)input0->to_ulong(), b = (std::uint32_t)input1->to_ulong();
+      switch (funct->to_ulong()) {
+        case 0x18: { // mult
+          std::uint64_t product = (std::uint64_t)((std::int64_t)(std::int32_t)a * (std::int32_t)b);
+          (*hi) = (std::uint32_t)(product >> 32);
+          (*lo) = (std::uint32_t)product;
+          break;
+        }
+        case 0x19: { // multu
+          std::uint64_t product = (std::uint64_t)a * b;
+          (*hi) = (std::uint32_t)(product >> 32);
+          (*lo) = (std::uint32_t)product;
+          break;
+        }
+        case 0x1A: { // div
+          if (a == 0x80000000u && b == 0xffffffffu) { // the quotient overflows back to INT_MIN
+            (*hi) = 0;
+            (*lo) = a;
+          } else {
+            (*hi) = (std::uint32_t)((std::int32_t)a % (std::int32_t)b);
+            (*lo) = (std::uint32_t)((std::int32_t)a / (std::int32_t)b);
+          }
+          break;
+        }
+        case 0x1B: { // divu
+          (*hi) = a % b;
+          (*lo) = a / b;
+          break;
+        }
+        default: {
+          printf("WARNING: Unsupported `funct' %lu\n", funct->to_ulong());
+          fflush(stdout);
+          break;
+        }
+      }
+#else
+      // operate on the magnitudes, then fix the signs
+      bool isSigned = !funct->test(0);
+      bool negative0 = isSigned && input0->test(31), negative1 = isSigned && input1->test(31);
+      std::bitset<32> magnitude0 = (*input0), magnitude1 = (*input1);
+      if (negative0) { Negate<32>(input0, &magnitude0); }
+      if (negative1) { Negate<32>(input1, &magnitude1); }
+      if (!funct->test(1)) { // mult, multu: shift-and-add
+        std::bitset<64> product(0), addend(0), sum(0);
+        for (size_t i = 0; i < 32; i++) {
+          addend.set(i, magnitude0.test(i));
+        }
+        for (size_t i = 0; i < 32; i++) {
+          if (magnitude1.test(i)) {
+            Add<64>(&product, &addend, &sum);
+            product = sum;
+          }
+          addend <<= 1;
+        }
+        if (negative0 != negative1) {
+          Negate<64>(&product, &sum);
+          product = sum;
+        }
+        for (size_t i = 0; i < 32; i++) {
+          hi->set(i, product.test(i + 32));
+          lo->set(i, product.test(i));
+        }
+      } else { // div, divu: restoring division
+        std::bitset<33> remainder(0), divisor(0), negatedDivisor(0), difference(0);
+        std::bitset<32> quotient(0);
+        for (size_t i = 0; i < 32; i++) {
+          divisor.set(i, magnitude1.test(i));
+        }
+        Negate<33>(&divisor, &negatedDivisor);
+        for (size_t i = 32; i-- > 0; ) {
+          remainder <<= 1;
+          remainder.set(0, magnitude0.test(i));
+          Add<33>(&remainder, &negatedDivisor, &difference);
+          if (!difference.test(32)) { // remainder >= divisor
+            quotient.set(i);
+            remainder = difference;
+          }
+        }
+        for (size_t i = 0; i < 32; i++) {
+          hi->set(i, remainder.test(i));
+        }
+        (*lo) = quotient;
+        if (negative0 != negative1) { Negate<32>(&quotient, lo); }
+        if (negative0) {
+          std::bitset<32> tmp = (*hi);
+          Negate<32>(&tmp, hi);
+        }
+      }
+#endif
+    }
     /*****************************************************************************************/
     /* CPU::Control                                                                          */
     /*   - Produce appropriate control signals for the datapath w.r.t. the provided `opcode' */
@@ -244,7 +537,7 @@ class CPU {
     
           break;
         }
-        case 0x00: { // R-type instructions; add, sub, and, or, slt
+        case 0x00: { // R-type instructions; add, sub, and, or, slt, mult(u), div(u), mfhi, mflo
           (*regDst) = 1;
           (*branch) = 0;
           (*memRead) = 0;
@@ -275,6 +568,119 @@ class CPU {
         }
       }
     }
+    /*************************************************************************************/
+    /* CPU::Decode                                                                       */
+    /*   - Split `instr' into its fields and produce its control signals (see Control),  */
+    /*     for the pipelined CPUs that decode in ID                                      */
+    /*************************************************************************************/
+    void Decode(const std::bitset<32> *instr, DecodedInstruction *decoded) {
+      decoded->opcode = instr->to_ulong() >> 26;
+      decoded->rs = (instr->to_ulong() >> 21) & 0b11111;
+      decoded->rt = (instr->to_ulong() >> 16) & 0b11111;
+      decoded->rd = (instr->to_ulong() >> 11) & 0b11111;
+      std::bitset<16> immediate = instr->to_ulong() & 0xFFFF;
+      decoded->funct = instr->to_ulong() & 0b111111;
+      SignExtend<16, 32>(&immediate, &decoded->immediate);
+      Control(&decoded->opcode, &decoded->regDst, &decoded->branch, &decoded->memRead, &decoded->memToReg,
+              &decoded->aluOp, &decoded->memWrite, &decoded->aluSrc, &decoded->regWrite);
+      // syscall decodes as an R-type writing $zero; the SyscallUnit services it at retire
+      decoded->syscall = (decoded->opcode == 0x00 && decoded->funct == 0x0C);
+      // mult, multu, div, divu (funct 0x18-0x1B) go to the multiplier/divider and write $zero; mfhi and
+      // mflo (funct 0x10, 0x12) take HI or LO in place of the ALU result
+      decoded->mulDiv = (decoded->opcode == 0x00 && (decoded->funct.to_ulong() & 0x3C) == 0x18);
+      decoded->readsHiLo = (decoded->opcode == 0x00 && (decoded->funct == 0x10 || decoded->funct == 0x12));
+      // the source operands the instruction actually reads: rt is the destination of lw and addi, syscall
+      // reads $v0 and $a0 itself at retire, and mfhi/mflo read no register
+      switch (decoded->opcode.to_ulong()) {
+        case 0x00: // R-type
+          decoded->readsRs = (decoded->syscall == 0 && decoded->readsHiLo == 0);
+          decoded->readsRt = (decoded->syscall == 0 && decoded->readsHiLo == 0);
+          break;
+        case 0x2B: // sw
+        case 0x04: // beq
+          decoded->readsRs = 1;
+          decoded->readsRt = 1;
+          break;
+        default: // lw, addi
+          decoded->readsRs = 1;
+          decoded->readsRt = 0;
+          break;
+      }
+    }
+    /**************************************************************************************/
+    /* CPU::ForwardSelect                                                                 */
+    /*   - Picks the result to forward to one operand in EX, for the forwarding units of  */
+    /*     the pipelined CPUs: the `count' results in flight (regWrite[i], rd[i]) come    */
+    /*     oldest first, and the youngest one that writes `reg' wins (never $zero)        */
+    /*   - select = i + 1 (if result i should be used)                                    */
+    /*              0     (if the ReadData of the ID stage should be used)                */
+    /**************************************************************************************/
+    template<size_t SelectBits>
+    void ForwardSelect(
+      const std::bitset<5> *reg,
+      const std::bitset<1> *const *regWrite, const std::bitset<5> *const *rd, const size_t count,
+      std::bitset<SelectBits> *select
+    ) {
+      for (size_t i = count; i-- > 0; ) {
+        if (*regWrite[i] == 1 && *rd[i] != 0 && *rd[i] == *reg) {
+          (*select) = i + 1;
+          return;
+        }
+      }
+      (*select) = 0;
+    }
+    /***********************************************************************************/
+    /* CPU::MuxN                                                                       */
+    /*   - Select one of the `count' BitWidth-bit inputs as the output                 */
+    /*   - output = *inputs[select];                                                   */
+    /***********************************************************************************/
+    template<size_t BitWidth, size_t SelectBits>
+    void MuxN(
+      const std::bitset<BitWidth> *const *inputs, const size_t count,
+      const std::bitset<SelectBits> *select,
+      std::bitset<BitWidth> *output
+    ) {
+      if (select->to_ulong() >= count) {
+        fprintf(stderr, "ERROR: `select' %lu is out-of-range.\n", select->to_ulong());
+        fflush(stderr);
+        assert(select->to_ulong() < count);
+        return;
+      }
+      (*output) = (*inputs[select->to_ulong()]);
+    }
+    /**************************************************************************************/
+    /* CPU::LoadUseHazard                                                                 */
+    /*   - Detects whether the instruction in ID reads the register a load in EX writes:  */
+    /*     only the operands it actually reads (readsRs/readsRt from decode, 0 for a      */
+    /*     bubble), never $zero                                                           */
+    /*   - hazard = 1 if the instruction must wait a cycle for the loaded value           */
+    /**************************************************************************************/
+    void LoadUseHazard(
+      const std::bitset<5> *IF_ID_rs, const std::bitset<5> *IF_ID_rt,
+      const std::bitset<1> *IF_ID_readsRs, const std::bitset<1> *IF_ID_readsRt,
+      const std::bitset<1> *ID_EX_memRead, const std::bitset<5> *ID_EX_rt,
+      std::bitset<1> *hazard
+    ) {
+      (*hazard) = *ID_EX_memRead == 1 && *ID_EX_rt != 0 &&
+                  ((*IF_ID_readsRs == 1 && *ID_EX_rt == *IF_ID_rs) || (*IF_ID_readsRt == 1 && *ID_EX_rt == *IF_ID_rt));
+    }
+    /**************************************************************************************/
+    /* CPU::MulDivHazard                                                                  */
+    /*   - Detects whether the instruction in ID must wait for `unit' before it enters    */
+    /*     EX in the next cycle (see MulDivUnit.hpp)                                      */
+    /*   - result = 1 for an mfhi/mflo while HI and LO are not ready (a data hazard)      */
+    /*   - busy = 1 for a mult or div the unit cannot accept yet (a structural hazard)    */
+    /**************************************************************************************/
+    void MulDivHazard(
+      const MulDivUnit *unit, const std::bitset<1> *IF_ID_valid,
+      const std::bitset<1> *IF_ID_readsHiLo, const std::bitset<1> *IF_ID_mulDiv, const std::bitset<6> *IF_ID_funct,
+      std::bitset<1> *result, std::bitset<1> *busy
+    ) {
+      unsigned long long nextCycle = getCurrCycle() + 1;
+      (*result) = *IF_ID_valid == 1 && *IF_ID_readsHiLo == 1 && unit->readyCycle() > nextCycle;
+      (*busy) = *IF_ID_valid == 1 && *IF_ID_mulDiv == 1 &&
+                !unit->canIssue(MulDivUnit::isDivide(*IF_ID_funct), nextCycle);
+    }
     /***********************************************************************************************/
     /* CPU::ALUControl                                                                             */
     /*   - Produce the appropriate control signal for the ALU w.r.t. the given `ALUOp' and `funct' */
@@ -307,6 +713,15 @@ class CPU {
             case 0x2A:
               (*aluControl) = 7;
               break;
+            case 0x0C: // syscall; serviced by the SyscallUnit, the ALU result goes to $zero
+            case 0x18: // mult, multu, div, divu; MulDiv writes HI and LO, the ALU result goes to $zero
+            case 0x19:
+            case 0x1A:
+            case 0x1B:
+            case 0x10: // mfhi, mflo; HI or LO goes to rd in place of the ALU result
+            case 0x12:
+              (*aluControl) = 2;
+              break;
             default: {
               printf("WARNING: Unsupported `funct' %lu\n", funct->to_ulong());
               fflush(stdout);
@@ -0,0 +1,170 @@
+#include "ChromeTracer.hpp"
+
+#include "Assembler.hpp"
+#include "HostProfiler.hpp"
+
+#define PID_PIPELINE 1
+#define PID_HOST 2
+
+#ifdef ENABLE_HOST_PROFILING
+static const HostProfiler::Region s_stageRegions[PipelineTracer::NUM_STAGES] = {
+  HostProfiler::InstructionFetch, HostProfiler::InstructionDecode, HostProfiler::Execute,
+  HostProfiler::MemoryAccess, HostProfiler::WriteBack
+};
+#endif
+static const char *s_stageNames[PipelineTracer::NUM_STAGES] = { "IF", "ID", "EX", "MEM", "WB" };
+
+ChromeTracer::ChromeTracer(FILE *file, const unsigned long long windowCycles, const unsigned samplePeriod)
+  : m_file(file), m_firstEvent(true), m_windowCycles(windowCycles > 0 ? windowCycles : 1),
+    m_samplePeriod(samplePeriod > 0 ? samplePeriod : 1), m_cycle(0), m_windowIndex(0), m_windowStart(0),
+    m_detail(true), m_windowRetired(0), m_windowStalls(0), m_windowReads(0), m_windowWrites(0) {
+  for (int i = 0; i < NUM_STAGES; i++) {
+    m_stages[i].open = false;
+    m_windowRegionTicks[i] = 0;
+  }
+  m_hostStart = m_windowHostStart = HostProfiler::now();
+
+  fprintf(m_file, "{\"traceEvents\": [\n");
+  beginEvent();
+  fprintf(m_file, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %d, "
+          "\"args\": {\"name\": \"simulated pipeline (1 us = 1 cycle)\"}}", PID_PIPELINE);
+  for (int i = 0; i < NUM_STAGES; i++) {
+    beginEvent();
+    fprintf(m_file, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, \"tid\": %d, "
+            "\"args\": {\"name\": \"%s\"}}", PID_PIPELINE, i + 1, s_stageNames[i]);
+    beginEvent();
+    fprintf(m_file, "{\"name\": \"thread_sort_index\", \"ph\": \"M\", \"pid\": %d, \"tid\": %d, "
+            "\"args\": {\"sort_index\": %d}}", PID_PIPELINE, i + 1, i + 1);
+  }
+  beginEvent();
+  fprintf(m_file, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %d, "
+          "\"args\": {\"name\": \"simulator (host time)\"}}", PID_HOST);
+  beginEvent();
+  fprintf(m_file, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": %d, \"tid\": 1, "
+          "\"args\": {\"name\": \"windows of %llu cycles\"}}", PID_HOST, m_windowCycles);
+}
+
+ChromeTracer::~ChromeTracer() {
+  for (int i = 0; i < NUM_STAGES; i++) {
+    if (m_stages[i].open) {
+      closeStage(i);
+    }
+  }
+  if (m_cycle + 1 > m_windowStart) {
+    endWindow(m_cycle + 1);
+  }
+  fprintf(m_file, "\n]}\n");
+  fflush(m_file);
+}
+
+void ChromeTracer::beginEvent() {
+  if (!m_firstEvent) {
+    fprintf(m_file, ",\n");
+  }
+  m_firstEvent = false;
+}
+
+void ChromeTracer::cycle(const unsigned long long cycle) {
+  // a stage nobody occupied in the last cycle holds a bubble
+  for (int i = 0; i < NUM_STAGES; i++) {
+    if (m_stages[i].open && m_stages[i].lastSeen + 1 < cycle) {
+      closeStage(i);
+    }
+  }
+  if (cycle >= m_windowStart + m_windowCycles) {
+    endWindow(cycle);
+  }
+  m_cycle = cycle;
+}
+
+void ChromeTracer::fetch(const unsigned long long seq, const std::uint32_t pc, const std::uint32_t instruction) {
+  if (m_detail) {
+    char label[96];
+    snprintf(label, sizeof(label), "%08lx: %s", (unsigned long)pc, Assembler::disassemble(instruction, pc).c_str());
+    m_labels[seq] = label;
+  }
+  stage(seq, IF);
+}
+
+void ChromeTracer::stage(const unsigned long long seq, const Stage stage) {
+  Occupant &occupant = m_stages[stage];
+  if (occupant.open && occupant.seq == seq) {
+    occupant.lastSeen = m_cycle;
+    return;
+  }
+  if (occupant.open) {
+    closeStage(stage);
+  }
+  if (!m_detail) {
+    return;
+  }
+  std::unordered_map<unsigned long long, std::string>::const_iterator it = m_labels.find(seq);
+  occupant.open = true;
+  occupant.seq = seq;
+  occupant.start = occupant.lastSeen = m_cycle;
+  occupant.label = (it != m_labels.end()) ? it->second : "(fetched before the sampled window)";
+}
+
+void ChromeTracer::stall(const unsigned long long seq, const char *reason) {
+  m_windowStalls++;
+  if (m_detail) {
+    beginEvent();
+    fprintf(m_file, "{\"name\": \"stall: %s\", \"ph\": \"i\", \"s\": \"t\", \"pid\": %d, \"tid\": %d, \"ts\": %llu, "
+            "\"args\": {\"seq\": %llu}}", reason, PID_PIPELINE, ID + 1, m_cycle, seq);
+  }
+}
+
+void ChromeTracer::closeStage(const int stage) {
+  Occupant &occupant = m_stages[stage];
+  beginEvent();
+  fprintf(m_file, "{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": %d, \"tid\": %d, \"ts\": %llu, "
+          "\"dur\": %llu, \"args\": {\"seq\": %llu}}", occupant.label.c_str(), s_stageNames[stage], PID_PIPELINE,
+          stage + 1, occupant.start, occupant.lastSeen + 1 - occupant.start, occupant.seq);
+  occupant.open = false;
+}
+
+void ChromeTracer::endWindow(const unsigned long long endCycle) {
+  unsigned long long cycles = endCycle - m_windowStart;
+  double hostNow = HostProfiler::now();
+  double hostSeconds = hostNow - m_windowHostStart;
+
+  beginEvent();
+  fprintf(m_file, "{\"name\": \"CPI\", \"ph\": \"C\", \"pid\": %d, \"ts\": %llu, \"args\": {\"CPI\": %.4f}}",
+          PID_PIPELINE, m_windowStart, (m_windowRetired > 0) ? (double)cycles / m_windowRetired : 0.0);
+  beginEvent();
+  fprintf(m_file, "{\"name\": \"stalls per cycle\", \"ph\": \"C\", \"pid\": %d, \"ts\": %llu, "
+          "\"args\": {\"stalls\": %.4f}}", PID_PIPELINE, m_windowStart, (double)m_windowStalls / cycles);
+  beginEvent();
+  fprintf(m_file, "{\"name\": \"memory ops per cycle\", \"ph\": \"C\", \"pid\": %d, \"ts\": %llu, "
+          "\"args\": {\"reads\": %.4f, \"writes\": %.4f}}", PID_PIPELINE, m_windowStart,
+          (double)m_windowReads / cycles, (double)m_windowWrites / cycles);
+
+  double windowStartUs = (m_windowHostStart - m_hostStart) * 1e6;
+  beginEvent();
+  fprintf(m_file, "{\"name\": \"cycles %llu-%llu\", \"ph\": \"X\", \"pid\": %d, \"tid\": 1, \"ts\": %.3f, "
+          "\"dur\": %.3f, \"args\": {\"cyclesPerSecond\": %.1f}}", m_windowStart, endCycle - 1, PID_HOST,
+          windowStartUs, hostSeconds * 1e6, (hostSeconds > 0) ? cycles / hostSeconds : 0.0);
+  beginEvent();
+  fprintf(m_file, "{\"name\": \"simulated cycles/s\", \"ph\": \"C\", \"pid\": %d, \"ts\": %.3f, "
+          "\"args\": {\"cycles/s\": %.1f}}", PID_HOST, windowStartUs, (hostSeconds > 0) ? cycles / hostSeconds : 0.0);
+#ifdef ENABLE_HOST_PROFILING
+  HostProfiler &profiler = HostProfiler::instance();
+  double nsPerTick = profiler.nsPerTick();
+  beginEvent();
+  fprintf(m_file, "{\"name\": \"host ns per cycle\", \"ph\": \"C\", \"pid\": %d, \"ts\": %.3f, \"args\": {",
+          PID_HOST, windowStartUs);
+  for (int i = 0; i < NUM_STAGES; i++) {
+    std::uint64_t ticks = profiler.regionTicks(s_stageRegions[i]);
+    fprintf(m_file, "%s\"%s\": %.2f", (i == 0) ? "" : ", ", s_stageNames[i],
+            (ticks - m_windowRegionTicks[i]) * nsPerTick / cycles);
+    m_windowRegionTicks[i] = ticks;
+  }
+  fprintf(m_file, "}}");
+#endif
+
+  m_windowIndex++;
+  m_windowStart = endCycle;
+  m_windowHostStart = hostNow;
+  m_detail = (m_windowIndex % m_samplePeriod == 0);
+  m_windowRetired = m_windowStalls = m_windowReads = m_windowWrites = 0;
+}
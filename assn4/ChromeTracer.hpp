@@ -0,0 +1,67 @@
+#ifndef __CHROME_TRACER_HPP__
+#define __CHROME_TRACER_HPP__
+
+#include "PipelineTracer.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+
+/******************************************************************************/
+/* ChromeTracer                                                               */
+/*   - Writes Chrome trace_event JSON (Perfetto, about://tracing) with:      */
+/*     1) process "simulated pipeline" (1 us = 1 cycle): a track per stage    */
+/*        with a span per instruction, and counter tracks (CPI, stalls per  */
+/*        cycle, memory reads/writes) per window of `windowCycles'          */
+/*     2) process "simulator (host time)": a span per window with the host  */
+/*        time it took, simulated cycles/s, and (with                        */
+/*        -DENABLE_HOST_PROFILING) host ns per cycle of each stage           */
+/*   - Streams as it goes; only the instructions in flight are remembered   */
+/*   - Long runs are sampled: the per-instruction spans are written for     */
+/*     one window out of every `samplePeriod'; the counters for all of them */
+/******************************************************************************/
+class ChromeTracer : public PipelineTracer {
+  public:
+    ChromeTracer(FILE *file, const unsigned long long windowCycles = 1000, const unsigned samplePeriod = 1);
+    virtual ~ChromeTracer();
+    virtual void cycle(const unsigned long long cycle);
+    virtual void fetch(const unsigned long long seq, const std::uint32_t pc, const std::uint32_t instruction);
+    virtual void stage(const unsigned long long seq, const Stage stage);
+    virtual void stall(const unsigned long long seq, const char *reason);
+    virtual void memoryAccess(const bool write) { (write ? m_windowWrites : m_windowReads)++; }
+    virtual void retire(const unsigned long long seq) {
+      m_windowRetired++;
+      m_labels.erase(seq);
+    }
+    virtual void flush(const unsigned long long seq) { m_labels.erase(seq); }
+  private:
+    struct Occupant {
+      bool open;
+      unsigned long long seq;
+      unsigned long long start;    // the cycle the instruction entered the stage
+      unsigned long long lastSeen; // the last cycle it was seen in the stage
+      std::string label;
+    };
+    void beginEvent();
+    void closeStage(const int stage);
+    void endWindow(const unsigned long long endCycle);
+
+    FILE *m_file;
+    bool m_firstEvent;
+    unsigned long long m_windowCycles;
+    unsigned m_samplePeriod;
+    unsigned long long m_cycle;
+    Occupant m_stages[NUM_STAGES];
+    std::unordered_map<unsigned long long, std::string> m_labels; // the instructions in flight
+    // the current window
+    unsigned long long m_windowIndex;
+    unsigned long long m_windowStart;
+    bool m_detail; // the per-instruction spans are written in this window
+    std::uint64_t m_windowRetired, m_windowStalls, m_windowReads, m_windowWrites;
+    double m_hostStart;       // host time at the start of the trace (s)
+    double m_windowHostStart; // host time at the start of the window (s)
+    std::uint64_t m_windowRegionTicks[NUM_STAGES]; // HostProfiler ticks of the stages at the start of the window
+};
+
+#endif
@@ -0,0 +1,291 @@
+#ifndef __DATA_CACHE_HPP__
+#define __DATA_CACHE_HPP__
+
+#include "Memory.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/******************************************************************************/
+/* DataCache                                                                  */
+/*   - The timing of a set-associative L1 data cache in front of the data     */
+/*     memory (see PipelinedCPU::setDataCache): access() tells MEM's port     */
+/*     how many cycles a load or a store takes; the data itself stays in the  */
+/*     Memory, so the cache only keeps the tags                               */
+/*   - A hit takes `hit' cycles, a miss `miss' cycles (the block is read      */
+/*     from memory); a dirty victim is written back through a write buffer    */
+/*     and a write-through store or a store that does not allocate goes to    */
+/*     memory the same way, without waiting                                   */
+/*   - Replacement: LRU, tree pseudo-LRU or random (a fixed-seed xorshift)    */
+/*   - The misses are classified as compulsory (the block was never brought   */
+/*     in: a store that does not allocate leaves it out), capacity (a fully   */
+/*     associative LRU cache of the same size misses too) or conflict         */
+/*   - The tags, the LRU stamps and the dirty bits are separate arrays with   */
+/*     the ways of a set next to each other, so a lookup scans one short row  */
+/******************************************************************************/
+class DataCache {
+  public:
+    enum Replacement { LRU, PLRU, Random };
+    enum MissType { Compulsory, Capacity, Conflict, NUM_MISS_TYPES };
+    DataCache(const Replacement replacement, const unsigned sizeBytes, const unsigned ways, const unsigned blockBytes,
+              const bool writeBack, const bool writeAllocate, const unsigned hitCycles, const unsigned missCycles)
+      : m_replacement(replacement), m_sets(sizeBytes / blockBytes / ways), m_ways(ways), m_blockBytes(blockBytes),
+        m_offsetBits(log2(blockBytes)), m_writeBack(writeBack), m_writeAllocate(writeAllocate),
+        m_hitCycles(hitCycles), m_missCycles(missCycles), m_tags(m_sets * ways, (std::uint32_t)NO_TAG), m_stamps(m_sets * ways, 0),
+        m_dirty(m_sets * ways, 0), m_plru(m_sets, 0), m_seen(MEMORY_SIZE / blockBytes, false), m_clock(0),
+        m_random(0x2545F491), m_writebacks(0), m_memoryWrites(0) {
+      for (unsigned i = 0; i < 2; i++) {
+        m_accesses[i] = 0;
+        m_hits[i] = 0;
+      }
+      for (unsigned i = 0; i < NUM_MISS_TYPES; i++) {
+        m_misses[i] = 0;
+      }
+    }
+    // "replacement[:sizeBytes[:ways[:blockBytes]]][,option...]" with replacement lru, plru or random
+    // (default 8192 bytes, 2 ways, 32-byte blocks; powers of two, up to 64 ways) and the options wt
+    // (write-through; default write-back), nwa (no write-allocate), hit=cycles (default 1) and
+    // miss=cycles (default 20), e.g., "plru:16384:4:64,wt,miss=30"; nullptr if `spec' is malformed
+    static DataCache *create(const std::string &spec) {
+      std::string kind = spec, options;
+      size_t comma = spec.find(',');
+      if (comma != std::string::npos) {
+        kind = spec.substr(0, comma);
+        options = spec.substr(comma + 1);
+      }
+      bool writeBack = true, writeAllocate = true;
+      unsigned long hitCycles = 1, missCycles = 20;
+      while (!options.empty()) {
+        comma = options.find(',');
+        const std::string option = options.substr(0, comma);
+        options = (comma != std::string::npos) ? options.substr(comma + 1) : std::string();
+        if (option == "wt") {
+          writeBack = false;
+        } else if (option == "nwa") {
+          writeAllocate = false;
+        } else if (option.compare(0, 4, "hit=") == 0) {
+          if (!parseCycles(option.substr(4), &hitCycles)) {
+            return nullptr;
+          }
+        } else if (option.compare(0, 5, "miss=") == 0) {
+          if (!parseCycles(option.substr(5), &missCycles)) {
+            return nullptr;
+          }
+        } else {
+          return nullptr;
+        }
+      }
+      unsigned long numbers[3] = {8192, 2, 32};
+      size_t colon = kind.find(':');
+      std::string name = kind.substr(0, colon);
+      for (unsigned i = 0; colon != std::string::npos; i++) {
+        char *end;
+        if (i == 3) {
+          return nullptr;
+        }
+        numbers[i] = strtoul(kind.c_str() + colon + 1, &end, 0);
+        if (*end != '\0' && *end != ':') {
+          return nullptr;
+        }
+        colon = kind.find(':', colon + 1);
+      }
+      const unsigned long sizeBytes = numbers[0], ways = numbers[1], blockBytes = numbers[2];
+      if (!isPowerOfTwo(sizeBytes) || !isPowerOfTwo(ways) || !isPowerOfTwo(blockBytes) || blockBytes < 4 ||
+          ways > 64 || sizeBytes < ways * blockBytes || sizeBytes > MEMORY_SIZE || missCycles < hitCycles) {
+        return nullptr;
+      }
+      Replacement replacement;
+      if (name == "lru") {
+        replacement = LRU;
+      } else if (name == "plru") {
+        replacement = PLRU;
+      } else if (name == "random") {
+        replacement = Random;
+      } else {
+        return nullptr;
+      }
+      return new DataCache(replacement, (unsigned)sizeBytes, (unsigned)ways, (unsigned)blockBytes, writeBack,
+                           writeAllocate, (unsigned)hitCycles, (unsigned)missCycles);
+    }
+    // the spec that creates an equal cache
+    std::string name() const {
+      static const char *replacements[] = {"lru", "plru", "random"};
+      std::string spec = std::string(replacements[m_replacement]) + ":" + std::to_string(sizeBytes()) + ":" +
+                         std::to_string(m_ways) + ":" + std::to_string(m_blockBytes);
+      spec += m_writeBack ? "" : ",wt";
+      spec += m_writeAllocate ? "" : ",nwa";
+      return spec + ",hit=" + std::to_string(m_hitCycles) + ",miss=" + std::to_string(m_missCycles);
+    }
+    unsigned sizeBytes() const { return m_sets * m_ways * m_blockBytes; }
+    unsigned ways() const { return m_ways; }
+    unsigned blockBytes() const { return m_blockBytes; }
+
+    // a load (`write' = false) or a store to `address'; the cycles it takes
+    unsigned access(const std::uint32_t address, const bool write) {
+      const std::uint32_t block = address >> m_offsetBits;
+      const std::uint32_t set = block & (m_sets - 1);
+      const size_t row = (size_t)set * m_ways;
+      m_clock++;
+      m_accesses[write ? 1 : 0]++;
+      unsigned way = m_ways;
+      for (unsigned w = 0; w < m_ways; w++) {
+        if (m_tags[row + w] == block) {
+          way = w;
+          break;
+        }
+      }
+      // the fully associative LRU cache that tells the capacity misses from the conflict misses
+      const bool allocates = !write || m_writeAllocate;
+      const ShadowMap::iterator shadowEntry = m_shadowMap.find(block);
+      const bool shadowHit = shadowEntry != m_shadowMap.end();
+      if (shadowHit) {
+        m_shadow.splice(m_shadow.begin(), m_shadow, shadowEntry->second);
+      } else if (allocates) {
+        if (m_shadow.size() == (size_t)m_sets * m_ways) {
+          m_shadowMap.erase(m_shadow.back());
+          m_shadow.pop_back();
+        }
+        m_shadow.push_front(block);
+        m_shadowMap[block] = m_shadow.begin();
+      }
+      if (way < m_ways) {
+        m_hits[write ? 1 : 0]++;
+        touch(set, way);
+        if (write) {
+          m_dirty[row + way] |= m_writeBack ? 1 : 0;
+          m_memoryWrites += m_writeBack ? 0 : 1;
+        }
+        return m_hitCycles;
+      }
+
+      const size_t seen = block & (m_seen.size() - 1);
+      m_misses[!m_seen[seen] ? Compulsory : (shadowHit ? Conflict : Capacity)]++;
+      if (!allocates) {
+        m_memoryWrites++;
+        return m_hitCycles;
+      }
+      m_seen[seen] = true;
+      way = victim(set);
+      m_writebacks += m_dirty[row + way];
+      m_tags[row + way] = block;
+      m_dirty[row + way] = 0;
+      touch(set, way);
+      if (write) {
+        m_dirty[row + way] = m_writeBack ? 1 : 0;
+        m_memoryWrites += m_writeBack ? 0 : 1;
+      }
+      return m_missCycles;
+    }
+
+    // [0]: loads, [1]: stores
+    std::uint64_t getAccesses(const bool write) const { return m_accesses[write ? 1 : 0]; }
+    std::uint64_t getHits(const bool write) const { return m_hits[write ? 1 : 0]; }
+    std::uint64_t getAccesses() const { return m_accesses[0] + m_accesses[1]; }
+    std::uint64_t getMisses(const MissType type) const { return m_misses[type]; }
+    std::uint64_t getMisses() const { return m_misses[Compulsory] + m_misses[Capacity] + m_misses[Conflict]; }
+    // the dirty blocks written back, and the stores that went to memory (write-through or not allocated)
+    std::uint64_t getWritebacks() const { return m_writebacks; }
+    std::uint64_t getMemoryWrites() const { return m_memoryWrites; }
+    double hitRate() const {
+      return (getAccesses() > 0) ? (double)(m_hits[0] + m_hits[1]) / getAccesses() : 1.0;
+    }
+    static const char *missTypeName(const MissType type) {
+      static const char *names[NUM_MISS_TYPES] = {"compulsory", "capacity", "conflict"};
+      return names[type];
+    }
+  private:
+    static const std::uint32_t NO_TAG = 0xFFFFFFFF;
+    typedef std::unordered_map<std::uint32_t, std::list<std::uint32_t>::iterator> ShadowMap;
+    static bool parseCycles(const std::string &text, unsigned long *cycles) {
+      char *end;
+      *cycles = strtoul(text.c_str(), &end, 0);
+      return end != text.c_str() && *end == '\0' && *cycles > 0;
+    }
+    static bool isPowerOfTwo(const unsigned long value) { return value > 0 && (value & (value - 1)) == 0; }
+    static unsigned log2(unsigned value) {
+      unsigned bits = 0;
+      while (value > 1) {
+        value >>= 1;
+        bits++;
+      }
+      return bits;
+    }
+    // `way' of `set' was referenced
+    void touch(const std::uint32_t set, const unsigned way) {
+      m_stamps[(size_t)set * m_ways + way] = m_clock;
+      // pseudo-LRU: every node on the path to `way' points away from it (node n has children 2n and 2n + 1)
+      unsigned node = 1;
+      for (unsigned half = m_ways / 2; half > 0; half /= 2) {
+        const bool right = (way & half) != 0;
+        if (right) {
+          m_plru[set] &= ~(1ULL << node);
+        } else {
+          m_plru[set] |= 1ULL << node;
+        }
+        node = 2 * node + (right ? 1 : 0);
+      }
+    }
+    // the way to refill in `set': an invalid one first
+    unsigned victim(const std::uint32_t set) {
+      const size_t row = (size_t)set * m_ways;
+      for (unsigned w = 0; w < m_ways; w++) {
+        if (m_tags[row + w] == NO_TAG) {
+          return w;
+        }
+      }
+      unsigned way = 0;
+      switch (m_replacement) {
+        case LRU:
+          for (unsigned w = 1; w < m_ways; w++) {
+            way = (m_stamps[row + w] < m_stamps[row + way]) ? w : way;
+          }
+          break;
+        case PLRU:
+          // follow the pointers from the root (a set bit points right)
+          for (unsigned node = 1, half = m_ways / 2; half > 0; half /= 2) {
+            const bool right = (m_plru[set] >> node) & 1;
+            way += right ? half : 0;
+            node = 2 * node + (right ? 1 : 0);
+          }
+          break;
+        case Random:
+          m_random ^= m_random << 13;
+          m_random ^= m_random >> 17;
+          m_random ^= m_random << 5;
+          way = m_random & (m_ways - 1);
+          break;
+      }
+      return way;
+    }
+
+    Replacement m_replacement;
+    std::uint32_t m_sets;
+    unsigned m_ways;
+    unsigned m_blockBytes;
+    unsigned m_offsetBits;
+    bool m_writeBack;
+    bool m_writeAllocate;
+    unsigned m_hitCycles;
+    unsigned m_missCycles;
+    // [set * ways + way]
+    std::vector<std::uint32_t> m_tags; // <-- the block number (NO_TAG: invalid)
+    std::vector<std::uint64_t> m_stamps; // <-- the access of the last reference (LRU)
+    std::vector<std::uint8_t> m_dirty;
+    std::vector<std::uint64_t> m_plru; // <-- [set]: the tree bits of pseudo-LRU
+    std::vector<bool> m_seen;          // <-- [block]: brought in before
+    std::list<std::uint32_t> m_shadow; // <-- the fully associative LRU cache, the most recent block first
+    ShadowMap m_shadowMap;             // <-- [block]: its place in m_shadow
+    std::uint64_t m_clock;
+    std::uint32_t m_random;
+    std::uint64_t m_accesses[2];
+    std::uint64_t m_hits[2];
+    std::uint64_t m_misses[NUM_MISS_TYPES];
+    std::uint64_t m_writebacks;
+    std::uint64_t m_memoryWrites;
+};
+
+#endif
@@ -0,0 +1,352 @@
+#include "DualIssueCPU.hpp"
+
+void DualIssueCPU::InstructionFetch()
+{
+  HOST_PROFILE(InstructionFetch);
+  // ID가 가져간 명령만큼 IF/ID latch를 앞으로 당긴다. (하나만 issue했으면 남은 younger 명령이 slot 0으로)
+  if (m_ID_to_IF_issued >= 1)
+  {
+    m_latch_IF_ID[0] = m_latch_IF_ID[1];
+    m_latch_IF_ID[1].instr = 0x00000020;
+    m_latch_IF_ID[1].valid = 0;
+  }
+  if (m_ID_to_IF_issued == 2)
+  {
+    m_latch_IF_ID[0].instr = 0x00000020;
+    m_latch_IF_ID[0].valid = 0;
+  }
+
+  // 빈 slot을 순서대로 채운다 (instruction memory의 read port 2개). m_PC는 마지막으로 fetch한 명령의 PC
+  // MEM에서 taken branch가 redirect하면 (IF/ID는 이미 flush되어 비어 있음) 첫 fetch는 branch target에서
+  std::bitset<32> four(4);
+  std::bitset<1> memRead(1);
+  std::bitset<1> memWrite(0);
+  std::bitset<1> PCSrc = m_MEM_to_IF_PCSrc;
+  for (int s = 0; s < 2; s++)
+  {
+    if (m_latch_IF_ID[s].valid == 1)
+    {
+      continue;
+    }
+    std::bitset<32> pcPlus4;
+    Add<32>(&m_PC, &four, &pcPlus4);
+    CPU::Mux<32>(&pcPlus4, &m_MEM_to_IF_branchTarget, &PCSrc, &m_PC); // PCSrc = 1 이면 branch target, 0이면 PC+4
+    PCSrc = 0;
+    m_instMemory->access(&m_PC, nullptr, &memRead, &memWrite, &m_latch_IF_ID[s].instr);
+    Add<32>(&m_PC, &four, &m_latch_IF_ID[s].pcPlus4);
+    m_latch_IF_ID[s].valid = 1;
+  }
+}
+
+void DualIssueCPU::InstructionDecode()
+{
+  HOST_PROFILE(InstructionDecode);
+  // 2. Decode - IF/ID의 두 명령을 모두 decode
+  DecodedInstruction decoded[2];
+  Decode(&m_latch_IF_ID[0].instr, &decoded[0]);
+  Decode(&m_latch_IF_ID[1].instr, &decoded[1]);
+  // bubble은 아무 register도 읽지 않는다.
+  for (int s = 0; s < 2; s++)
+  {
+    decoded[s].readsRs &= m_latch_IF_ID[s].valid;
+    decoded[s].readsRt &= m_latch_IF_ID[s].valid;
+  }
+
+  // older 명령(slot 0)은 자신의 hazard만, younger 명령(slot 1)은 older 명령이 issue될 때 같이 issue될 수 있는지도 검사
+  // (in-order이므로 older 명령이 대기하면 younger 명령도 대기)
+  std::bitset<1> stall[2];
+  Hazard hazard[2];
+  HazardDetectionUnit(&m_latch_IF_ID[0].valid, &decoded[0], &stall[0], &hazard[0]);
+  HazardDetectionUnit(&m_latch_IF_ID[1].valid, &decoded[1], &stall[1], &hazard[1]);
+  std::bitset<1> pair;
+  int limit;
+  PairingUnit(&decoded[0], &decoded[1], &pair, &limit);
+  std::bitset<1> issue[2];
+  issue[0] = m_latch_IF_ID[0].valid.all() && stall[0] == 0;
+  issue[1] = issue[0].all() && m_latch_IF_ID[1].valid.all() && pair == 1 && stall[1] == 0;
+  m_ID_to_IF_issued = issue[0].to_ulong() + issue[1].to_ulong();
+
+  // 이번 cycle에 issue한 명령 수와, 하나만 issue한 이유 (IF는 언제나 두 slot을 모두 채우므로 slot 1은 비어 있지 않음)
+  m_issueCycles[m_ID_to_IF_issued]++;
+  if (issue[0] == 1 && issue[1] == 0)
+  {
+    m_pairLimits[(pair == 0) ? limit : PairHazard]++;
+  }
+  // older 명령이 대기하면 multiplier/divider 때문인 경우만 MulDivUnit이 센다 (PipelinedCPU와 같이)
+  if (m_latch_IF_ID[0].valid == 1 && stall[0] == 1)
+  {
+    PERF_COUNT(if (hazard[0] == LoadUse) { m_perfCounters.loadUseBubbles++; }
+               else if (hazard[0] == SyscallDrain) { m_perfCounters.syscallBubbles++; }
+               else { m_perfCounters.mulDivBubbles++; });
+    if (hazard[0] == MulDivResult || hazard[0] == MulDivBusy)
+    {
+      m_mulDivUnit.countStall(hazard[0] == MulDivBusy);
+    }
+  }
+
+  // Set ID/EX latch (slot마다)
+  // issue하지 않는 slot은 signal을 전부 0으로 (bubble)
+  std::bitset<1> zero(0);
+  std::bitset<2> zero_2bit(0);
+  for (int s = 0; s < 2; s++)
+  {
+    std::bitset<1> ctrlSelect = ~issue[s];
+    PERF_COUNT(if (issue[s] == 1) {
+                 m_perfCounters.countInstruction(decoded[s].opcode.to_ulong(), decoded[s].funct.to_ulong());
+               });
+    CPU::Mux<1>(&decoded[s].aluSrc, &zero, &ctrlSelect, &m_latch_ID_EX[s].ctrlEXALUSrc);
+    CPU::Mux<2>(&decoded[s].aluOp, &zero_2bit, &ctrlSelect, &m_latch_ID_EX[s].ctrlEXALUOp);
+    CPU::Mux<1>(&decoded[s].regDst, &zero, &ctrlSelect, &m_latch_ID_EX[s].ctrlEXRegDst);
+    CPU::Mux<1>(&decoded[s].branch, &zero, &ctrlSelect, &m_latch_ID_EX[s].ctrlMEMBranch);
+    CPU::Mux<1>(&decoded[s].memRead, &zero, &ctrlSelect, &m_latch_ID_EX[s].ctrlMEMMemRead);
+    CPU::Mux<1>(&decoded[s].memWrite, &zero, &ctrlSelect, &m_latch_ID_EX[s].ctrlMEMMemWrite);
+    CPU::Mux<1>(&decoded[s].regWrite, &zero, &ctrlSelect, &m_latch_ID_EX[s].ctrlWBRegWrite);
+    CPU::Mux<1>(&decoded[s].memToReg, &zero, &ctrlSelect, &m_latch_ID_EX[s].ctrlWBMemToReg);
+    CPU::Mux<1>(&decoded[s].syscall, &zero, &ctrlSelect, &m_latch_ID_EX[s].ctrlWBSyscall);
+    CPU::Mux<1>(&decoded[s].mulDiv, &zero, &ctrlSelect, &m_latch_ID_EX[s].ctrlEXMulDiv);
+    CPU::Mux<1>(&decoded[s].readsHiLo, &zero, &ctrlSelect, &m_latch_ID_EX[s].ctrlEXReadHiLo);
+    CPU::Mux<1>(&decoded[s].readsRs, &zero, &ctrlSelect, &m_latch_ID_EX[s].readsRs);
+    CPU::Mux<1>(&decoded[s].readsRt, &zero, &ctrlSelect, &m_latch_ID_EX[s].readsRt);
+    m_latch_ID_EX[s].valid = issue[s];
+
+    m_latch_ID_EX[s].pcPlus4 = m_latch_IF_ID[s].pcPlus4;
+    // register file의 read port 4개: slot마다 rs, rt를 읽는다 (WB는 이번 cycle에 이미 썼음)
+    m_registerFile->access(&decoded[s].rs, &decoded[s].rt, nullptr, nullptr, nullptr,
+                           &m_latch_ID_EX[s].readData1, &m_latch_ID_EX[s].readData2);
+    m_latch_ID_EX[s].immediate = decoded[s].immediate;
+    m_latch_ID_EX[s].instr_25_21 = decoded[s].rs;
+    m_latch_ID_EX[s].instr_20_16 = decoded[s].rt;
+    m_latch_ID_EX[s].instr_15_11 = decoded[s].rd;
+  }
+}
+
+void DualIssueCPU::Execute()
+{
+  HOST_PROFILE(Execute);
+  // 3. EX : slot마다 PipelinedCPU의 EX와 같은 datapath (ALU, forwarding MUX, branch target adder)
+  for (int s = 0; s < 2; s++)
+  {
+    ID_EX &latch = m_latch_ID_EX[s];
+    // ID stage에 있는 Hazard detection unit에 이 slot의 MemRead, rt, syscall을 보냄
+    m_EX_to_HazDetUnit_memRead[s] = latch.ctrlMEMMemRead;
+    m_EX_to_HazDetUnit_rt[s] = latch.instr_20_16;
+    m_EX_to_HazDetUnit_syscall[s] = latch.ctrlWBSyscall;
+    // rs, rt를 EX/MEM, MEM/WB의 네 결과 중 가장 최근 것에서 forwarding
+    std::bitset<3> forwardA;
+    std::bitset<3> forwardB;
+    std::bitset<32> forwarded_rsValue;
+    std::bitset<32> forwarded_rtValue;
+    ForwardingUnit(&latch.instr_25_21, &latch.instr_20_16, &latch.readsRs, &latch.readsRt, &forwardA, &forwardB);
+    // PerfCounters의 forwarding 경로: 1 = MEM/WB (slot 0, 1), 2 = EX/MEM (slot 0, 1)
+    PERF_COUNT(if (latch.readsRs == 1) { m_perfCounters.forwards[PerfCounters::OperandA][(forwardA.to_ulong() + 1) / 2]++; }
+               if (latch.readsRt == 1) { m_perfCounters.forwards[PerfCounters::OperandB][(forwardB.to_ulong() + 1) / 2]++; });
+    // forwarding을 위한 5-to-1 MUX: ID/EX의 값, MEM/WB slot 0, 1, EX/MEM slot 0, 1의 결과
+    const std::bitset<32> *rsInputs[5] = {&latch.readData1, &m_WB_to_FwdUnit_rdValue[0], &m_WB_to_FwdUnit_rdValue[1],
+                                          &m_MEM_to_FwdUnit_rdValue[0], &m_MEM_to_FwdUnit_rdValue[1]};
+    const std::bitset<32> *rtInputs[5] = {&latch.readData2, &m_WB_to_FwdUnit_rdValue[0], &m_WB_to_FwdUnit_rdValue[1],
+                                          &m_MEM_to_FwdUnit_rdValue[0], &m_MEM_to_FwdUnit_rdValue[1]};
+    MuxN<32>(rsInputs, 5, &forwardA, &forwarded_rsValue);
+    MuxN<32>(rtInputs, 5, &forwardB, &forwarded_rtValue);
+    CPU::Mux<5>(&latch.instr_20_16, &latch.instr_15_11, &latch.ctrlEXRegDst, &m_latch_EX_MEM[s].rd); // regDst가 1이면 rd, 0이면 rt
+    std::bitset<32> aluinput2;
+    CPU::Mux<32>(&forwarded_rtValue, &latch.immediate, &latch.ctrlEXALUSrc, &aluinput2); // ALUSrc가 1이면 immediate
+    std::bitset<32> shiftleft2Immediate;
+    ShiftLeft2<32>(&latch.immediate, &shiftleft2Immediate);
+    std::bitset<6> funct = latch.immediate.to_ulong() & 0b111111; // funct : [5-0]
+    std::bitset<4> aluControl;
+    ALUControl(&latch.ctrlEXALUOp, &funct, &aluControl);
+    ALU(&forwarded_rsValue, &aluinput2, &aluControl, &m_latch_EX_MEM[s].aluResult, &m_latch_EX_MEM[s].aluZero);
+    // multiplier/divider와 HI, LO는 하나뿐이므로 한 pair에서 한 slot만 쓴다 (PairingUnit)
+    if (latch.ctrlEXMulDiv == 1)
+    {
+      MulDiv(&forwarded_rsValue, &forwarded_rtValue, &funct, &m_HI, &m_LO);
+      m_mulDivUnit.issue(MulDivUnit::isDivide(funct), getCurrCycle());
+    }
+    if (latch.ctrlEXReadHiLo == 1)
+    {
+      std::bitset<1> selectLO = funct.test(1);
+      CPU::Mux<32>(&m_HI, &m_LO, &selectLO, &m_latch_EX_MEM[s].aluResult);
+    }
+    Add<32>(&latch.pcPlus4, &shiftleft2Immediate, &m_latch_EX_MEM[s].branchTarget);
+    // Set remaining EX/MEM latch
+    m_latch_EX_MEM[s].pcPlus4 = latch.pcPlus4;
+    m_latch_EX_MEM[s].readData2 = forwarded_rtValue;
+    m_latch_EX_MEM[s].ctrlMEMBranch = latch.ctrlMEMBranch;
+    m_latch_EX_MEM[s].ctrlMEMMemRead = latch.ctrlMEMMemRead;
+    m_latch_EX_MEM[s].ctrlMEMMemWrite = latch.ctrlMEMMemWrite;
+    m_latch_EX_MEM[s].ctrlWBRegWrite = latch.ctrlWBRegWrite;
+    m_latch_EX_MEM[s].ctrlWBMemToReg = latch.ctrlWBMemToReg;
+    m_latch_EX_MEM[s].ctrlWBSyscall = latch.ctrlWBSyscall;
+    m_latch_EX_MEM[s].valid = latch.valid;
+  }
+}
+
+void DualIssueCPU::MemoryAccess()
+{
+  HOST_PROFILE(MemoryAccess);
+  // 4. MemoryAccess
+  m_MEM_to_IF_PCSrc = 0;
+  for (int s = 0; s < 2; s++)
+  {
+    // MEM 하기전 EX/MEM latch의 regWrite, rd, rdValue를 forwarding unit에, syscall을 Hazard detection unit에 넘겨준다.
+    m_MEM_to_FwdUnit_regWrite[s] = m_latch_EX_MEM[s].ctrlWBRegWrite;
+    m_MEM_to_FwdUnit_rd[s] = m_latch_EX_MEM[s].rd;
+    m_MEM_to_FwdUnit_rdValue[s] = m_latch_EX_MEM[s].aluResult;
+    m_MEM_to_HazDetUnit_syscall[s] = m_latch_EX_MEM[s].ctrlWBSyscall;
+
+    // branch는 not taken으로 예측했으므로 taken이면 IF를 branch target으로 redirect하고 뒤따르는 명령을 flush
+    // (branch는 pair의 마지막 명령이므로 같은 pair에서 이 slot보다 나중 명령은 없음)
+    std::bitset<1> branchTaken;
+    AND<1>(&m_latch_EX_MEM[s].ctrlMEMBranch, &m_latch_EX_MEM[s].aluZero, &branchTaken);
+    if (m_latch_EX_MEM[s].valid == 1 && m_latch_EX_MEM[s].ctrlMEMBranch == 1)
+    {
+      PERF_COUNT(m_perfCounters.branches++;
+                 m_perfCounters.takenBranches += branchTaken.to_ulong();
+                 m_perfCounters.redirectPenalty += branchTaken.all() ? m_latch_ID_EX[0].valid.to_ulong() +
+                     m_latch_ID_EX[1].valid.to_ulong() + m_latch_IF_ID[0].valid.to_ulong() +
+                     m_latch_IF_ID[1].valid.to_ulong() : 0);
+      if (m_branchTrace != nullptr)
+      {
+        m_branchTrace->record((std::uint32_t)m_latch_EX_MEM[s].pcPlus4.to_ulong() - 4,
+                              (std::uint32_t)m_latch_EX_MEM[s].branchTarget.to_ulong(), branchTaken == 1);
+      }
+      if (branchTaken == 1)
+      {
+        m_MEM_to_IF_PCSrc = 1;
+        m_MEM_to_IF_branchTarget = m_latch_EX_MEM[s].branchTarget;
+        FlushYounger();
+      }
+    }
+
+    // Data memory access (data memory port는 하나: 한 pair에 memory 명령은 최대 하나)
+    if (m_latch_EX_MEM[s].ctrlMEMMemRead == 1 || m_latch_EX_MEM[s].ctrlMEMMemWrite == 1)
+    {
+      m_dataMemory->access(&m_latch_EX_MEM[s].aluResult, &m_latch_EX_MEM[s].readData2, &m_latch_EX_MEM[s].ctrlMEMMemRead,
+                           &m_latch_EX_MEM[s].ctrlMEMMemWrite, &m_latch_MEM_WB[s].readData);
+      PERF_COUNT(m_perfCounters.memReads += m_latch_EX_MEM[s].ctrlMEMMemRead.to_ulong());
+      PERF_COUNT(m_perfCounters.memWrites += m_latch_EX_MEM[s].ctrlMEMMemWrite.to_ulong());
+      if (m_intervalStats != nullptr && m_latch_EX_MEM[s].valid == 1)
+      {
+        m_intervalStats->touch((std::uint32_t)m_latch_EX_MEM[s].aluResult.to_ulong());
+      }
+    }
+    // Set remaining MEM/WB latch
+    m_latch_MEM_WB[s].pcPlus4 = m_latch_EX_MEM[s].pcPlus4;
+    m_latch_MEM_WB[s].aluResult = m_latch_EX_MEM[s].aluResult;
+    m_latch_MEM_WB[s].rd = m_latch_EX_MEM[s].rd;
+    m_latch_MEM_WB[s].ctrlWBRegWrite = m_latch_EX_MEM[s].ctrlWBRegWrite;
+    m_latch_MEM_WB[s].ctrlWBMemToReg = m_latch_EX_MEM[s].ctrlWBMemToReg;
+    m_latch_MEM_WB[s].ctrlWBSyscall = m_latch_EX_MEM[s].ctrlWBSyscall;
+    m_latch_MEM_WB[s].valid = m_latch_EX_MEM[s].valid;
+  }
+}
+
+void DualIssueCPU::WriteBack()
+{
+  HOST_PROFILE(WriteBack);
+  // 5. WriteBack
+  // register file의 write port 2개: slot 0, slot 1 순서로 써서 같은 register에 쓰면 younger 명령의 값이 남는다.
+  for (int s = 0; s < 2; s++)
+  {
+    m_WB_to_FwdUnit_regWrite[s] = m_latch_MEM_WB[s].ctrlWBRegWrite;
+    std::bitset<32> writeBackData;
+    CPU::Mux<32>(&m_latch_MEM_WB[s].aluResult, &m_latch_MEM_WB[s].readData,
+                 &m_latch_MEM_WB[s].ctrlWBMemToReg, &writeBackData); // MemtoReg = 1 이면 readData, 0이면 aluResult
+    m_WB_to_FwdUnit_rd[s] = m_latch_MEM_WB[s].rd;
+    m_WB_to_FwdUnit_rdValue[s] = writeBackData;
+    m_registerFile->access(nullptr, nullptr, &m_latch_MEM_WB[s].rd, &writeBackData,
+                           &m_latch_MEM_WB[s].ctrlWBRegWrite, nullptr, nullptr);
+    if (m_latch_MEM_WB[s].valid == 1)
+    {
+      m_numRetired++;
+    }
+    // syscall은 pair의 마지막 명령이므로 같은 pair의 older 명령은 이미 register file에 반영된 상태
+    if (m_latch_MEM_WB[s].ctrlWBSyscall == 1)
+    {
+      m_syscallUnit->execute();
+    }
+  }
+}
+
+void DualIssueCPU::FlushYounger()
+{
+  // ID/EX의 두 slot은 bubble로, IF/ID의 두 명령은 버린다 (IF가 branch target부터 다시 채움)
+  ResetSlot(&m_latch_ID_EX[0]);
+  ResetSlot(&m_latch_ID_EX[1]);
+  for (int s = 0; s < 2; s++)
+  {
+    m_latch_IF_ID[s].instr = 0x00000020;
+    m_latch_IF_ID[s].valid = 0;
+  }
+}
+
+void DualIssueCPU::ForwardingUnit(
+    const std::bitset<5> *ID_EX_rs, const std::bitset<5> *ID_EX_rt,
+    const std::bitset<1> *ID_EX_readsRs, const std::bitset<1> *ID_EX_readsRt,
+    std::bitset<3> *forwardA, std::bitset<3> *forwardB)
+{
+  // data forwarding이 꺼져 있거나 명령이 읽지 않는 operand면 ID/EX의 rs, rt 값을 그대로 사용
+  *forwardA = 0;
+  *forwardB = 0;
+  if (!m_enableDataForwarding)
+  {
+    return;
+  }
+  // 가장 최근에 그 register를 쓰는 명령의 결과: EX/MEM slot 1 > EX/MEM slot 0 > MEM/WB slot 1 > MEM/WB slot 0
+  const std::bitset<1> *regWrite[4] = {&m_WB_to_FwdUnit_regWrite[0], &m_WB_to_FwdUnit_regWrite[1],
+                                       &m_MEM_to_FwdUnit_regWrite[0], &m_MEM_to_FwdUnit_regWrite[1]};
+  const std::bitset<5> *rd[4] = {&m_WB_to_FwdUnit_rd[0], &m_WB_to_FwdUnit_rd[1],
+                                 &m_MEM_to_FwdUnit_rd[0], &m_MEM_to_FwdUnit_rd[1]};
+  if (*ID_EX_readsRs == 1)
+  {
+    ForwardSelect<3>(ID_EX_rs, regWrite, rd, 4, forwardA);
+  }
+  if (*ID_EX_readsRt == 1)
+  {
+    ForwardSelect<3>(ID_EX_rt, regWrite, rd, 4, forwardB);
+  }
+}
+
+void DualIssueCPU::HazardDetectionUnit(
+    const std::bitset<1> *IF_ID_valid, const DecodedInstruction *decoded,
+    std::bitset<1> *stall, Hazard *hazard)
+{
+  // EX에 있는 두 slot 중 load의 결과를 읽는 명령은 한 cycle 대기 (hazard detection이 켜져 있을 때만)
+  // syscall이 EX나 MEM에 있으면 retire($v0 write)할 때까지 대기. bubble은 붙잡을 필요가 없다.
+  bool loadUse = false;
+  bool syscallInFlight = false;
+  for (int s = 0; s < 2; s++)
+  {
+    std::bitset<1> loadUseHazard;
+    LoadUseHazard(&decoded->rs, &decoded->rt, &decoded->readsRs, &decoded->readsRt,
+                  &m_EX_to_HazDetUnit_memRead[s], &m_EX_to_HazDetUnit_rt[s], &loadUseHazard);
+    loadUse = loadUse || (m_enableHazardDetection && loadUseHazard == 1);
+    syscallInFlight = syscallInFlight ||
+                      (*IF_ID_valid == 1 && (m_EX_to_HazDetUnit_syscall[s] == 1 || m_MEM_to_HazDetUnit_syscall[s] == 1));
+  }
+  // multiplier/divider: 다음 cycle에 EX에 들어갈 mfhi, mflo는 HI, LO가 준비될 때까지, mult, div는 unit이 받을 수 있을 때까지
+  std::bitset<1> mulDivResult, mulDivBusy;
+  MulDivHazard(&m_mulDivUnit, IF_ID_valid, &decoded->readsHiLo, &decoded->mulDiv, &decoded->funct,
+               &mulDivResult, &mulDivBusy);
+  *hazard = loadUse ? LoadUse : syscallInFlight ? SyscallDrain : (mulDivResult == 1) ? MulDivResult
+          : (mulDivBusy == 1) ? MulDivBusy : NoHazard;
+  *stall = (*hazard != NoHazard);
+}
+
+void DualIssueCPU::PairingUnit(
+    const DecodedInstruction *older, const DecodedInstruction *younger,
+    std::bitset<1> *pair, int *limit)
+{
+  // older 명령이 쓰는 register (regDst가 1이면 rd, 0이면 rt; $zero는 쓰지 않는 것과 같음)
+  std::bitset<5> olderDest;
+  CPU::Mux<5>(&older->rt, &older->rd, &older->regDst, &olderDest);
+  bool dependence = older->regWrite == 1 && olderDest != 0 &&
+                    ((younger->readsRs == 1 && younger->rs == olderDest) ||
+                     (younger->readsRt == 1 && younger->rt == olderDest));
+  bool bothMemory = (older->memRead == 1 || older->memWrite == 1) && (younger->memRead == 1 || younger->memWrite == 1);
+  bool bothMulDiv = (older->mulDiv == 1 || older->readsHiLo == 1) && (younger->mulDiv == 1 || younger->readsHiLo == 1);
+  bool control = older->branch == 1 || older->syscall == 1;
+  *limit = control ? PairControl : bothMemory ? PairMemory : bothMulDiv ? PairMulDiv : dependence ? PairDependence
+         : NUM_PAIR_LIMITS;
+  *pair = (*limit == NUM_PAIR_LIMITS);
+}
@@ -0,0 +1,282 @@
+#ifndef __DUAL_ISSUE_CPU_HPP__
+#define __DUAL_ISSUE_CPU_HPP__
+
+#include "CPU.hpp"
+#include "MulDivUnit.hpp"
+
+/******************************************************************************/
+/* DualIssueCPU                                                               */
+/*   - The 5-stage pipeline of PipelinedCPU, two instructions wide and in     */
+/*     order: IF fetches two instructions per cycle into the IF-ID latch, ID  */
+/*     issues the older one, and the younger one with it if they can pair,    */
+/*     and every later latch holds two slots (slot 0 is the older)            */
+/*   - Two instructions pair unless the second one is a second memory access  */
+/*     (one data memory port) or a second mult/div/mfhi/mflo (one HI/LO), a   */
+/*     branch or a syscall ends the pair, or the second one reads the         */
+/*     register the first one writes (no forwarding inside a pair)            */
+/*   - The register file has 4 read ports (ID) and 2 write ports (WB, slot 0  */
+/*     then slot 1, so the younger of two writes to a register wins)          */
+/*   - Forwards and detects hazards as PipelinedCPU does (both on unless      */
+/*     turned off); the forwarding unit picks the youngest of the four        */
+/*     results in EX-MEM and MEM-WB                                           */
+/*   - The branches are predicted not taken and resolved in MEM; a taken one  */
+/*     flushes the younger instructions (the padding nops are not needed)     */
+/******************************************************************************/
+class DualIssueCPU : public CPU {
+  public:
+    DualIssueCPU(
+      const std::uint32_t initialPC, const char *regFileName,
+      const char *instMemFileName, const char *dataMemFileName,
+      const bool enableDataForwarding = true,
+      const bool enableHazardDetection = true
+    ) : CPU(initialPC, regFileName, instMemFileName, dataMemFileName),
+        m_enableDataForwarding(enableDataForwarding),
+        m_enableHazardDetection(enableHazardDetection), m_ID_to_IF_issued(0) {
+      for (int s = 0; s < 2; s++) {
+        m_latch_IF_ID[s].instr = 0x00000020;
+        m_latch_IF_ID[s].valid.reset();
+        ResetSlot(&m_latch_ID_EX[s]);
+        m_latch_EX_MEM[s].ctrlMEMBranch.reset();
+        m_latch_EX_MEM[s].ctrlMEMMemRead.reset();
+        m_latch_EX_MEM[s].ctrlMEMMemWrite.reset();
+        m_latch_EX_MEM[s].ctrlWBRegWrite.reset();
+        m_latch_EX_MEM[s].ctrlWBMemToReg.reset();
+        m_latch_EX_MEM[s].ctrlWBSyscall.reset();
+        m_latch_EX_MEM[s].valid.reset();
+        m_latch_MEM_WB[s].ctrlWBRegWrite.reset();
+        m_latch_MEM_WB[s].ctrlWBMemToReg.reset();
+        m_latch_MEM_WB[s].ctrlWBSyscall.reset();
+        m_latch_MEM_WB[s].valid.reset();
+        m_WB_to_FwdUnit_regWrite[s] = 0;
+        m_MEM_to_FwdUnit_regWrite[s] = 0;
+        m_EX_to_HazDetUnit_memRead[s] = 0;
+        m_EX_to_HazDetUnit_syscall[s] = 0;
+        m_MEM_to_HazDetUnit_syscall[s] = 0;
+      }
+      for (int n = 0; n < 3; n++) {
+        m_issueCycles[n] = 0;
+      }
+      for (int r = 0; r < NUM_PAIR_LIMITS; r++) {
+        m_pairLimits[r] = 0;
+      }
+    }
+    // mult and multu take `cycles' cycles until mfhi/mflo can read their result (see
+    // PipelinedCPU::setMultiplier and MulDivUnit.hpp)
+    void setMultiplier(const unsigned cycles, const bool pipelined) { m_mulDivUnit.configure(false, cycles, pipelined); }
+    // the same for div and divu
+    void setDivider(const unsigned cycles, const bool pipelined) { m_mulDivUnit.configure(true, cycles, pipelined); }
+    const MulDivUnit &getMulDivUnit() const { return m_mulDivUnit; }
+
+    // why ID issued the older instruction alone
+    enum PairLimit {
+      PairMemory,     // both access the data memory
+      PairMulDiv,     // both use the multiplier/divider or HI/LO
+      PairControl,    // the older one is a branch or a syscall
+      PairDependence, // the younger one reads the register the older one writes
+      PairHazard,     // the younger one waits for a load, a syscall or the multiplier/divider
+      NUM_PAIR_LIMITS
+    };
+    static const char *pairLimitName(const int limit) {
+      static const char *names[NUM_PAIR_LIMITS] = {"memory", "mulDiv", "control", "dependence", "hazard"};
+      return names[limit];
+    }
+    // the cycles ID issued `n' (0, 1 or 2) instructions
+    std::uint64_t getIssueCycles(const unsigned n) const { return m_issueCycles[n]; }
+    // the cycles ID issued one instruction because of `limit'
+    std::uint64_t getPairLimits(const int limit) const { return m_pairLimits[limit]; }
+  public:
+    /*********************************************************************/
+    /* DualIssueCPU::advanceCycle                                        */
+    /*   - Simulate a single clock cycle of the dual-issue pipelined CPU */
+    /*********************************************************************/
+    virtual void advanceCycle() {
+      CPU::advanceCycle();
+      WriteBack();
+      if (isHalted()) {
+        return; // exit retired; the younger instructions never leave the pipeline
+      }
+      MemoryAccess();
+      Execute();
+      InstructionDecode();
+      InstructionFetch();
+    }
+  private:
+    // latches; [0] holds the older instruction of a pair, [1] the younger
+    struct {
+      std::bitset<32> pcPlus4;  // PC+4
+      std::bitset<32> instr;    // 32-bit instruction
+      std::bitset<1> valid;     // 1 if an instruction was fetched (0 = empty)
+    } m_latch_IF_ID[2]; // IF-ID latch
+    struct ID_EX {
+      std::bitset<32> pcPlus4;        // PC+4 (from IF)
+      std::bitset<32> readData1;      // $rs
+      std::bitset<32> readData2;      // $rt
+      std::bitset<32> immediate;      // sign-extended immediate
+      std::bitset<5> instr_25_21;     // instruction[25:21] (= rs)
+      std::bitset<5> instr_20_16;     // instruction[20:16] (= rt)
+      std::bitset<5> instr_15_11;     // instruction[15:11] (= rd)
+      std::bitset<1> ctrlEXALUSrc;    // `ALUSrc' for EX
+      std::bitset<2> ctrlEXALUOp;     // `ALUOp' for EX
+      std::bitset<1> ctrlEXRegDst;    // `RegDst' for EX
+      std::bitset<1> ctrlMEMBranch;   // `Branch' for MEM
+      std::bitset<1> ctrlMEMMemRead;  // `MemRead' for MEM
+      std::bitset<1> ctrlMEMMemWrite; // `MemWrite' for MEM
+      std::bitset<1> ctrlWBRegWrite;  // `RegWrite' for WB
+      std::bitset<1> ctrlWBMemToReg;  // `MemToReg' for WB
+      std::bitset<1> ctrlWBSyscall;   // `syscall' to be serviced in WB
+      std::bitset<1> ctrlEXMulDiv;    // mult, multu, div, divu: issue to the multiplier/divider in EX
+      std::bitset<1> ctrlEXReadHiLo;  // mfhi, mflo: HI or LO in place of the ALU result
+      std::bitset<1> readsRs;         // 1 if the instruction reads rs (0 for a bubble)
+      std::bitset<1> readsRt;         // 1 if the instruction reads rt (0 for a bubble)
+      std::bitset<1> valid;           // 1 if the latch holds an instruction (0 = bubble)
+    } m_latch_ID_EX[2]; // ID-EX latch
+    struct {
+      std::bitset<32> pcPlus4;        // PC+4 (from ID; identifies the instruction)
+      std::bitset<32> branchTarget;   // (PC+4)+(Immed<<2)
+      std::bitset<32> aluResult;      // result from the ALU
+      std::bitset<1> aluZero;         // zero from the ALU
+      std::bitset<32> readData2;      // $rt (from ID)
+      std::bitset<5> rd;              // rd
+      std::bitset<1> ctrlMEMBranch;   // `Branch' for MEM
+      std::bitset<1> ctrlMEMMemRead;  // `MemRead' for MEM
+      std::bitset<1> ctrlMEMMemWrite; // `MemWrite' for MEM
+      std::bitset<1> ctrlWBRegWrite;  // `RegWrite' for WB
+      std::bitset<1> ctrlWBMemToReg;  // `MemToReg' for WB
+      std::bitset<1> ctrlWBSyscall;   // `syscall' to be serviced in WB
+      std::bitset<1> valid;           // 1 if the latch holds an instruction (0 = bubble)
+    } m_latch_EX_MEM[2]; // EX-MEM latch
+    struct {
+      std::bitset<32> pcPlus4;        // PC+4 (from EX; identifies the instruction)
+      std::bitset<32> readData;       // readData from the data memory
+      std::bitset<32> aluResult;      // result from the ALU (from EX)
+      std::bitset<5> rd;              // rd (from EX)
+      std::bitset<1> ctrlWBRegWrite;  // `RegWrite' for WB
+      std::bitset<1> ctrlWBMemToReg;  // `MemToReg' for WB
+      std::bitset<1> ctrlWBSyscall;   // `syscall' to be serviced in WB
+      std::bitset<1> valid;           // 1 if the latch holds an instruction (0 = bubble)
+    } m_latch_MEM_WB[2]; // MEM-WB latch
+  public:
+    void printPVS() {
+      HOST_PROFILE(PrintPVS);
+      CPU::printPVS();
+      printf("Latches:\n");
+      for (int s = 0; s < 2; s++) {
+        printf("  IF-ID Latch [%d]:  pcPlus4 = 0x%08lx, instr = 0x%08lx, valid = %lu\n", s,
+               m_latch_IF_ID[s].pcPlus4.to_ulong(), m_latch_IF_ID[s].instr.to_ulong(), m_latch_IF_ID[s].valid.to_ulong());
+      }
+      for (int s = 0; s < 2; s++) {
+        printf("  ID-EX Latch [%d]:  pcPlus4 = 0x%08lx, readData1 = 0x%08lx, readData2 = 0x%08lx, valid = %lu\n", s,
+               m_latch_ID_EX[s].pcPlus4.to_ulong(), m_latch_ID_EX[s].readData1.to_ulong(),
+               m_latch_ID_EX[s].readData2.to_ulong(), m_latch_ID_EX[s].valid.to_ulong());
+      }
+      for (int s = 0; s < 2; s++) {
+        printf("  EX-MEM Latch [%d]: pcPlus4 = 0x%08lx, aluResult = 0x%08lx, rd = %lu, valid = %lu\n", s,
+               m_latch_EX_MEM[s].pcPlus4.to_ulong(), m_latch_EX_MEM[s].aluResult.to_ulong(),
+               m_latch_EX_MEM[s].rd.to_ulong(), m_latch_EX_MEM[s].valid.to_ulong());
+      }
+      for (int s = 0; s < 2; s++) {
+        printf("  MEM-WB Latch [%d]: pcPlus4 = 0x%08lx, aluResult = 0x%08lx, readData = 0x%08lx, rd = %lu, valid = %lu\n",
+               s, m_latch_MEM_WB[s].pcPlus4.to_ulong(), m_latch_MEM_WB[s].aluResult.to_ulong(),
+               m_latch_MEM_WB[s].readData.to_ulong(), m_latch_MEM_WB[s].rd.to_ulong(),
+               m_latch_MEM_WB[s].valid.to_ulong());
+      }
+      fflush(stdout);
+    }
+  private:
+    // pipeline stages
+    void InstructionFetch();
+    void InstructionDecode();
+    void Execute();
+    void MemoryAccess();
+    void WriteBack();
+    // turns the instructions in the IF-ID and ID-EX latches into bubbles (a taken branch in MEM)
+    void FlushYounger();
+    // turns an ID-EX slot into a bubble (the control signals the HDU selects on a stall)
+    static void ResetSlot(ID_EX *slot) {
+      slot->ctrlEXALUSrc.reset();
+      slot->ctrlEXALUOp.reset();
+      slot->ctrlEXRegDst.reset();
+      slot->ctrlMEMBranch.reset();
+      slot->ctrlMEMMemRead.reset();
+      slot->ctrlMEMMemWrite.reset();
+      slot->ctrlWBRegWrite.reset();
+      slot->ctrlWBMemToReg.reset();
+      slot->ctrlWBSyscall.reset();
+      slot->ctrlEXMulDiv.reset();
+      slot->ctrlEXReadHiLo.reset();
+      slot->readsRs.reset();
+      slot->readsRt.reset();
+      slot->valid.reset();
+    }
+
+  private:
+    bool m_enableDataForwarding;
+    bool m_enableHazardDetection;
+    MulDivUnit m_mulDivUnit;
+    // always-on statistics (see getIssueCycles, getPairLimits)
+    std::uint64_t m_issueCycles[3];
+    std::uint64_t m_pairLimits[NUM_PAIR_LIMITS];
+
+    /****************************************************************************/
+    /* DualIssueCPU::ForwardingUnit                                             */
+    /*   - Selects which value to forward to an operand of either slot in EX    */
+    /*   - forward = 0 (if the ReadData of the ID stage should be used)         */
+    /*               1/2 (if the result of MEM-WB slot 0/1 should be used)      */
+    /*               3/4 (if the result of EX-MEM slot 0/1 should be used)      */
+    /*   - The youngest writer of the register wins: EX-MEM slot 1, EX-MEM      */
+    /*     slot 0, MEM-WB slot 1, then MEM-WB slot 0 (see CPU::ForwardSelect)   */
+    /*   - forwardA/B = 0 for both operands without data forwarding, and for    */
+    /*     an operand the instruction does not read (readsRs/readsRt)           */
+    /****************************************************************************/
+    void ForwardingUnit(
+      const std::bitset<5> *ID_EX_rs, const std::bitset<5> *ID_EX_rt,
+      const std::bitset<1> *ID_EX_readsRs, const std::bitset<1> *ID_EX_readsRt,
+      std::bitset<3> *forwardA, std::bitset<3> *forwardB
+    );
+    // The data to be passed to the Forwarding Unit from the later stages, per slot
+    std::bitset<1>  m_MEM_to_FwdUnit_regWrite[2];  // populated in MEM
+    std::bitset<5>  m_MEM_to_FwdUnit_rd[2];        // populated in MEM
+    std::bitset<32> m_MEM_to_FwdUnit_rdValue[2];   // populated in MEM
+    std::bitset<1>  m_WB_to_FwdUnit_regWrite[2];   // populated in WB
+    std::bitset<5>  m_WB_to_FwdUnit_rd[2];         // populated in WB
+    std::bitset<32> m_WB_to_FwdUnit_rdValue[2];    // populated in WB
+
+    /****************************************************************************/
+    /* DualIssueCPU::HazardDetectionUnit                                        */
+    /*   - Detects the hazards of an instruction in IF-ID against the older     */
+    /*     pairs in EX and MEM, as PipelinedCPU::HazardDetectionUnit does:      */
+    /*     a load-use hazard on either load in EX (with hazard detection; see   */
+    /*     CPU::LoadUseHazard), a syscall in EX or MEM, and an mfhi/mflo or a   */
+    /*     mult/div the multiplier/divider cannot take yet (see                 */
+    /*     CPU::MulDivHazard); a bubble never waits                             */
+    /*   - stall = 1 if the instruction must wait in ID (`hazard' says why)     */
+    /****************************************************************************/
+    enum Hazard { NoHazard, LoadUse, SyscallDrain, MulDivResult, MulDivBusy };
+    void HazardDetectionUnit(
+      const std::bitset<1> *IF_ID_valid, const DecodedInstruction *decoded,
+      std::bitset<1> *stall, Hazard *hazard
+    );
+    // The data to be passed to the Hazard Detection Unit from the later stages, per slot
+    std::bitset<1> m_EX_to_HazDetUnit_memRead[2];  // populated in EX
+    std::bitset<5> m_EX_to_HazDetUnit_rt[2];       // populated in EX
+    std::bitset<1> m_EX_to_HazDetUnit_syscall[2];  // populated in EX
+    std::bitset<1> m_MEM_to_HazDetUnit_syscall[2]; // populated in MEM
+
+    /****************************************************************************/
+    /* DualIssueCPU::PairingUnit                                                */
+    /*   - Decides whether the younger instruction in IF-ID can issue with the  */
+    /*     older one (see the pairing rules above)                              */
+    /*   - pair = 1 if it can; otherwise `limit' is why not (see PairLimit)     */
+    /****************************************************************************/
+    void PairingUnit(
+      const DecodedInstruction *older, const DecodedInstruction *younger,
+      std::bitset<1> *pair, int *limit
+    );
+    // The number of instructions ID took from the IF-ID latch (0, 1 or 2), for IF to refill
+    unsigned m_ID_to_IF_issued;  // populated in ID
+    // The data to be passed from the MEM stage to the IF stage (PCSrc = 1 for a taken branch)
+    std::bitset<1>  m_MEM_to_IF_PCSrc = 0;
+    std::bitset<32> m_MEM_to_IF_branchTarget;
+};
+
+#endif
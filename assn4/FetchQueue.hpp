@@ -0,0 +1,86 @@
+#ifndef __FETCH_QUEUE_HPP__
+#define __FETCH_QUEUE_HPP__
+
+#include "LoopBuffer.hpp"
+
+#include <bitset>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+// an instruction fetched ahead of ID: what IF would have put in the IF-ID latch
+struct FetchedInstruction {
+  std::bitset<32> pcPlus4;
+  std::bitset<32> instr;
+  std::bitset<32> predictedPC; // the PC fetched after it (PC + 4 without a branch predictor)
+  unsigned long long seq;      // fetch sequence number (for the tracer)
+  std::bitset<1> predecoded;   // 1 if it came from the loop buffer, already decoded
+  DecodedInstruction decoded;
+};
+
+/******************************************************************************/
+/* FetchQueue                                                                 */
+/*   - The instruction queue between IF and ID of a decoupled front end (see */
+/*     PipelinedCPU::enableFetchQueue): IF fills it along the predicted path */
+/*     while there is room, ID takes one instruction per cycle from the head */
+/*   - A ring buffer of `entries' slots                                      */
+/*   - sample() records the occupancy once per cycle; the histogram is      */
+/*     indexed by the number of queued instructions                         */
+/******************************************************************************/
+class FetchQueue {
+  public:
+    FetchQueue(const unsigned entries) : m_slots(entries), m_head(0), m_size(0), m_histogram(entries + 1, 0) {
+      assert(entries > 0);
+    }
+    unsigned capacity() const { return (unsigned)m_slots.size(); }
+    unsigned size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    bool full() const { return m_size == m_slots.size(); }
+    void push(const FetchedInstruction &instruction) {
+      assert(!full());
+      size_t tail = m_head + m_size;
+      m_slots[(tail >= m_slots.size()) ? tail - m_slots.size() : tail] = instruction;
+      m_size++;
+    }
+    const FetchedInstruction &front() const { return m_slots[m_head]; }
+    // the i-th oldest instruction
+    const FetchedInstruction &at(const unsigned i) const {
+      size_t index = m_head + i;
+      return m_slots[(index >= m_slots.size()) ? index - m_slots.size() : index];
+    }
+    void pop() {
+      assert(!empty());
+      m_head = (m_head + 1 == m_slots.size()) ? 0 : m_head + 1;
+      m_size--;
+    }
+    void clear() { m_head = m_size = 0; }
+
+    void sample() { m_histogram[m_size]++; }
+    const std::vector<std::uint64_t> &getHistogram() const { return m_histogram; }
+    std::uint64_t getSamples() const {
+      std::uint64_t samples = 0;
+      for (size_t i = 0; i < m_histogram.size(); i++) { samples += m_histogram[i]; }
+      return samples;
+    }
+    double averageOccupancy() const {
+      std::uint64_t samples = getSamples(), sum = 0;
+      for (size_t i = 0; i < m_histogram.size(); i++) { sum += i * m_histogram[i]; }
+      return (samples > 0) ? (double)sum / samples : 0.0;
+    }
+    // the fraction of the cycles that ended with the queue empty (ID will get a bubble) or full (IF waits)
+    double emptyFraction() const {
+      std::uint64_t samples = getSamples();
+      return (samples > 0) ? (double)m_histogram[0] / samples : 0.0;
+    }
+    double fullFraction() const {
+      std::uint64_t samples = getSamples();
+      return (samples > 0) ? (double)m_histogram[m_slots.size()] / samples : 0.0;
+    }
+  private:
+    std::vector<FetchedInstruction> m_slots;
+    size_t m_head;
+    unsigned m_size;
+    std::vector<std::uint64_t> m_histogram;
+};
+
+#endif
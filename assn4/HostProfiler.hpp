@@ -0,0 +1,152 @@
+#ifndef __HOST_PROFILER_HPP__
+#define __HOST_PROFILER_HPP__
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/******************************************************************************/
+/* HostProfiler                                                               */
+/*   - Measures where the simulator itself spends host time: each region     */
+/*     (a pipeline stage, printPVS, a memory or register file access) adds   */
+/*     its TSC ticks and call count                                           */
+/*   - Prints the breakdown to stderr at exit, and a simulated-cycles-per-   */
+/*     second line every second while the simulation runs                    */
+/*   - Opt-in: HOST_PROFILE and HOST_PROFILE_CYCLE compile to nothing unless */
+/*     the simulator is built with -DENABLE_HOST_PROFILING                    */
+/*   - The times are inclusive: a region nested in another (e.g., a memory   */
+/*     access in MemoryAccess) is counted in both                             */
+/******************************************************************************/
+#ifdef ENABLE_HOST_PROFILING
+#define HOST_PROFILE_CONCAT2(a, b) a##b
+#define HOST_PROFILE_CONCAT(a, b) HOST_PROFILE_CONCAT2(a, b)
+#define HOST_PROFILE(region) HostProfileScope HOST_PROFILE_CONCAT(hostProfileScope, __LINE__)(HostProfiler::region)
+#define HOST_PROFILE_CYCLE(currCycle) HostProfiler::instance().cycle(currCycle)
+#else
+#define HOST_PROFILE(region) do { } while (0)
+#define HOST_PROFILE_CYCLE(currCycle) do { } while (0)
+#endif
+
+class HostProfiler {
+  public:
+    enum Region {
+      WriteBack, MemoryAccess, Execute, InstructionDecode, InstructionFetch,
+      SingleCycle, PrintPVS, MemoryAccessCall, RegisterFileAccessCall,
+      NUM_REGIONS
+    };
+    static HostProfiler &instance() {
+      static HostProfiler profiler;
+      return profiler;
+    }
+    static double now() {
+      struct timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+    static std::uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+      return __rdtsc();
+#else
+      return (std::uint64_t)(now() * 1e9);
+#endif
+    }
+    // called for the outermost scope of a region only (see HostProfileScope)
+    void add(const Region region, const std::uint64_t ticks) {
+      m_ticks[region] += ticks;
+      m_calls[region]++;
+    }
+    unsigned &depth(const Region region) { return m_depth[region]; }
+    // called once per simulated cycle; prints the progress line about once per interval
+    void cycle(const unsigned long long cycle) {
+      m_lastCycle = cycle;
+      if ((cycle & 0xFFFF) != 0) {
+        return;
+      }
+      double time = now();
+      if (time - m_lastProgressTime >= m_progressInterval) {
+        fprintf(stderr, "[host] cycle %llu: %.3f M cycles/s (%.3f M cycles/s overall)\n", cycle,
+                (cycle - m_lastProgressCycle) / (time - m_lastProgressTime) / 1e6,
+                cycle / (time - m_startTime) / 1e6);
+        m_lastProgressTime = time;
+        m_lastProgressCycle = cycle;
+      }
+    }
+    void setProgressInterval(const double seconds) { m_progressInterval = seconds; }
+    std::uint64_t regionTicks(const Region region) const { return m_ticks[region]; }
+    // calibrated against the monotonic clock over the lifetime of the profiler
+    double nsPerTick() const { return (now() - m_startTime) * 1e9 / (double)(ticks() - m_startTicks + 1); }
+    static const char *regionName(const Region region) {
+      static const char *names[NUM_REGIONS] = {
+        "WriteBack", "MemoryAccess", "Execute", "InstructionDecode", "InstructionFetch",
+        "SingleCycleCPU::advanceCycle", "printPVS", "Memory::access", "RegisterFile::access"
+      };
+      return names[region];
+    }
+    void writeReport(FILE *file) {
+      double wallSeconds = now() - m_startTime;
+      double nsPerTick = this->nsPerTick();
+      fprintf(file, "[host] %.3f s wall", wallSeconds);
+      if (m_lastCycle > 0) {
+        fprintf(file, ", %.3f M cycles/s", m_lastCycle / wallSeconds / 1e6);
+      }
+      fprintf(file, " (inclusive times)\n");
+      fprintf(file, "[host] %-30s %12s %12s %10s %7s\n", "region", "calls", "total ms", "ns/call", "wall%");
+      for (int i = 0; i < NUM_REGIONS; i++) {
+        if (m_calls[i] == 0) {
+          continue;
+        }
+        double ns = m_ticks[i] * nsPerTick;
+        fprintf(file, "[host] %-30s %12llu %12.3f %10.1f %6.1f%%\n", regionName((Region)i),
+                (unsigned long long)m_calls[i], ns / 1e6, ns / m_calls[i], 100.0 * ns / (wallSeconds * 1e9));
+      }
+    }
+    ~HostProfiler() {
+      bool any = false;
+      for (int i = 0; i < NUM_REGIONS; i++) { any = any || (m_calls[i] > 0); }
+      if (any) {
+        writeReport(stderr);
+      }
+    }
+  private:
+    HostProfiler() : m_startTicks(ticks()), m_startTime(now()), m_progressInterval(1.0),
+                     m_lastProgressTime(m_startTime), m_lastProgressCycle(0), m_lastCycle(0) {
+      for (int i = 0; i < NUM_REGIONS; i++) {
+        m_ticks[i] = m_calls[i] = 0;
+        m_depth[i] = 0;
+      }
+    }
+
+    std::uint64_t m_ticks[NUM_REGIONS];
+    std::uint64_t m_calls[NUM_REGIONS];
+    unsigned m_depth[NUM_REGIONS];
+    std::uint64_t m_startTicks;
+    double m_startTime;
+    double m_progressInterval;
+    double m_lastProgressTime;
+    unsigned long long m_lastProgressCycle;
+    unsigned long long m_lastCycle;
+};
+
+// Times its enclosing block; a region re-entered from inside itself is timed once
+class HostProfileScope {
+  public:
+    HostProfileScope(const HostProfiler::Region region) : m_region(region), m_start(0) {
+      if (HostProfiler::instance().depth(m_region)++ == 0) {
+        m_start = HostProfiler::ticks();
+      }
+    }
+    ~HostProfileScope() {
+      if (--HostProfiler::instance().depth(m_region) == 0) {
+        HostProfiler::instance().add(m_region, HostProfiler::ticks() - m_start);
+      }
+    }
+  private:
+    HostProfiler::Region m_region;
+    std::uint64_t m_start;
+};
+
+#endif
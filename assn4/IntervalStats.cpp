@@ -0,0 +1,84 @@
+#include "IntervalStats.hpp"
+
+#include "Memory.hpp"
+
+#include <cassert>
+#include <cstring>
+
+const char *IntervalStats::fieldName(const Field field) {
+  static const char *names[NUM_FIELDS] = {
+    "startCycle", "cycles", "retired", "loadUseBubbles", "syscallBubbles", "forwards", "branches",
+    "takenBranches", "redirectPenalty", "memReads", "memWrites", "touchedPages", "newPages"
+  };
+  return names[field];
+}
+
+IntervalStats::IntervalStats(FILE *file, const Format format, const unsigned long long periodCycles)
+  : m_file(file), m_format(format), m_period(periodCycles > 0 ? periodCycles : 1), m_nextSample(m_period),
+    m_pageStamps(MEMORY_SIZE >> PAGE_SHIFT, 0), m_stamp(1), m_touchedPages(0), m_newPages(0) {
+  if (m_format == CSV) {
+    for (int i = 0; i < NUM_FIELDS; i++) {
+      fprintf(m_file, "%s%s", (i == 0) ? "" : ",", fieldName((Field)i));
+    }
+    fprintf(m_file, "\n");
+  } else { // m_format == Binary
+    std::uint32_t numFields = NUM_FIELDS, reserved = 0;
+    std::uint64_t period = m_period;
+    fwrite("IVLSTAT1", 1, 8, m_file);
+    fwrite(&numFields, sizeof(numFields), 1, m_file);
+    fwrite(&reserved, sizeof(reserved), 1, m_file);
+    fwrite(&period, sizeof(period), 1, m_file);
+    for (int i = 0; i < NUM_FIELDS; i++) {
+      const char *name = fieldName((Field)i);
+      fwrite(name, 1, strlen(name) + 1, m_file);
+    }
+  }
+}
+
+void IntervalStats::sample(const PerfCounters &counters) {
+  std::uint64_t record[NUM_FIELDS];
+  record[StartCycle] = m_last.cycles;
+  record[Cycles] = counters.cycles - m_last.cycles;
+  record[Retired] = counters.retired - m_last.retired;
+  record[LoadUseBubbles] = counters.loadUseBubbles - m_last.loadUseBubbles;
+  record[SyscallBubbles] = counters.syscallBubbles - m_last.syscallBubbles;
+  record[Forwards] = 0;
+  for (int operand = 0; operand < 2; operand++) {
+    // forwards[][0] counts the operands read from the register file
+    for (int path = PerfCounters::FromMEMWB; path <= PerfCounters::FromEXMEM; path++) {
+      record[Forwards] += counters.forwards[operand][path] - m_last.forwards[operand][path];
+    }
+  }
+  record[Branches] = counters.branches - m_last.branches;
+  record[TakenBranches] = counters.takenBranches - m_last.takenBranches;
+  record[RedirectPenalty] = counters.redirectPenalty - m_last.redirectPenalty;
+  record[MemReads] = counters.memReads - m_last.memReads;
+  record[MemWrites] = counters.memWrites - m_last.memWrites;
+  record[TouchedPages] = m_touchedPages;
+  record[NewPages] = m_newPages;
+  writeRecord(record);
+
+  m_last = counters;
+  m_nextSample = counters.cycles + m_period;
+  m_touchedPages = m_newPages = 0;
+  m_stamp++;
+  assert(m_stamp != 0);
+}
+
+void IntervalStats::finish(const PerfCounters &counters) {
+  if (counters.cycles > m_last.cycles) {
+    sample(counters);
+  }
+  fflush(m_file);
+}
+
+void IntervalStats::writeRecord(const std::uint64_t *record) {
+  if (m_format == CSV) {
+    for (int i = 0; i < NUM_FIELDS; i++) {
+      fprintf(m_file, "%s%llu", (i == 0) ? "" : ",", (unsigned long long)record[i]);
+    }
+    fprintf(m_file, "\n");
+  } else { // m_format == Binary
+    fwrite(record, sizeof(std::uint64_t), NUM_FIELDS, m_file);
+  }
+}
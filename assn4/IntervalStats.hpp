@@ -0,0 +1,69 @@
+#ifndef __INTERVAL_STATS_HPP__
+#define __INTERVAL_STATS_HPP__
+
+#include "PerfCounters.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+/******************************************************************************/
+/* IntervalStats                                                              */
+/*   - Snapshots the counters of a CPU every `periodCycles' cycles and       */
+/*     writes one record per interval with the events of that interval      */
+/*     (not the running totals): cycles, retired instructions, bubbles,     */
+/*     forwards, branches and redirects, memory accesses, and the 4-KB data */
+/*     pages touched (and touched for the first time) in the interval       */
+/*   - CSV with a header line, or a compact binary file: the magic           */
+/*     "IVLSTAT1", the number of fields (uint32), a reserved uint32, the    */
+/*     period (uint64), the NUL-terminated field names, then one record of  */
+/*     uint64 (host byte order) per interval                                 */
+/*   - Costs a compare per cycle and an array update per data access, so it */
+/*     can stay on for whole runs; the counters other than cycles, retired  */
+/*     and pages are zero unless built with -DENABLE_PERF_COUNTERS           */
+/*   - See mipsphases.cpp for the phase analysis of the output              */
+/******************************************************************************/
+class IntervalStats {
+  public:
+    enum Format { CSV, Binary };
+    enum Field {
+      StartCycle, Cycles, Retired, LoadUseBubbles, SyscallBubbles, Forwards, Branches, TakenBranches,
+      RedirectPenalty, MemReads, MemWrites, TouchedPages, NewPages,
+      NUM_FIELDS
+    };
+    static const unsigned PAGE_SHIFT = 12;
+    static const char *fieldName(const Field field);
+
+    IntervalStats(FILE *file, const Format format, const unsigned long long periodCycles);
+    // true when the interval ending at `cycle' (the cycles completed so far) should be sampled
+    bool due(const unsigned long long cycle) const { return cycle >= m_nextSample; }
+    // a data memory access
+    void touch(const std::uint32_t address) {
+      std::uint32_t page = (address >> PAGE_SHIFT) % m_pageStamps.size();
+      if (m_pageStamps[page] != m_stamp) {
+        m_touchedPages++;
+        if (m_pageStamps[page] == 0) {
+          m_newPages++;
+        }
+        m_pageStamps[page] = m_stamp;
+      }
+    }
+    // end the current interval; `counters' are the running totals
+    void sample(const PerfCounters &counters);
+    // end the last (partial) interval, if any cycle has passed since the last sample
+    void finish(const PerfCounters &counters);
+  private:
+    void writeRecord(const std::uint64_t *record);
+
+    FILE *m_file;
+    Format m_format;
+    unsigned long long m_period;
+    unsigned long long m_nextSample;
+    PerfCounters m_last; // the running totals at the last sample
+    std::vector<std::uint32_t> m_pageStamps; // the last interval (from 1) that touched each page; 0 = never
+    std::uint32_t m_stamp;
+    std::uint64_t m_touchedPages;
+    std::uint64_t m_newPages;
+};
+
+#endif
@@ -0,0 +1,9 @@
+#include "KonataTracer.hpp"
+
+#include "Assembler.hpp"
+
+void KonataTracer::fetch(const unsigned long long seq, const std::uint32_t pc, const std::uint32_t instruction) {
+  fprintf(m_file, "I\t%llu\t%llu\t0\n", seq, seq);
+  fprintf(m_file, "L\t%llu\t0\t%08lx: %s\n", seq, (unsigned long)pc, Assembler::disassemble(instruction, pc).c_str());
+  stage(seq, IF);
+}
@@ -0,0 +1,74 @@
+#ifndef __KONATA_TRACER_HPP__
+#define __KONATA_TRACER_HPP__
+
+#include "PipelineTracer.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+/******************************************************************************/
+/* KonataTracer                                                               */
+/*   - Writes a pipeline occupancy trace in the Kanata format read by the    */
+/*     Konata viewer: when each instruction enters IF, ID, EX, MEM and WB,   */
+/*     why it stalled, and whether it retired or was flushed                 */
+/*   - Streams to the file as the simulation runs; only the retirements of  */
+/*     the current cycle are buffered                                         */
+/******************************************************************************/
+class KonataTracer : public PipelineTracer {
+  public:
+    KonataTracer(FILE *file) : m_file(file), m_cycle(0), m_started(false), m_numRetired(0) {
+      fprintf(m_file, "Kanata\t0004\n");
+      for (int i = 0; i < NUM_STAGES; i++) {
+        m_lastSeq[i] = ~0ULL;
+      }
+    }
+    virtual ~KonataTracer() {
+      retirePending();
+      fflush(m_file);
+    }
+    virtual void cycle(const unsigned long long cycle) {
+      if (!m_started) {
+        fprintf(m_file, "C=\t%llu\n", cycle);
+        m_started = true;
+      } else {
+        fprintf(m_file, "C\t%llu\n", cycle - m_cycle);
+      }
+      m_cycle = cycle;
+      retirePending();
+    }
+    virtual void fetch(const unsigned long long seq, const std::uint32_t pc, const std::uint32_t instruction);
+    // an instruction that stays in a stage (a stall) is reported once
+    virtual void stage(const unsigned long long seq, const Stage stage) {
+      if (m_lastSeq[stage] != seq) {
+        static const char *names[NUM_STAGES] = { "IF", "ID", "EX", "MEM", "WB" };
+        fprintf(m_file, "S\t%llu\t0\t%s\n", seq, names[stage]);
+        m_lastSeq[stage] = seq;
+      }
+    }
+    // shown when hovering over the instruction
+    virtual void stall(const unsigned long long seq, const char *reason) {
+      fprintf(m_file, "L\t%llu\t1\tstalled in ID: %s (cycle %llu); \n", seq, reason, m_cycle);
+    }
+    // retires at the start of the next cycle, so that WB is drawn for one cycle
+    virtual void retire(const unsigned long long seq) { m_pendingRetires.push_back(seq); }
+    virtual void flush(const unsigned long long seq) {
+      fprintf(m_file, "R\t%llu\t%llu\t1\n", seq, seq);
+    }
+  private:
+    void retirePending() {
+      for (size_t i = 0; i < m_pendingRetires.size(); i++) {
+        fprintf(m_file, "R\t%llu\t%llu\t0\n", m_pendingRetires[i], m_numRetired++);
+      }
+      m_pendingRetires.clear();
+    }
+
+    FILE *m_file;
+    unsigned long long m_cycle;
+    bool m_started;
+    unsigned long long m_numRetired;
+    unsigned long long m_lastSeq[NUM_STAGES]; // the last instruction reported in each stage
+    std::vector<unsigned long long> m_pendingRetires;
+};
+
+#endif
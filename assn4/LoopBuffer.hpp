@@ -0,0 +1,102 @@
+#ifndef __LOOP_BUFFER_HPP__
+#define __LOOP_BUFFER_HPP__
+
+#include "CPU.hpp"
+
+#include <bitset>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+/******************************************************************************/
+/* LoopBuffer                                                                 */
+/*   - The decoded body of a short loop, streamed by IF in place of the      */
+/*     instruction memory (see PipelinedCPU::enableLoopBuffer)               */
+/*   - A branch resolved taken to a target at most `entries' instructions    */
+/*     behind it arms the buffer for the body [target, branch]; ID captures */
+/*     each body instruction as it decodes it, and once all are captured   */
+/*     lookup() serves the body, its last instruction followed by the first */
+/*   - The buffer keeps its loop until another one is armed; a loop around  */
+/*     the streamed one does not replace it (the inner loop runs more)     */
+/******************************************************************************/
+class LoopBuffer {
+  public:
+    struct Entry {
+      std::bitset<32> instr;
+      DecodedInstruction decoded;
+    };
+    LoopBuffer(const unsigned entries)
+      : m_entries(entries), m_captured(entries, false), m_state(Idle), m_start(0), m_end(0), m_numCaptured(0),
+        m_loopsCaptured(0), m_fetchesServed(0), m_decodesSkipped(0) {
+      assert(entries > 0);
+    }
+    unsigned capacity() const { return (unsigned)m_entries.size(); }
+    bool streaming() const { return m_state == Streaming; }
+
+    // the branch at `pc' resolved taken to `target'
+    void branchTaken(const std::uint32_t pc, const std::uint32_t target) {
+      if (target > pc || (pc - target) / 4 >= m_entries.size()) {
+        return; // not a loop, or too long
+      }
+      if (m_state != Idle && target == m_start && pc == m_end) {
+        return; // the loop already in the buffer
+      }
+      if (m_state == Streaming && target <= m_start && pc >= m_end) {
+        return; // an outer loop
+      }
+      m_state = Capturing;
+      m_start = target;
+      m_end = pc;
+      m_captured.assign(m_captured.size(), false);
+      m_numCaptured = 0;
+    }
+    // ID decoded `instr' at `pc'
+    void capture(const std::uint32_t pc, const std::bitset<32> &instr, const DecodedInstruction &decoded) {
+      if (m_state != Capturing || pc < m_start || pc > m_end) {
+        return;
+      }
+      size_t index = (pc - m_start) / 4;
+      if (!m_captured[index]) {
+        m_entries[index].instr = instr;
+        m_entries[index].decoded = decoded;
+        m_captured[index] = true;
+        m_numCaptured++;
+      }
+      if (m_numCaptured == (m_end - m_start) / 4 + 1) {
+        m_state = Streaming;
+        m_loopsCaptured++;
+      }
+    }
+    // the buffered instruction at `pc' (nullptr if the buffer does not stream it)
+    const Entry *lookup(const std::uint32_t pc) const {
+      if (m_state != Streaming || pc < m_start || pc > m_end) {
+        return nullptr;
+      }
+      return &m_entries[(pc - m_start) / 4];
+    }
+    // whether `pc' is the branch that closes the buffered loop
+    bool isLoopBranch(const std::uint32_t pc) const { return pc == m_end; }
+    // the PC streamed after `pc': the loop branch is taken until it resolves otherwise
+    std::uint32_t nextPC(const std::uint32_t pc) const { return (pc == m_end) ? m_start : pc + 4; }
+
+    void countFetch() { m_fetchesServed++; }
+    void countDecode() { m_decodesSkipped++; }
+    std::uint64_t getLoopsCaptured() const { return m_loopsCaptured; }
+    // the instruction memory reads IF did not make (including the ones flushed later)
+    std::uint64_t getFetchesServed() const { return m_fetchesServed; }
+    // the instructions ID did not decode
+    std::uint64_t getDecodesSkipped() const { return m_decodesSkipped; }
+  private:
+    enum State { Idle, Capturing, Streaming };
+    std::vector<Entry> m_entries;
+    std::vector<bool> m_captured;
+    State m_state;
+    std::uint32_t m_start; // the PC of the first instruction of the loop (the branch target)
+    std::uint32_t m_end;   // the PC of the loop branch
+    unsigned m_numCaptured;
+    std::uint64_t m_loopsCaptured;
+    std::uint64_t m_fetchesServed;
+    std::uint64_t m_decodesSkipped;
+};
+
+#endif
@@ -5,6 +5,7 @@ void Memory::access(
   const std::bitset<1> *memRead, const std::bitset<1> *memWrite,
   std::bitset<32> *readData
 ) {
+  HOST_PROFILE(MemoryAccessCall);
   assert(address != nullptr);
   assert(memRead != nullptr);
   assert(readData != nullptr);
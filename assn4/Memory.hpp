@@ -1,8 +1,12 @@
 #ifndef __MEMORY_HPP__
 #define __MEMORY_HPP__
 
+#include "HostProfiler.hpp"
+#include "Verbosity.hpp"
+
 #include <bitset>
 #include <cassert>
+#include <cstdint>
 #include <cstdio>
 
 #define MEMORY_SIZE (32 * 1024 * 1024) // <-- 32-MB memory
@@ -23,9 +27,11 @@ class Memory {
         assert(initFile != NULL);
         std::uint32_t addr, value;
         while (fscanf(initFile, " %x %x", &addr, &value) == 2) {
-          printf("INFO: memory[0x%08lx..0x%08lx] <-- 0x%08lx\n",
-                 (unsigned long)addr, (unsigned long)(addr + 3),
-                 (unsigned long)value);
+          if (!quietMode()) {
+            printf("INFO: memory[0x%08lx..0x%08lx] <-- 0x%08lx\n",
+                   (unsigned long)addr, (unsigned long)(addr + 3),
+                   (unsigned long)value);
+          }
           if (m_endianness == LittleEndian) {
             m_memory[addr + 0] = (std::uint8_t)(value % 0x100); value >>= 8;
             m_memory[addr + 1] = (std::uint8_t)(value % 0x100); value >>= 8;
@@ -62,6 +68,29 @@ class Memory {
         }
       }
     }
+    // write the non-zero words in the memory initialization file format
+    void dumpMemory(FILE *file) {
+      for (size_t i = 0; i < MEMORY_SIZE; i += 4) {
+        if (m_memory[i].any() || m_memory[i + 1].any() || m_memory[i + 2].any()
+            || m_memory[i + 3].any()) {
+          std::bitset<32> address(i), value;
+          std::bitset<1> memRead(1), memWrite(0);
+          access(&address, nullptr, &memRead, &memWrite, &value);
+          fprintf(file, "%x %08lx\n", (unsigned)i, value.to_ulong());
+        }
+      }
+    }
+    // FNV-1a hash of the non-zero words; used to compare the final states of two runs
+    std::uint64_t digest() {
+      std::uint64_t hash = 14695981039346656037ULL;
+      for (size_t i = 0; i < MEMORY_SIZE; i++) {
+        if (m_memory[i].any()) {
+          hash = (hash ^ (std::uint64_t)i) * 1099511628211ULL;
+          hash = (hash ^ m_memory[i].to_ulong()) * 1099511628211ULL;
+        }
+      }
+      return hash;
+    }
     void access(
       const std::bitset<32> *address, const std::bitset<32> *writeData,
       const std::bitset<1> *memRead, const std::bitset<1> *memWrite,
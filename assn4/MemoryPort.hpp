@@ -0,0 +1,89 @@
+#ifndef __MEMORY_PORT_HPP__
+#define __MEMORY_PORT_HPP__
+
+#include "DataCache.hpp"
+#include "Memory.hpp"
+
+#include <bitset>
+#include <cassert>
+#include <cstdint>
+
+/******************************************************************************/
+/* MemoryPort                                                                 */
+/*   - The timing of a stage's port to a Memory: a stage presents a request   */
+/*     every cycle until request() answers ready, then reads or writes the    */
+/*     Memory through access() as if it had been a single-cycle memory        */
+/*   - A new request takes `latency' cycles (1 = ready in the same cycle);    */
+/*     the port is busy until then, and a request for another block takes     */
+/*     over the port (the stage went elsewhere)                               */
+/*   - A port with a block buffer keeps the last block it returned, so the    */
+/*     requests to that block are ready at once (the fetch buffer of IF);     */
+/*     without one, every access is a request of its own                      */
+/*   - With a cache (see DataCache.hpp), the cache tells how long each new    */
+/*     request takes instead                                                  */
+/*   - tick() advances the request in flight by one cycle, whether the stage  */
+/*     waits for it this cycle or not                                         */
+/******************************************************************************/
+class MemoryPort {
+  public:
+    MemoryPort(Memory *memory, const std::uint32_t blockBytes, const bool blockBuffer)
+      : m_memory(memory), m_blockMask(~(blockBytes - 1)), m_blockBuffer(blockBuffer), m_latency(1),
+        m_cache(nullptr), m_block(NO_BLOCK), m_wait(0), m_requests(0), m_busyCycles(0) {
+      assert(blockBytes >= 4 && (blockBytes & (blockBytes - 1)) == 0);
+    }
+    void setLatency(const unsigned cycles) { m_latency = (cycles > 0) ? cycles : 1; }
+    unsigned latency() const { return m_latency; }
+    // the timing of the requests comes from `cache' (nullptr: every request takes `latency' cycles)
+    void setCache(DataCache *cache) { m_cache = cache; }
+    Memory *memory() const { return m_memory; }
+
+    // one cycle passed
+    void tick() {
+      if (m_wait > 0) {
+        m_wait--;
+        m_busyCycles++;
+      }
+    }
+    // presents a request to read (or `write') `address' this cycle; true when the data is ready (access()
+    // may be called)
+    bool request(const std::uint32_t address, const bool write = false) {
+      const std::uint32_t block = address & m_blockMask;
+      if (block != m_block) {
+        m_block = block;
+        m_wait = ((m_cache != nullptr) ? m_cache->access(address, write) : m_latency) - 1;
+        m_requests++;
+      }
+      if (m_wait > 0) {
+        return false;
+      }
+      if (!m_blockBuffer) {
+        m_block = NO_BLOCK; // the response is consumed; the next access is a new request
+      }
+      return true;
+    }
+    bool busy() const { return m_wait > 0; }
+    void access(
+      const std::bitset<32> *address, const std::bitset<32> *writeData,
+      const std::bitset<1> *memRead, const std::bitset<1> *memWrite,
+      std::bitset<32> *readData
+    ) {
+      m_memory->access(address, writeData, memRead, memWrite, readData);
+    }
+
+    // the requests started and the cycles the port was busy with one
+    unsigned long long getRequests() const { return m_requests; }
+    unsigned long long getBusyCycles() const { return m_busyCycles; }
+  private:
+    static const std::uint32_t NO_BLOCK = 0xFFFFFFFF;
+    Memory *m_memory;
+    std::uint32_t m_blockMask;
+    bool m_blockBuffer;
+    unsigned m_latency;
+    DataCache *m_cache;
+    std::uint32_t m_block; // <-- the block in the buffer or being requested (NO_BLOCK: none)
+    unsigned m_wait;       // <-- the cycles until the block arrives (0 = ready)
+    unsigned long long m_requests;
+    unsigned long long m_busyCycles;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef __MUL_DIV_UNIT_HPP__
+#define __MUL_DIV_UNIT_HPP__
+
+#include <bitset>
+#include <cstdint>
+#include <cstdlib>
+
+/******************************************************************************/
+/* MulDivUnit                                                                 */
+/*   - The timing of the multiplier and the divider behind mult, multu, div   */
+/*     and divu (see PipelinedCPU::setMultiplier/setDivider); the results     */
+/*     come from CPU::MulDiv when the operation issues in EX                  */
+/*   - Each unit takes `cycles' cycles from the issue until HI and LO hold    */
+/*     its result; a pipelined unit accepts an operation every cycle, an      */
+/*     iterative one only once its previous operation finished                */
+/*   - An operation does not issue before the one in flight on the other      */
+/*     unit would finish ahead of it, so HI and LO are written in order       */
+/*   - mfhi and mflo wait until every issued operation finished               */
+/******************************************************************************/
+class MulDivUnit {
+  public:
+    MulDivUnit() : m_resultStalls(0), m_busyStalls(0) {
+      configure(false, 1, true);
+      configure(true, 1, true);
+    }
+    // the multiplier (`divider' = false) or the divider takes `cycles' cycles per operation
+    void configure(const bool divider, const unsigned cycles, const bool pipelined) {
+      Unit &unit = m_units[divider ? 1 : 0];
+      unit.cycles = (cycles > 0) ? cycles : 1;
+      unit.pipelined = pipelined;
+      unit.readyCycle = 0;
+      unit.issued = 0;
+    }
+    // "cycles" (iterative) or "cycles" followed by `p' (pipelined), e.g., "32" or "4p"; false if malformed
+    static bool parseTiming(const char *spec, unsigned *cycles, bool *pipelined) {
+      char *end;
+      unsigned long value = strtoul(spec, &end, 0);
+      *pipelined = (*end == 'p');
+      if (*pipelined) {
+        end++;
+      }
+      *cycles = (unsigned)value;
+      return end != spec && *end == '\0' && value > 0;
+    }
+    unsigned cycles(const bool divider) const { return m_units[divider ? 1 : 0].cycles; }
+    bool pipelined(const bool divider) const { return m_units[divider ? 1 : 0].pipelined; }
+    // the unit of the operation with `funct' (div 0x1A and divu 0x1B have bit 1 set)
+    static bool isDivide(const std::bitset<6> &funct) { return funct.test(1); }
+
+    // whether an operation can issue in EX in `cycle'
+    bool canIssue(const bool divider, const unsigned long long cycle) const {
+      const Unit &unit = m_units[divider ? 1 : 0];
+      const Unit &other = m_units[divider ? 0 : 1];
+      if (!unit.pipelined && unit.readyCycle > cycle) {
+        return false; // still iterating on the previous operation
+      }
+      return other.readyCycle <= cycle + unit.cycles;
+    }
+    // an operation issued in EX in `cycle'
+    void issue(const bool divider, const unsigned long long cycle) {
+      Unit &unit = m_units[divider ? 1 : 0];
+      unit.readyCycle = cycle + unit.cycles;
+      unit.issued++;
+    }
+    // the first cycle in which HI and LO hold the results of every issued operation
+    unsigned long long readyCycle() const {
+      return (m_units[0].readyCycle > m_units[1].readyCycle) ? m_units[0].readyCycle : m_units[1].readyCycle;
+    }
+
+    // ID held an mfhi/mflo for a result, or an operation for a busy unit, for a cycle
+    void countStall(const bool busy) {
+      m_busyStalls += busy ? 1 : 0;
+      m_resultStalls += busy ? 0 : 1;
+    }
+    std::uint64_t getIssued(const bool divider) const { return m_units[divider ? 1 : 0].issued; }
+    std::uint64_t getResultStalls() const { return m_resultStalls; }
+    std::uint64_t getBusyStalls() const { return m_busyStalls; }
+  private:
+    struct Unit {
+      unsigned cycles;
+      bool pipelined;
+      unsigned long long readyCycle; // the cycle the last issued operation finishes
+      std::uint64_t issued;
+    };
+    Unit m_units[2]; // the multiplier and the divider
+    std::uint64_t m_resultStalls;
+    std::uint64_t m_busyStalls;
+};
+
+#endif
@@ -0,0 +1,547 @@
+#include "OutOfOrderCPU.hpp"
+
+#include <algorithm>
+
+void OutOfOrderCPU::InstructionFetch()
+{
+  HOST_PROFILE(InstructionFetch);
+  // fetch queue에 자리가 있으면 한 cycle에 width개까지 predicted path를 따라 fetch (taken 예측이면 거기까지)
+  // m_PC는 마지막으로 fetch한 명령의 PC, m_fetchPC는 다음에 fetch할 PC
+  std::bitset<32> four(4);
+  std::bitset<1> memRead(1);
+  std::bitset<1> memWrite(0);
+  for (unsigned n = 0; n < m_width && !m_fetchQueue.full(); n++)
+  {
+    FetchedInstruction fetched;
+    m_PC = m_fetchPC;
+    m_instMemory->access(&m_PC, nullptr, &memRead, &memWrite, &fetched.instr);
+    Add<32>(&m_PC, &four, &fetched.pcPlus4);
+    fetched.predictedPC = fetched.pcPlus4;
+    if (m_branchPredictor != nullptr)
+    {
+      fetched.predictedPC = m_branchPredictor->predict((std::uint32_t)m_PC.to_ulong());
+    }
+    fetched.seq = 0;
+    fetched.predecoded = 0;
+    m_fetchQueue.push(fetched);
+    m_fetchPC = fetched.predictedPC;
+    if (fetched.predictedPC != fetched.pcPlus4)
+    {
+      break;
+    }
+  }
+}
+
+void OutOfOrderCPU::Dispatch()
+{
+  HOST_PROFILE(InstructionDecode);
+  // fetch queue의 앞에서부터 순서대로 width개까지 decode, rename 해서 ROB, RS, (lw, sw면) LSQ에 넣는다.
+  // 어느 하나라도 자리가 없으면 그 명령부터 다음 cycle로 (in-order dispatch)
+  for (unsigned n = 0; n < m_width && !m_fetchQueue.empty(); n++)
+  {
+    const FetchedInstruction &fetched = m_fetchQueue.front();
+    DecodedInstruction decoded;
+    Decode(&fetched.instr, &decoded);
+    bool memory = (decoded.memRead == 1 || decoded.memWrite == 1);
+    // syscall은 ROB가 빌 때까지 기다렸다가 들어가고, commit될 때까지 뒤의 명령을 막는다.
+    if (m_serializing || (decoded.syscall == 1 && m_robSize > 0))
+    {
+      break;
+    }
+    if (m_robSize == m_rob.size())
+    {
+      m_fullCycles[WindowROB]++;
+      break;
+    }
+    int rs = -1;
+    for (size_t i = 0; i < m_rs.size() && decoded.syscall == 0; i++)
+    {
+      if (!m_rs[i].busy)
+      {
+        rs = (int)i;
+        break;
+      }
+    }
+    if (decoded.syscall == 0 && rs < 0)
+    {
+      m_fullCycles[WindowRS]++;
+      break;
+    }
+    if (memory && m_lsqSize == m_lsq.size())
+    {
+      m_fullCycles[WindowLSQ]++;
+      break;
+    }
+
+    // ROB entry 할당 (tail)
+    int rob = (int)ROBIndex(m_robSize);
+    m_robSize++;
+    ROBEntry &entry = m_rob[rob];
+    std::bitset<32> minusFour(-4);
+    entry.busy = true;
+    entry.done = (decoded.syscall == 1); // syscall은 commit에서 SyscallUnit이 처리
+    entry.seq = m_nextSeq++;
+    Add<32>(&fetched.pcPlus4, &minusFour, &entry.pc);
+    entry.instr = fetched.instr;
+    entry.decoded = decoded;
+    entry.predictedPC = fetched.predictedPC;
+    entry.nextPC = fetched.pcPlus4;
+    entry.taken = false;
+    // 목적 register: regDst가 1이면 rd, 0이면 rt (syscall, mult, div는 $zero), mult, div는 HI/LO
+    std::bitset<5> writeReg;
+    CPU::Mux<5>(&decoded.rt, &decoded.rd, &decoded.regDst, &writeReg);
+    entry.dest = (decoded.mulDiv == 1) ? HILO_REG
+               : (decoded.regWrite == 1 && decoded.syscall == 0) ? (unsigned)writeReg.to_ulong() : 0;
+
+    if (decoded.syscall == 1)
+    {
+      m_serializing = true;
+    }
+    else
+    {
+      // operand는 rename table을 보고 읽는다 (이 명령의 목적 register를 rename하기 전에)
+      RSEntry &station = m_rs[rs];
+      station.busy = true;
+      station.rob = rob;
+      station.seq = entry.seq;
+      station.jFromHi = (decoded.readsHiLo == 1 && decoded.funct == 0x10); // mfhi
+      station.vj = 0;
+      station.vk = 0;
+      station.qj = -1;
+      station.qk = -1;
+      if (decoded.readsHiLo == 1)
+      {
+        ReadOperand(HILO_REG, station.jFromHi, &station.vj, &station.qj);
+      }
+      else
+      {
+        if (decoded.readsRs == 1)
+        {
+          ReadOperand((unsigned)decoded.rs.to_ulong(), false, &station.vj, &station.qj);
+        }
+        if (decoded.readsRt == 1)
+        {
+          ReadOperand((unsigned)decoded.rt.to_ulong(), false, &station.vk, &station.qk);
+        }
+      }
+    }
+    if (entry.dest != 0)
+    {
+      m_renameTable[entry.dest] = rob;
+    }
+
+    // LSQ entry 할당 (tail, program order)
+    if (memory)
+    {
+      LSQEntry &access = m_lsq[LSQIndex(m_lsqSize)];
+      m_lsqSize++;
+      access.store = (decoded.memWrite == 1);
+      access.rob = rob;
+      access.seq = entry.seq;
+      access.addressKnown = false;
+      access.performed = false;
+    }
+    m_fetchQueue.pop();
+  }
+}
+
+void OutOfOrderCPU::ReadOperand(const unsigned reg, const bool hi, std::bitset<32> *value, int *tag)
+{
+  // commit된 값이면 register file (또는 HI, LO)에서, ROB에 계산된 값이 있으면 ROB에서, 아니면 tag를 기다린다.
+  int rob = m_renameTable[reg];
+  *tag = -1;
+  if (rob < 0)
+  {
+    if (reg == HILO_REG)
+    {
+      *value = hi ? m_HI : m_LO;
+    }
+    else
+    {
+      std::bitset<5> readReg(reg);
+      std::bitset<32> unused;
+      m_registerFile->access(&readReg, &readReg, nullptr, nullptr, nullptr, value, &unused);
+    }
+  }
+  else if (m_rob[rob].done)
+  {
+    *value = hi ? m_rob[rob].hiValue : m_rob[rob].value;
+  }
+  else
+  {
+    *tag = rob;
+  }
+}
+
+void OutOfOrderCPU::Issue()
+{
+  HOST_PROFILE(Execute);
+  // operand가 모두 준비된 RS entry 중 오래된 것부터 width개까지 issue (ALU는 width개, multiplier/divider는 하나씩)
+  std::vector<int> ready;
+  for (size_t i = 0; i < m_rs.size(); i++)
+  {
+    if (m_rs[i].busy && m_rs[i].qj < 0 && m_rs[i].qk < 0)
+    {
+      ready.push_back((int)i);
+    }
+  }
+  std::sort(ready.begin(), ready.end(), [this](const int a, const int b) { return m_rs[a].seq < m_rs[b].seq; });
+
+  unsigned issued = 0;
+  for (size_t r = 0; r < ready.size() && issued < m_width; r++)
+  {
+    RSEntry &station = m_rs[ready[r]];
+    ROBEntry &entry = m_rob[station.rob];
+    const DecodedInstruction &decoded = entry.decoded;
+    if (decoded.mulDiv == 1 && !m_mulDivUnit.canIssue(MulDivUnit::isDivide(decoded.funct), getCurrCycle()))
+    {
+      m_mulDivUnit.countStall(true);
+      continue;
+    }
+
+    InFlight result;
+    result.rob = station.rob;
+    result.seq = station.seq;
+    result.readyCycle = getCurrCycle() + 1;
+    result.broadcast = (entry.dest != 0);
+    bool load = false;
+    if (decoded.mulDiv == 1)
+    {
+      // HI, LO는 ROB를 거쳐 commit에서 쓴다 (LO = value, HI = hiValue)
+      bool divider = MulDivUnit::isDivide(decoded.funct);
+      MulDiv(&station.vj, &station.vk, &decoded.funct, &result.hiValue, &result.value);
+      m_mulDivUnit.issue(divider, getCurrCycle());
+      result.readyCycle = getCurrCycle() + m_mulDivUnit.cycles(divider);
+    }
+    else if (decoded.readsHiLo == 1)
+    {
+      result.value = station.vj; // mfhi면 HI, mflo면 LO (dispatch 또는 CDB에서 골라 둠)
+    }
+    else
+    {
+      // ALU: ALUSrc가 1이면 immediate, 0이면 rt
+      std::bitset<32> aluInput2;
+      CPU::Mux<32>(&station.vk, &decoded.immediate, &decoded.aluSrc, &aluInput2);
+      std::bitset<4> aluControl;
+      ALUControl(&decoded.aluOp, &decoded.funct, &aluControl);
+      std::bitset<32> aluResult;
+      std::bitset<1> aluZero;
+      ALU(&station.vj, &aluInput2, &aluControl, &aluResult, &aluZero);
+      if (decoded.memRead == 1 || decoded.memWrite == 1)
+      {
+        // lw, sw는 계산한 address (sw는 data도)를 다음 cycle부터 LSQ에서 볼 수 있다.
+        for (unsigned i = 0; i < m_lsqSize; i++)
+        {
+          LSQEntry &access = m_lsq[LSQIndex(i)];
+          if (access.rob == station.rob)
+          {
+            access.address = aluResult;
+            access.data = station.vk;
+            access.addressKnown = true;
+            access.readyCycle = getCurrCycle() + 1;
+          }
+        }
+        load = (decoded.memRead == 1); // load의 결과는 LSQ가 data memory를 읽은 뒤에
+        result.broadcast = false;
+      }
+      else if (decoded.branch == 1)
+      {
+        // branch target = (PC+4)+(Immed<<2); taken이면 다음 PC는 branch target
+        std::bitset<32> four(4);
+        std::bitset<32> pcPlus4;
+        std::bitset<32> shiftleft2Immediate;
+        Add<32>(&entry.pc, &four, &pcPlus4);
+        ShiftLeft2<32>(&decoded.immediate, &shiftleft2Immediate);
+        Add<32>(&pcPlus4, &shiftleft2Immediate, &entry.branchTarget);
+        entry.taken = (aluZero == 1);
+        CPU::Mux<32>(&pcPlus4, &entry.branchTarget, &aluZero, &entry.nextPC);
+      }
+      else
+      {
+        result.value = aluResult;
+      }
+    }
+    if (!load)
+    {
+      m_inFlight.push_back(result);
+    }
+    station.busy = false;
+    issued++;
+  }
+  m_issueHistogram[issued]++;
+}
+
+void OutOfOrderCPU::LoadStoreQueue()
+{
+  HOST_PROFILE(MemoryAccess);
+  // data memory의 read port는 하나: address를 아는 load 중 가장 오래된, 앞선 store에 막히지 않은 load 하나를 처리
+  for (unsigned i = 0; i < m_lsqSize; i++)
+  {
+    LSQEntry &load = m_lsq[LSQIndex(i)];
+    if (load.store || !load.addressKnown || load.performed || load.readyCycle > getCurrCycle())
+    {
+      continue;
+    }
+    // 앞선 store의 address를 모두 알아야 하고, 겹치는 store 중 가장 최근 것이 같은 address면 그 data를 가져온다.
+    // (일부만 겹치면 그 store가 commit해서 data memory에 쓸 때까지 기다림)
+    bool blocked = false;
+    int source = -1;
+    for (unsigned j = 0; j < i && !blocked; j++)
+    {
+      const LSQEntry &store = m_lsq[LSQIndex(j)];
+      if (!store.store)
+      {
+        continue;
+      }
+      if (!store.addressKnown || store.readyCycle > getCurrCycle())
+      {
+        blocked = true;
+        break;
+      }
+      std::uint32_t storeAddress = (std::uint32_t)store.address.to_ulong();
+      std::uint32_t loadAddress = (std::uint32_t)load.address.to_ulong();
+      if (storeAddress + 3 >= loadAddress && loadAddress + 3 >= storeAddress)
+      {
+        source = (int)j;
+      }
+    }
+    if (!blocked && source >= 0 && m_lsq[LSQIndex(source)].address != load.address)
+    {
+      blocked = true;
+    }
+    if (blocked)
+    {
+      continue;
+    }
+
+    InFlight result;
+    result.rob = load.rob;
+    result.seq = load.seq;
+    result.readyCycle = getCurrCycle() + 1;
+    result.broadcast = (m_rob[load.rob].dest != 0);
+    if (source >= 0)
+    {
+      result.value = m_lsq[LSQIndex(source)].data;
+    }
+    else if (load.address.to_ulong() <= MEMORY_SIZE - 4)
+    {
+      std::bitset<1> memRead(1);
+      std::bitset<1> memWrite(0);
+      m_dataMemory->access(&load.address, nullptr, &memRead, &memWrite, &result.value);
+    }
+    else
+    {
+      result.value = 0; // wrong path의 load만 data memory 밖을 읽는다 (squash될 값)
+    }
+    load.performed = true;
+    m_inFlight.push_back(result);
+    break;
+  }
+}
+
+void OutOfOrderCPU::Complete()
+{
+  HOST_PROFILE(WriteBack);
+  // 이번 cycle에 끝나는 결과를 오래된 것부터 CDB에 (한 cycle에 width개까지, 나머지는 다음 cycle로)
+  // store, branch, $zero에 쓰는 명령은 CDB 없이 ROB에 done만 표시
+  std::vector<InFlight> finished;
+  std::vector<InFlight> pending;
+  for (size_t i = 0; i < m_inFlight.size(); i++)
+  {
+    if (m_inFlight[i].readyCycle <= getCurrCycle())
+    {
+      finished.push_back(m_inFlight[i]);
+    }
+    else
+    {
+      pending.push_back(m_inFlight[i]);
+    }
+  }
+  m_inFlight.swap(pending);
+  std::sort(finished.begin(), finished.end(), [](const InFlight &a, const InFlight &b) { return a.seq < b.seq; });
+
+  unsigned broadcasts = 0;
+  for (size_t i = 0; i < finished.size(); i++)
+  {
+    InFlight &result = finished[i];
+    ROBEntry &entry = m_rob[result.rob];
+    if (!entry.busy || entry.seq != result.seq)
+    {
+      continue; // 앞선 branch가 이번 cycle에 squash한 명령
+    }
+    if (result.broadcast)
+    {
+      if (broadcasts == m_width)
+      {
+        m_cdbConflicts++;
+        result.readyCycle = getCurrCycle() + 1;
+        m_inFlight.push_back(result);
+        continue;
+      }
+      broadcasts++;
+      // CDB: 이 tag를 기다리는 RS entry의 operand를 채운다.
+      for (size_t s = 0; s < m_rs.size(); s++)
+      {
+        RSEntry &station = m_rs[s];
+        if (!station.busy)
+        {
+          continue;
+        }
+        if (station.qj == result.rob)
+        {
+          station.vj = station.jFromHi ? result.hiValue : result.value;
+          station.qj = -1;
+        }
+        if (station.qk == result.rob)
+        {
+          station.vk = result.value;
+          station.qk = -1;
+        }
+      }
+    }
+    entry.value = result.value;
+    entry.hiValue = result.hiValue;
+    entry.done = true;
+    // branch: IF가 그 다음에 fetch한 PC가 틀렸으면 뒤의 명령을 squash하고 실제 다음 PC부터 다시 fetch
+    if (entry.decoded.branch == 1 && entry.nextPC != entry.predictedPC)
+    {
+      SquashYounger(result.rob);
+    }
+  }
+}
+
+void OutOfOrderCPU::SquashYounger(const int rob)
+{
+  const unsigned long long seq = m_rob[rob].seq;
+  unsigned long long squashed = 0;
+  while (m_robSize > 0 && (int)ROBIndex(m_robSize - 1) != rob)
+  {
+    m_rob[ROBIndex(m_robSize - 1)].busy = false;
+    m_robSize--;
+    squashed++;
+  }
+  for (size_t i = 0; i < m_rs.size(); i++)
+  {
+    if (m_rs[i].busy && m_rs[i].seq > seq)
+    {
+      m_rs[i].busy = false;
+    }
+  }
+  while (m_lsqSize > 0 && m_lsq[LSQIndex(m_lsqSize - 1)].seq > seq)
+  {
+    m_lsqSize--;
+  }
+  std::vector<InFlight> surviving;
+  for (size_t i = 0; i < m_inFlight.size(); i++)
+  {
+    if (m_inFlight[i].seq <= seq)
+    {
+      surviving.push_back(m_inFlight[i]);
+    }
+  }
+  m_inFlight.swap(surviving);
+  // rename map 복구: 남은 ROB entry를 오래된 것부터 다시 rename
+  for (unsigned r = 0; r < NUM_RENAMED_REGS; r++)
+  {
+    m_renameTable[r] = -1;
+  }
+  for (unsigned i = 0; i < m_robSize; i++)
+  {
+    if (m_rob[ROBIndex(i)].dest != 0)
+    {
+      m_renameTable[m_rob[ROBIndex(i)].dest] = (int)ROBIndex(i);
+    }
+  }
+  PERF_COUNT(m_perfCounters.redirectPenalty += squashed + m_fetchQueue.size());
+  m_squashed += squashed;
+  m_fetchQueue.clear();
+  m_fetchPC = m_rob[rob].nextPC;
+}
+
+void OutOfOrderCPU::Commit()
+{
+  HOST_PROFILE(WriteBack);
+  // ROB의 head부터 done인 명령을 program order로 width개까지 commit (data memory의 write port는 하나)
+  bool stored = false;
+  for (unsigned n = 0; n < m_width && m_robSize > 0; n++)
+  {
+    const int rob = (int)m_robHead;
+    ROBEntry &entry = m_rob[rob];
+    const DecodedInstruction &decoded = entry.decoded;
+    if (!entry.done || (decoded.memWrite == 1 && stored))
+    {
+      break;
+    }
+    if (decoded.memRead == 1 || decoded.memWrite == 1)
+    {
+      // LSQ의 head가 이 명령; store는 이제야 data memory에 쓴다.
+      LSQEntry &access = m_lsq[m_lsqHead];
+      assert(access.rob == rob);
+      if (decoded.memWrite == 1)
+      {
+        std::bitset<1> memRead(0);
+        std::bitset<1> memWrite(1);
+        std::bitset<32> unused;
+        m_dataMemory->access(&access.address, &access.data, &memRead, &memWrite, &unused);
+        stored = true;
+      }
+      PERF_COUNT(m_perfCounters.memReads += decoded.memRead.to_ulong());
+      PERF_COUNT(m_perfCounters.memWrites += decoded.memWrite.to_ulong());
+      if (m_intervalStats != nullptr)
+      {
+        m_intervalStats->touch((std::uint32_t)access.address.to_ulong());
+      }
+      m_lsqHead = LSQIndex(1);
+      m_lsqSize--;
+    }
+    // 목적 register (HI/LO) 에 쓴다.
+    if (entry.dest == HILO_REG)
+    {
+      m_HI = entry.hiValue;
+      m_LO = entry.value;
+    }
+    else if (entry.dest != 0)
+    {
+      std::bitset<5> writeReg(entry.dest);
+      std::bitset<1> regWrite(1);
+      m_registerFile->access(nullptr, nullptr, &writeReg, &entry.value, &regWrite, nullptr, nullptr);
+    }
+    if (entry.dest != 0 && m_renameTable[entry.dest] == rob)
+    {
+      m_renameTable[entry.dest] = -1;
+    }
+    // branch는 program order로 여기서 기록하고 predictor를 학습시킨다.
+    if (decoded.branch == 1)
+    {
+      bool mispredicted = (entry.nextPC != entry.predictedPC);
+      PERF_COUNT(m_perfCounters.branches++;
+                 m_perfCounters.takenBranches += entry.taken ? 1 : 0;
+                 m_perfCounters.mispredictions += (m_branchPredictor != nullptr && mispredicted) ? 1 : 0);
+      if (m_branchTrace != nullptr)
+      {
+        m_branchTrace->record((std::uint32_t)entry.pc.to_ulong(), (std::uint32_t)entry.branchTarget.to_ulong(),
+                              entry.taken);
+      }
+      if (m_branchPredictor != nullptr)
+      {
+        m_branchPredictor->resolve((std::uint32_t)entry.pc.to_ulong(), entry.taken,
+                                   (std::uint32_t)entry.branchTarget.to_ulong(), mispredicted);
+      }
+    }
+    PERF_COUNT(m_perfCounters.countInstruction(decoded.opcode.to_ulong(), decoded.funct.to_ulong()));
+    m_numRetired++;
+    entry.busy = false;
+    m_robHead = ROBIndex(1);
+    m_robSize--;
+    // syscall: 앞선 명령은 모두 commit됐고 뒤의 명령은 아직 dispatch되지 않았다.
+    if (decoded.syscall == 1)
+    {
+      m_serializing = false;
+      m_syscallUnit->execute();
+      if (isHalted())
+      {
+        return;
+      }
+    }
+  }
+}
@@ -0,0 +1,278 @@
+#ifndef __OUT_OF_ORDER_CPU_HPP__
+#define __OUT_OF_ORDER_CPU_HPP__
+
+#include "BranchPredictor.hpp"
+#include "CPU.hpp"
+#include "FetchQueue.hpp"
+#include "MulDivUnit.hpp"
+
+#include <vector>
+
+/******************************************************************************/
+/* OutOfOrderCPU                                                              */
+/*   - A superscalar out-of-order core with Tomasulo scheduling: IF fetches   */
+/*     `width' instructions per cycle along the predicted path into a fetch   */
+/*     queue, dispatch renames up to `width' of them in order into the        */
+/*     reorder buffer (ROB), the reservation stations (RS) and, for lw and    */
+/*     sw, the load/store queue (LSQ)                                         */
+/*   - Renaming maps each register (and HI/LO as one) to the ROB entry of     */
+/*     its youngest writer; an RS entry holds the value of each operand or    */
+/*     the tag of the ROB entry that will produce it                          */
+/*   - Up to `width' ready RS entries issue per cycle, oldest first, to the   */
+/*     ALUs (1 cycle; CPU::ALU computes the results) or the multiplier/       */
+/*     divider (see MulDivUnit.hpp); lw and sw compute their address with an  */
+/*     ALU into the LSQ                                                       */
+/*   - Up to `width' results per cycle go out on the common data bus (CDB),   */
+/*     oldest first, to the waiting RS entries and the ROB                    */
+/*   - A load reads the data memory (one load per cycle) once every older     */
+/*     store has its address, taking the data of the youngest older store to  */
+/*     the same address instead; stores write the data memory at commit       */
+/*   - Up to `width' done instructions commit per cycle in program order from */
+/*     the head of the ROB to the register file, HI/LO and the data memory,   */
+/*     so the architectural state matches SingleCycleCPU instruction by       */
+/*     instruction                                                            */
+/*   - A branch resolves when it executes; a wrong prediction (not taken      */
+/*     without a predictor) squashes the younger instructions, restores the   */
+/*     rename map from the ROB and refetches (the padding nops are not        */
+/*     needed). A syscall waits in dispatch until the ROB drains, executes at */
+/*     commit, and holds the younger instructions in dispatch until then      */
+/******************************************************************************/
+class OutOfOrderCPU : public CPU {
+  public:
+    static const unsigned MAX_WIDTH = 8;
+    OutOfOrderCPU(
+      const std::uint32_t initialPC, const char *regFileName,
+      const char *instMemFileName, const char *dataMemFileName,
+      const unsigned width = 2, const unsigned robEntries = 32,
+      const unsigned rsEntries = 16, const unsigned lsqEntries = 16
+    ) : CPU(initialPC, regFileName, instMemFileName, dataMemFileName),
+        m_width(width), m_fetchQueue(2 * width), m_rob(robEntries), m_robHead(0), m_robSize(0),
+        m_rs(rsEntries), m_lsq(lsqEntries), m_lsqHead(0), m_lsqSize(0), m_serializing(false), m_nextSeq(0),
+        m_branchPredictor(nullptr), m_issueHistogram(width + 1, 0), m_squashed(0), m_cdbConflicts(0) {
+      if (width == 0 || width > MAX_WIDTH || robEntries == 0 || rsEntries == 0 || lsqEntries == 0) {
+        fprintf(stderr, "ERROR: the width must be 1-%u and every window at least one entry.\n", MAX_WIDTH);
+        fflush(stderr);
+        assert(width > 0 && width <= MAX_WIDTH && robEntries > 0 && rsEntries > 0 && lsqEntries > 0);
+      }
+      for (unsigned r = 0; r < NUM_RENAMED_REGS; r++) {
+        m_renameTable[r] = -1;
+      }
+      for (size_t i = 0; i < m_rs.size(); i++) {
+        m_rs[i].busy = false;
+      }
+      for (size_t i = 0; i < m_rob.size(); i++) {
+        m_rob[i].busy = false;
+      }
+      for (int w = 0; w < NUM_WINDOWS; w++) {
+        m_occupancy[w] = 0;
+        m_fullCycles[w] = 0;
+      }
+      std::bitset<32> four(4);
+      Add<32>(&m_PC, &four, &m_fetchPC);
+    }
+    virtual ~OutOfOrderCPU() {
+      delete m_branchPredictor;
+    }
+    // "width[:robEntries[:rsEntries[:lsqEntries]]]", e.g., "4:64:32:16"; the omitted sizes keep the values
+    // passed in; false if malformed
+    static bool parseWindow(const char *spec, unsigned *width, unsigned *robEntries, unsigned *rsEntries,
+                            unsigned *lsqEntries) {
+      unsigned *fields[4] = {width, robEntries, rsEntries, lsqEntries};
+      const char *p = spec;
+      for (int i = 0; i < 4; i++) {
+        char *end;
+        unsigned long value = strtoul(p, &end, 0);
+        if (end == p || value == 0) {
+          return false;
+        }
+        *fields[i] = (unsigned)value;
+        if (*end == '\0') {
+          return true;
+        }
+        if (*end != ':') {
+          return false;
+        }
+        p = end + 1;
+      }
+      return false;
+    }
+    unsigned getWidth() const { return m_width; }
+    // predict the branches in IF (see BranchPredictor.hpp); the predictor is trained at commit, so the
+    // global history of gshare misses the branches still in the window (bimodal and tournament hold up
+    // better). Without one, IF fetches past every branch and a taken branch squashes the younger ones.
+    void setBranchPredictor(BranchPredictor *predictor) {
+      delete m_branchPredictor;
+      m_branchPredictor = predictor;
+    }
+    const BranchPredictor *getBranchPredictor() const { return m_branchPredictor; }
+    // mult and multu take `cycles' cycles until their result goes out on the CDB (see
+    // PipelinedCPU::setMultiplier and MulDivUnit.hpp)
+    void setMultiplier(const unsigned cycles, const bool pipelined) { m_mulDivUnit.configure(false, cycles, pipelined); }
+    // the same for div and divu
+    void setDivider(const unsigned cycles, const bool pipelined) { m_mulDivUnit.configure(true, cycles, pipelined); }
+    const MulDivUnit &getMulDivUnit() const { return m_mulDivUnit; }
+
+    // the instruction windows
+    enum Window { WindowROB, WindowRS, WindowLSQ, NUM_WINDOWS };
+    static const char *windowName(const int window) {
+      static const char *names[NUM_WINDOWS] = {"rob", "rs", "lsq"};
+      return names[window];
+    }
+    unsigned windowEntries(const int window) const {
+      return (unsigned)((window == WindowROB) ? m_rob.size() : (window == WindowRS) ? m_rs.size() : m_lsq.size());
+    }
+    // the average number of occupied entries of `window' at the end of a cycle
+    double averageOccupancy(const int window) const {
+      return (getCurrCycle() > 0) ? (double)m_occupancy[window] / getCurrCycle() : 0.0;
+    }
+    // the cycles dispatch stopped because `window' was full
+    std::uint64_t getFullCycles(const int window) const { return m_fullCycles[window]; }
+    // the cycles `n' (0 to width) instructions issued from the RS
+    std::uint64_t getIssueCycles(const unsigned n) const { return m_issueHistogram[n]; }
+    // the instructions squashed after a wrong branch prediction
+    std::uint64_t getSquashed() const { return m_squashed; }
+    // the results that waited a cycle for a free CDB slot
+    std::uint64_t getCDBConflicts() const { return m_cdbConflicts; }
+    const FetchQueue &getFetchQueue() const { return m_fetchQueue; }
+  public:
+    /****************************************************************************/
+    /* OutOfOrderCPU::advanceCycle                                              */
+    /*   - Simulate a single clock cycle of the out-of-order CPU                */
+    /*   - The stages run from the back of the pipeline, so that each one sees  */
+    /*     what the later ones freed and broadcast in the same cycle            */
+    /****************************************************************************/
+    virtual void advanceCycle() {
+      CPU::advanceCycle();
+      Commit();
+      if (isHalted()) {
+        return; // exit committed; the younger instructions never leave the window
+      }
+      Complete();
+      LoadStoreQueue();
+      Issue();
+      Dispatch();
+      InstructionFetch();
+      m_occupancy[WindowROB] += m_robSize;
+      m_occupancy[WindowRS] += RSOccupancy();
+      m_occupancy[WindowLSQ] += m_lsqSize;
+      m_fetchQueue.sample();
+    }
+    void printPVS() {
+      HOST_PROFILE(PrintPVS);
+      CPU::printPVS();
+      printf("Reorder Buffer (%u of %u entries):\n", m_robSize, (unsigned)m_rob.size());
+      for (unsigned i = 0; i < m_robSize; i++) {
+        const ROBEntry &entry = m_rob[ROBIndex(i)];
+        printf("  [%2u] pc = 0x%08lx, instr = 0x%08lx, dest = %u, value = 0x%08lx, done = %d\n", ROBIndex(i),
+               entry.pc.to_ulong(), entry.instr.to_ulong(), entry.dest, entry.value.to_ulong(), entry.done ? 1 : 0);
+      }
+      printf("Reservation Stations:\n");
+      for (size_t i = 0; i < m_rs.size(); i++) {
+        const RSEntry &entry = m_rs[i];
+        if (entry.busy) {
+          printf("  [%2u] rob = %d, vj = 0x%08lx, qj = %d, vk = 0x%08lx, qk = %d\n", (unsigned)i, entry.rob,
+                 entry.vj.to_ulong(), entry.qj, entry.vk.to_ulong(), entry.qk);
+        }
+      }
+      printf("Load/Store Queue (%u of %u entries):\n", m_lsqSize, (unsigned)m_lsq.size());
+      for (unsigned i = 0; i < m_lsqSize; i++) {
+        const LSQEntry &entry = m_lsq[LSQIndex(i)];
+        printf("  %s rob = %d, address = 0x%08lx, known = %d, data = 0x%08lx\n", entry.store ? "sw" : "lw",
+               entry.rob, entry.address.to_ulong(), entry.addressKnown ? 1 : 0, entry.data.to_ulong());
+      }
+      fflush(stdout);
+    }
+  private:
+    // pipeline stages
+    void InstructionFetch();
+    void Dispatch();
+    void Issue();
+    void LoadStoreQueue();
+    void Complete();
+    void Commit();
+    // squashes every instruction younger than the one in ROB entry `rob' and restores the rename map
+    void SquashYounger(const int rob);
+
+    // HI and LO are renamed together, as register 32
+    static const unsigned HILO_REG = 32;
+    static const unsigned NUM_RENAMED_REGS = 33;
+    struct ROBEntry {
+      bool busy;                   // allocated
+      bool done;                   // executed; the result (or the store address and data) is ready
+      unsigned long long seq;      // dispatch order; tells the results of a reused entry apart
+      std::bitset<32> pc;
+      std::bitset<32> instr;
+      DecodedInstruction decoded;
+      unsigned dest;               // the register written at commit (0 = none, HILO_REG = HI and LO)
+      std::bitset<32> value;       // the result (LO for mult/div)
+      std::bitset<32> hiValue;     // HI for mult/div
+      std::bitset<32> predictedPC; // the PC IF fetched after it
+      std::bitset<32> nextPC;      // the resolved PC after it (PC+4 unless a taken branch)
+      std::bitset<32> branchTarget; // branches: (PC+4)+(Immed<<2)
+      bool taken;                  // branches: resolved taken
+    };
+    struct RSEntry {
+      bool busy;
+      int rob;                     // the ROB entry of the instruction
+      unsigned long long seq;
+      std::bitset<32> vj, vk;      // the operands (rs, rt; vj is HI or LO for mfhi/mflo)
+      int qj, qk;                  // the ROB entries producing them (-1 = the value is in vj, vk)
+      bool jFromHi;                // mfhi: vj takes HI off the CDB instead of LO
+    };
+    struct LSQEntry {
+      bool store;
+      int rob;
+      unsigned long long seq;
+      bool addressKnown;           // the address (and the data of a store) was computed
+      unsigned long long readyCycle; // the first cycle the address is visible to the other entries
+      bool performed;              // loads: the data memory (or an older store) was read
+      std::bitset<32> address;
+      std::bitset<32> data;        // stores: the data to write at commit
+    };
+    // a result on its way to the CDB (or, for a store or a branch, to the ROB)
+    struct InFlight {
+      int rob;
+      unsigned long long seq;
+      unsigned long long readyCycle; // the cycle it completes
+      bool broadcast;              // needs a CDB slot (the instruction writes a register)
+      std::bitset<32> value;
+      std::bitset<32> hiValue;
+    };
+
+    unsigned ROBIndex(const unsigned i) const { return (unsigned)((m_robHead + i) % m_rob.size()); }
+    unsigned LSQIndex(const unsigned i) const { return (unsigned)((m_lsqHead + i) % m_lsq.size()); }
+    unsigned RSOccupancy() const {
+      unsigned busy = 0;
+      for (size_t i = 0; i < m_rs.size(); i++) {
+        busy += m_rs[i].busy ? 1 : 0;
+      }
+      return busy;
+    }
+    // reads a source operand at dispatch: its value if committed or already computed, else its tag
+    void ReadOperand(const unsigned reg, const bool hi, std::bitset<32> *value, int *tag);
+
+    const unsigned m_width;
+    std::bitset<32> m_fetchPC;     // the next PC to fetch (m_PC is the last one fetched)
+    FetchQueue m_fetchQueue;
+    std::vector<ROBEntry> m_rob;
+    unsigned m_robHead;
+    unsigned m_robSize;
+    std::vector<RSEntry> m_rs;
+    std::vector<LSQEntry> m_lsq;
+    unsigned m_lsqHead;
+    unsigned m_lsqSize;
+    std::vector<InFlight> m_inFlight;
+    int m_renameTable[NUM_RENAMED_REGS]; // the ROB entry of the youngest writer, -1 if committed
+    bool m_serializing;            // a syscall is in the ROB; nothing dispatches after it
+    unsigned long long m_nextSeq;
+    BranchPredictor *m_branchPredictor; // <-- nullptr: predict not taken
+    MulDivUnit m_mulDivUnit;
+    // always-on statistics (see averageOccupancy, getFullCycles, getIssueCycles)
+    std::uint64_t m_occupancy[NUM_WINDOWS];
+    std::uint64_t m_fullCycles[NUM_WINDOWS];
+    std::vector<std::uint64_t> m_issueHistogram;
+    std::uint64_t m_squashed;
+    std::uint64_t m_cdbConflicts;
+};
+
+#endif
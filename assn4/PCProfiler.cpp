@@ -0,0 +1,71 @@
+#include "PCProfiler.hpp"
+
+#include "Assembler.hpp"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+static std::string disassembleAt(Memory *instMemory, const std::uint32_t pc) {
+  std::bitset<32> address(pc), instruction;
+  std::bitset<1> memRead(1), memWrite(0);
+  instMemory->access(&address, nullptr, &memRead, &memWrite, &instruction);
+  return Assembler::disassemble((std::uint32_t)instruction.to_ulong(), pc);
+}
+
+static bool byCountDescending(const std::pair<std::uint64_t, std::uint64_t> &a,
+                              const std::pair<std::uint64_t, std::uint64_t> &b) {
+  return (a.second != b.second) ? (a.second > b.second) : (a.first < b.first);
+}
+
+void PCProfiler::writePairs(FILE *file, const char *title, const PairMap &pairs, Memory *instMemory,
+                            const size_t maxEntries) {
+  if (pairs.empty()) {
+    return;
+  }
+  std::vector<std::pair<std::uint64_t, std::uint64_t> > sorted(pairs.begin(), pairs.end());
+  std::sort(sorted.begin(), sorted.end(), byCountDescending);
+  fprintf(file, "\n# %s\n", title);
+  for (size_t i = 0; i < sorted.size() && i < maxEntries; i++) {
+    std::uint32_t causePC = (std::uint32_t)(sorted[i].first >> 32);
+    std::uint32_t victimPC = (std::uint32_t)sorted[i].first;
+    fprintf(file, "%10llu  0x%08lx %-28s -> 0x%08lx %s\n", (unsigned long long)sorted[i].second,
+            (unsigned long)causePC, disassembleAt(instMemory, causePC).c_str(), (unsigned long)victimPC,
+            disassembleAt(instMemory, victimPC).c_str());
+  }
+}
+
+void PCProfiler::writeReport(FILE *file, Memory *instMemory, const unsigned long long cycles,
+                             const unsigned long long retired, const size_t maxEntries) const {
+  // hot spots: the PCs with the most stall cycles charged to them, either way
+  std::vector<std::pair<std::uint64_t, std::uint64_t> > sorted;
+  for (std::unordered_map<std::uint32_t, Entry>::const_iterator it = m_entries.begin(); it != m_entries.end(); ++it) {
+    sorted.push_back(std::make_pair((std::uint64_t)it->first,
+                                    it->second.totalSuffered() + it->second.totalCaused()));
+  }
+  std::sort(sorted.begin(), sorted.end(), byCountDescending);
+
+  fprintf(file, "# %llu cycles, %llu retired, %llu stall cycles charged, %llu forwards\n", cycles, retired,
+          (unsigned long long)m_stallCycles, (unsigned long long)m_forwards);
+  fprintf(file, "# suffered: cycles the instruction waited; caused: cycles others waited on it\n");
+  fprintf(file, "#                                                          suffered               caused\n");
+  fprintf(file, "#        PC instruction                   retired  ld-use sysc redir   ld-use sysc redir"
+          "  fwd-in fwd-out\n");
+  for (size_t i = 0; i < sorted.size() && i < maxEntries; i++) {
+    std::uint32_t pc = (std::uint32_t)sorted[i].first;
+    const Entry &entry = m_entries.find(pc)->second;
+    fprintf(file, "0x%08lx %-28s %9llu  %6llu %4llu %5llu   %6llu %4llu %5llu  %6llu %7llu\n", (unsigned long)pc,
+            disassembleAt(instMemory, pc).c_str(), (unsigned long long)entry.retired,
+            (unsigned long long)entry.suffered[LoadUse], (unsigned long long)entry.suffered[SyscallDrain],
+            (unsigned long long)entry.suffered[BranchRedirect], (unsigned long long)entry.caused[LoadUse],
+            (unsigned long long)entry.caused[SyscallDrain], (unsigned long long)entry.caused[BranchRedirect],
+            (unsigned long long)entry.forwardsIn, (unsigned long long)entry.forwardsOut);
+  }
+
+  writePairs(file, "load-use stalls (load -> consumer)", m_pairs[LoadUse], instMemory, maxEntries);
+  writePairs(file, "syscall drain stalls (syscall -> waiting instruction)", m_pairs[SyscallDrain], instMemory,
+             maxEntries);
+  writePairs(file, "branch redirects (branch -> target)", m_pairs[BranchRedirect], instMemory, maxEntries);
+  writePairs(file, "forwards (producer -> consumer)", m_forwardPairs, instMemory, maxEntries);
+}
@@ -0,0 +1,72 @@
+#ifndef __PC_PROFILER_HPP__
+#define __PC_PROFILER_HPP__
+
+#include "Memory.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <unordered_map>
+
+/******************************************************************************/
+/* PCProfiler                                                                 */
+/*   - Charges every stall cycle, bubble and forward of the pipeline to the  */
+/*     PC of the instruction that caused it and to the PC of the one that    */
+/*     suffered it                                                            */
+/*   - One hash-map update per event, so it can stay on for whole workloads  */
+/*   - writeReport prints the hot spots sorted by the cycles charged, with   */
+/*     the disassembled instructions                                          */
+/******************************************************************************/
+class PCProfiler {
+  public:
+    enum Stall {
+      LoadUse,        // the consumer of a load waited in ID
+      SyscallDrain,   // an instruction waited in ID for a syscall to retire
+      BranchRedirect, // the fetch of the branch target waited for the branch to resolve
+      NUM_STALLS
+    };
+    PCProfiler() : m_stallCycles(0), m_forwards(0) { }
+    void retired(const std::uint32_t pc) { m_entries[pc].retired++; }
+    void stall(const Stall kind, const std::uint32_t causePC, const std::uint32_t victimPC,
+               const unsigned cycles = 1) {
+      m_entries[causePC].caused[kind] += cycles;
+      m_entries[victimPC].suffered[kind] += cycles;
+      m_pairs[kind][pairKey(causePC, victimPC)] += cycles;
+      m_stallCycles += cycles;
+    }
+    void forward(const std::uint32_t producerPC, const std::uint32_t consumerPC) {
+      m_entries[producerPC].forwardsOut++;
+      m_entries[consumerPC].forwardsIn++;
+      m_forwardPairs[pairKey(producerPC, consumerPC)]++;
+      m_forwards++;
+    }
+    // the instructions are read back from `instMemory' to be disassembled
+    void writeReport(FILE *file, Memory *instMemory, const unsigned long long cycles,
+                     const unsigned long long retired, const size_t maxEntries = 20) const;
+  private:
+    struct Entry {
+      std::uint64_t retired;
+      std::uint64_t suffered[NUM_STALLS];
+      std::uint64_t caused[NUM_STALLS];
+      std::uint64_t forwardsIn;
+      std::uint64_t forwardsOut;
+      Entry() : retired(0), forwardsIn(0), forwardsOut(0) {
+        for (int i = 0; i < NUM_STALLS; i++) { suffered[i] = caused[i] = 0; }
+      }
+      std::uint64_t totalSuffered() const { return suffered[LoadUse] + suffered[SyscallDrain] + suffered[BranchRedirect]; }
+      std::uint64_t totalCaused() const { return caused[LoadUse] + caused[SyscallDrain] + caused[BranchRedirect]; }
+    };
+    typedef std::unordered_map<std::uint64_t, std::uint64_t> PairMap; // (cause << 32 | victim) -> count
+    static std::uint64_t pairKey(const std::uint32_t causePC, const std::uint32_t victimPC) {
+      return ((std::uint64_t)causePC << 32) | victimPC;
+    }
+    static void writePairs(FILE *file, const char *title, const PairMap &pairs, Memory *instMemory,
+                           const size_t maxEntries);
+
+    std::unordered_map<std::uint32_t, Entry> m_entries;
+    PairMap m_pairs[NUM_STALLS];
+    PairMap m_forwardPairs;
+    std::uint64_t m_stallCycles;
+    std::uint64_t m_forwards;
+};
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef __PERF_COUNTERS_HPP__
+#define __PERF_COUNTERS_HPP__
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+/*****************************************************************************/
+/* PERF_COUNT                                                                */
+/*   - Wraps every update of the performance counters; the updates are only  */
+/*     compiled in with -DENABLE_PERF_COUNTERS, so a default build pays     */
+/*     nothing for them                                                      */
+/*   - e.g., PERF_COUNT(m_perfCounters.memReads++);                          */
+/*****************************************************************************/
+#ifdef ENABLE_PERF_COUNTERS
+#define PERF_COUNT(statement) do { statement; } while (0)
+#else
+#define PERF_COUNT(statement) do { } while (0)
+#endif
+
+/******************************************************************************/
+/* PerfCounters                                                               */
+/*   - Microarchitectural event counts of a CPU (see CPU::getPerfCounters)   */
+/*   - The cycle and retired-instruction counts are kept by the CPU itself  */
+/*     and are always available; the others stay zero unless the simulator */
+/*     is built with -DENABLE_PERF_COUNTERS                                   */
+/******************************************************************************/
+struct PerfCounters {
+  enum Operand { OperandA, OperandB };
+  enum ForwardPath { FromMEMWB = 1, FromEXMEM = 2 }; // the select values of the forwarding Muxes
+  // the instruction mix is indexed by the opcode, or by 64 + funct for R-type instructions
+  static const unsigned NUM_MIX_ENTRIES = 128;
+
+  std::uint64_t cycles;
+  std::uint64_t retired;
+  std::uint64_t loadUseBubbles;     // bubbles inserted for a load-use hazard
+  std::uint64_t syscallBubbles;     // bubbles inserted while a syscall drains to WB
+  std::uint64_t branchBubbles;      // bubbles inserted while the operands of a branch in ID are computed
+  std::uint64_t mulDivBubbles;      // bubbles inserted while the multiplier/divider is busy or HI/LO is not ready
+  std::uint64_t bubblesAvoided;     // cycles matching rs and rt regardless of the instruction would have stalled
+  std::uint64_t forwards[2][3];     // [operand][path]; path 0 (no forwarding) is not counted
+  std::uint64_t branchForwards;     // operands forwarded from EX-MEM to a branch in ID
+  std::uint64_t storeDataForwards;  // store data forwarded from MEM-WB to a store in MEM
+  std::uint64_t valueForwards;      // predicted load values forwarded from EX-MEM in place of a load-use bubble
+  std::uint64_t valueReplays;       // younger instructions squashed after a wrong predicted load value
+  std::uint64_t branches;           // resolved conditional branches
+  std::uint64_t takenBranches;
+  std::uint64_t redirectPenalty;    // younger instructions fetched before a branch redirected the PC
+  std::uint64_t mispredictions;     // redirects of a branch predictor (0 without one)
+  std::uint64_t fetchStalls;        // cycles IF waited for the instruction memory
+  std::uint64_t memStalls;          // cycles the pipeline held while MEM waited for the data memory
+  std::uint64_t memReads;
+  std::uint64_t memWrites;
+  std::uint64_t mix[NUM_MIX_ENTRIES]; // decoded instructions
+
+  PerfCounters() { reset(); }
+  void reset() { memset(this, 0, sizeof(*this)); }
+  static bool enabled() {
+#ifdef ENABLE_PERF_COUNTERS
+    return true;
+#else
+    return false;
+#endif
+  }
+  void countInstruction(const std::uint32_t opcode, const std::uint32_t funct) {
+    mix[(opcode == 0x00) ? 64 + (funct & 0x3F) : (opcode & 0x3F)]++;
+  }
+  double cpi() const { return (retired > 0) ? (double)cycles / retired : 0.0; }
+  static const char *mixName(const unsigned index) {
+    switch (index) {
+      case 0x04: return "beq";
+      case 0x08: return "addi";
+      case 0x23: return "lw";
+      case 0x2B: return "sw";
+      case 64 + 0x0C: return "syscall";
+      case 64 + 0x10: return "mfhi";
+      case 64 + 0x12: return "mflo";
+      case 64 + 0x18: return "mult";
+      case 64 + 0x19: return "multu";
+      case 64 + 0x1A: return "div";
+      case 64 + 0x1B: return "divu";
+      case 64 + 0x20: return "add";
+      case 64 + 0x22: return "sub";
+      case 64 + 0x24: return "and";
+      case 64 + 0x25: return "or";
+      case 64 + 0x2A: return "slt";
+      default: return nullptr;
+    }
+  }
+  void writeJSON(FILE *file) const {
+    fprintf(file, "{\n");
+    fprintf(file, "  \"enabled\": %s,\n", enabled() ? "true" : "false");
+    fprintf(file, "  \"cycles\": %llu,\n", (unsigned long long)cycles);
+    fprintf(file, "  \"retired\": %llu,\n", (unsigned long long)retired);
+    fprintf(file, "  \"cpi\": %.4f,\n", cpi());
+    fprintf(file, "  \"loadUseBubbles\": %llu,\n", (unsigned long long)loadUseBubbles);
+    fprintf(file, "  \"syscallBubbles\": %llu,\n", (unsigned long long)syscallBubbles);
+    fprintf(file, "  \"branchBubbles\": %llu,\n", (unsigned long long)branchBubbles);
+    fprintf(file, "  \"mulDivBubbles\": %llu,\n", (unsigned long long)mulDivBubbles);
+    fprintf(file, "  \"bubblesAvoided\": %llu,\n", (unsigned long long)bubblesAvoided);
+    fprintf(file, "  \"forwards\": {\"A\": {\"EX/MEM\": %llu, \"MEM/WB\": %llu}, "
+            "\"B\": {\"EX/MEM\": %llu, \"MEM/WB\": %llu}},\n",
+            (unsigned long long)forwards[OperandA][FromEXMEM], (unsigned long long)forwards[OperandA][FromMEMWB],
+            (unsigned long long)forwards[OperandB][FromEXMEM], (unsigned long long)forwards[OperandB][FromMEMWB]);
+    fprintf(file, "  \"branchForwards\": %llu,\n", (unsigned long long)branchForwards);
+    fprintf(file, "  \"storeDataForwards\": %llu,\n", (unsigned long long)storeDataForwards);
+    fprintf(file, "  \"valueForwards\": %llu,\n", (unsigned long long)valueForwards);
+    fprintf(file, "  \"valueReplays\": %llu,\n", (unsigned long long)valueReplays);
+    fprintf(file, "  \"branches\": %llu,\n", (unsigned long long)branches);
+    fprintf(file, "  \"takenBranches\": %llu,\n", (unsigned long long)takenBranches);
+    fprintf(file, "  \"redirectPenalty\": %llu,\n", (unsigned long long)redirectPenalty);
+    fprintf(file, "  \"mispredictions\": %llu,\n", (unsigned long long)mispredictions);
+    fprintf(file, "  \"fetchStalls\": %llu,\n", (unsigned long long)fetchStalls);
+    fprintf(file, "  \"memStalls\": %llu,\n", (unsigned long long)memStalls);
+    fprintf(file, "  \"memReads\": %llu,\n", (unsigned long long)memReads);
+    fprintf(file, "  \"memWrites\": %llu,\n", (unsigned long long)memWrites);
+    fprintf(file, "  \"mix\": {");
+    bool first = true;
+    for (unsigned i = 0; i < NUM_MIX_ENTRIES; i++) {
+      if (mix[i] == 0) {
+        continue;
+      }
+      const char *name = mixName(i);
+      if (name != nullptr) {
+        fprintf(file, "%s\"%s\": %llu", first ? "" : ", ", name, (unsigned long long)mix[i]);
+      } else if (i < 64) {
+        fprintf(file, "%s\"opcode 0x%02x\": %llu", first ? "" : ", ", i, (unsigned long long)mix[i]);
+      } else {
+        fprintf(file, "%s\"funct 0x%02x\": %llu", first ? "" : ", ", i - 64, (unsigned long long)mix[i]);
+      }
+      first = false;
+    }
+    fprintf(file, "}\n}\n");
+  }
+};
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef __PIPELINE_TRACER_HPP__
+#define __PIPELINE_TRACER_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/******************************************************************************/
+/* PipelineTracer                                                             */
+/*   - Receives the pipeline events of PipelinedCPU: each instruction is      */
+/*     tagged with its fetch sequence number when it is fetched, and reported */
+/*     as it enters a stage, stalls, retires or is flushed                    */
+/*   - Implementations: KonataTracer (Konata viewer), ChromeTracer           */
+/*     (Chrome trace_event JSON for Perfetto / about://tracing)               */
+/******************************************************************************/
+class PipelineTracer {
+  public:
+    enum Stage { IF, ID, EX, MEM, WB, NUM_STAGES };
+    virtual ~PipelineTracer() { }
+    // the start of a simulated cycle
+    virtual void cycle(const unsigned long long cycle) = 0;
+    virtual void fetch(const unsigned long long seq, const std::uint32_t pc, const std::uint32_t instruction) = 0;
+    // called every cycle the instruction occupies the stage (so a stall repeats ID)
+    virtual void stage(const unsigned long long seq, const Stage stage) = 0;
+    // the instruction could not leave ID this cycle
+    virtual void stall(const unsigned long long seq, const char *reason) = 0;
+    virtual void memoryAccess(const bool write) { (void)write; }
+    virtual void retire(const unsigned long long seq) = 0;
+    virtual void flush(const unsigned long long seq) = 0;
+};
+
+/*********************************************************/
+/* TracerList                                            */
+/*   - Forwards every event to several tracers (owned)   */
+/*********************************************************/
+class TracerList : public PipelineTracer {
+  public:
+    virtual ~TracerList() {
+      for (size_t i = 0; i < m_tracers.size(); i++) { delete m_tracers[i]; }
+    }
+    void add(PipelineTracer *tracer) { m_tracers.push_back(tracer); }
+    virtual void cycle(const unsigned long long cycle) {
+      for (size_t i = 0; i < m_tracers.size(); i++) { m_tracers[i]->cycle(cycle); }
+    }
+    virtual void fetch(const unsigned long long seq, const std::uint32_t pc, const std::uint32_t instruction) {
+      for (size_t i = 0; i < m_tracers.size(); i++) { m_tracers[i]->fetch(seq, pc, instruction); }
+    }
+    virtual void stage(const unsigned long long seq, const Stage stage) {
+      for (size_t i = 0; i < m_tracers.size(); i++) { m_tracers[i]->stage(seq, stage); }
+    }
+    virtual void stall(const unsigned long long seq, const char *reason) {
+      for (size_t i = 0; i < m_tracers.size(); i++) { m_tracers[i]->stall(seq, reason); }
+    }
+    virtual void memoryAccess(const bool write) {
+      for (size_t i = 0; i < m_tracers.size(); i++) { m_tracers[i]->memoryAccess(write); }
+    }
+    virtual void retire(const unsigned long long seq) {
+      for (size_t i = 0; i < m_tracers.size(); i++) { m_tracers[i]->retire(seq); }
+    }
+    virtual void flush(const unsigned long long seq) {
+      for (size_t i = 0; i < m_tracers.size(); i++) { m_tracers[i]->flush(seq); }
+    }
+  private:
+    std::vector<PipelineTracer *> m_tracers;
+};
+
+#endif
@@ -2,16 +2,28 @@
 
 void PipelinedCPU::InstructionFetch()
 {
+  HOST_PROFILE(InstructionFetch);
   // 시작 PC : m_PC(initialPC),
   // Register file 객체 : m_registerFile(new RegisterFile(regFileName)),
   // Instruction Memory 객체 : m_instMemory(new Memory(Memory::LittleEndian, instMemFileName)),
   // Data Memory 객체 : m_dataMemory(new Memory(Memory::LittleEndian, dataMemFileName)),
 
+  if (m_fetchQueue != nullptr)
+  {
+    FetchIntoQueue();
+    return;
+  }
+
   // Update PC
   std::bitset<32> four(4);
   std::bitset<32> temp(0);         // PC 주소 임시 저장 변수
   std::bitset<32> nop_m_PC = m_PC; // PCWrite가 0일 때, 즉 PC값 업데이트를 하면 안될 때 사용할 변수
   Add<32>(&m_PC, &four, &temp);    // 이번 cycle에 읽을 PC = PC + 4 (전 clock의 pcPlus4 값)
+  // branch predictor(또는 loop buffer)가 있으면 직전에 fetch한 명령 다음으로 예측해 둔 PC를 읽는다.
+  if (FlushesWrongPath())
+  {
+    temp = m_IF_predictedPC;
+  }
   m_PC = temp;
   // PC 값 결정을 위한 MUX : PCSrc = 1 이면 PC+4+offset*4, 0이면 PC+4
   CPU::Mux<32>(&m_PC, &m_MEM_to_IF_branchTarget, &m_MEM_to_IF_PCSrc, &m_PC);
@@ -24,76 +36,408 @@ void PipelinedCPU::InstructionFetch()
   // Fetch instruction from memory
   std::bitset<1> memRead(1);
   std::bitset<1> memWrite(0);
+  // loop buffer가 이 PC의 loop를 담고 있으면 instruction memory 대신 loop buffer에서 (decode된 채로) 가져온다.
+  const LoopBuffer::Entry *buffered =
+      (m_loopBuffer != nullptr) ? m_loopBuffer->lookup((std::uint32_t)m_PC.to_ulong()) : nullptr;
   // Set IF/ID latch
   // load_use data hazard 방지를 위한 if
   // IF/IDWrite = 1 이면 IF/ID latch를 업데이트, 0이면 업데이트 안하고 nop(bubble) 실행
-  if (m_HazDetUnit_to_IF_IFIDWrite == 1)
+  if (m_HazDetUnit_to_IF_IFIDWrite == 1 && buffered == nullptr && !InstMemReady(m_PC))
   {
-    // PC+4 값이 아니라 현재 PC(clock 전반부에 이미 4 증가됨) 주소의 instruction 읽는다.
-    m_instMemory->access(&m_PC, nullptr, &memRead, &memWrite, &m_latch_IF_ID.instr);
+    // fetch block이 아직 instruction memory에서 오는 중: ID에는 bubble을 보내고, 다음 cycle에 같은 PC를 다시 fetch
+    m_latch_IF_ID.instr = 0x00000020;
+    m_latch_IF_ID.valid = 0;
+    m_latch_IF_ID.predecoded = 0;
+    m_IF_predictedPC = m_PC;
+    std::bitset<32> minusFour(0xFFFFFFFC);
+    Add<32>(&m_IF_predictedPC, &minusFour, &m_PC);
+    PERF_COUNT(m_perfCounters.fetchStalls++);
+    // ID가 redirect하면 기다리던 명령은 어차피 wrong path이므로 올바른 PC를 fetch하러 간다.
+    if (m_ID_to_IF_PCSrc == 1)
+    {
+      Add<32>(&m_ID_to_IF_branchTarget, &minusFour, &m_PC);
+      m_IF_predictedPC = m_ID_to_IF_branchTarget;
+    }
+  }
+  else if (m_HazDetUnit_to_IF_IFIDWrite == 1)
+  {
+    if (buffered != nullptr)
+    {
+      m_latch_IF_ID.instr = buffered->instr;
+      m_latch_IF_ID.decoded = buffered->decoded;
+      m_latch_IF_ID.predecoded = 1;
+      m_loopBuffer->countFetch();
+    }
+    else
+    {
+      // PC+4 값이 아니라 현재 PC(clock 전반부에 이미 4 증가됨) 주소의 instruction 읽는다.
+      m_instPort.access(&m_PC, nullptr, &memRead, &memWrite, &m_latch_IF_ID.instr);
+      m_latch_IF_ID.predecoded = 0;
+    }
     // Figure 4.51의 IF 부분의 adder 구현 (branch target을 계산할 때 쓸 pc+4 주소를 latch에 저장)
     Add<32>(&m_PC, &four, &m_latch_IF_ID.pcPlus4);
+    m_latch_IF_ID.valid = 1;
+    m_latch_IF_ID.seq = m_nextSeq++;
+    // 다음에 fetch할 PC 예측 (loop buffer는 loop를 닫는 branch를 taken으로, predictor는 BTB에 target이 있고
+    // taken으로 예측하면 target, 아니면 PC + 4)
+    if (FlushesWrongPath())
+    {
+      if (buffered != nullptr &&
+          (m_branchPredictor == nullptr || m_loopBuffer->isLoopBranch((std::uint32_t)m_PC.to_ulong())))
+      {
+        m_IF_predictedPC = m_loopBuffer->nextPC((std::uint32_t)m_PC.to_ulong());
+      }
+      else if (m_branchPredictor != nullptr)
+      {
+        m_IF_predictedPC = m_branchPredictor->predict((std::uint32_t)m_PC.to_ulong());
+      }
+      else
+      {
+        m_IF_predictedPC = m_latch_IF_ID.pcPlus4;
+      }
+      m_latch_IF_ID.predictedPC = m_IF_predictedPC;
+    }
+    if (m_tracer != nullptr)
+    {
+      m_tracer->fetch(m_latch_IF_ID.seq, (std::uint32_t)m_PC.to_ulong(), (std::uint32_t)m_latch_IF_ID.instr.to_ulong());
+    }
+    // early branch resolution: ID에서 branch가 이번 cycle에 fetch한 명령이 wrong path라고 알려오면 (IF.Flush)
+    // 그 명령은 bubble로 바꾸고, 다음 cycle에 올바른 PC를 fetch하도록 m_PC를 (올바른 PC - 4)로 둔다.
+    // delay slot이 있으면 이번에 fetch한 명령은 delay slot이므로 그대로 실행하고 다음 fetch만 redirect한다.
+    if (m_ID_to_IF_PCSrc == 1)
+    {
+      if (!m_delaySlot)
+      {
+        if (m_tracer != nullptr)
+        {
+          m_tracer->flush(m_latch_IF_ID.seq);
+        }
+        m_latch_IF_ID.instr = 0x00000020;
+        m_latch_IF_ID.valid = 0;
+        m_latch_IF_ID.predecoded = 0;
+      }
+      std::bitset<32> minusFour(0xFFFFFFFC);
+      Add<32>(&m_ID_to_IF_branchTarget, &minusFour, &m_PC);
+      m_IF_predictedPC = m_ID_to_IF_branchTarget;
+    }
   }
 }
 
+void PipelinedCPU::FetchIntoQueue()
+{
+  std::bitset<32> four(4);
+  std::bitset<1> memRead(1);
+  std::bitset<1> memWrite(0);
+  // 이번 cycle에 fetch할 PC: 예측해 둔 PC, MEM이 redirect하면 올바른 PC (queue는 FlushYounger가 이미 비웠다)
+  std::bitset<32> fetchPC;
+  CPU::Mux<32>(&m_IF_predictedPC, &m_MEM_to_IF_branchTarget, &m_MEM_to_IF_PCSrc, &fetchPC);
+  // queue에 자리가 있으면 fetch block에서 predicted path를 따라 block 끝, taken 예측, queue가 찰 때까지 fetch
+  // (ID의 stall과 상관없이 진행)
+  // loop buffer에서 가져오면 block 제한 없이 (loop의 branch도 넘어서) 한 cycle에 block 하나 만큼의 명령을 가져온다.
+  if (!m_fetchQueue->full())
+  {
+    const bool fromLoopBuffer =
+        (m_loopBuffer != nullptr && m_loopBuffer->lookup((std::uint32_t)fetchPC.to_ulong()) != nullptr);
+    if (fromLoopBuffer || InstMemReady(fetchPC))
+    {
+      bool more;
+      unsigned numFetched = 0;
+      do
+      {
+        FetchedInstruction fetched;
+        const LoopBuffer::Entry *buffered =
+            fromLoopBuffer ? m_loopBuffer->lookup((std::uint32_t)fetchPC.to_ulong()) : nullptr;
+        if (buffered != nullptr)
+        {
+          fetched.instr = buffered->instr;
+          fetched.decoded = buffered->decoded;
+          fetched.predecoded = 1;
+          m_loopBuffer->countFetch();
+        }
+        else
+        {
+          m_instPort.access(&fetchPC, nullptr, &memRead, &memWrite, &fetched.instr);
+          fetched.predecoded = 0;
+        }
+        Add<32>(&fetchPC, &four, &fetched.pcPlus4);
+        fetched.predictedPC = fetched.pcPlus4;
+        if (buffered != nullptr &&
+            (m_branchPredictor == nullptr || m_loopBuffer->isLoopBranch((std::uint32_t)fetchPC.to_ulong())))
+        {
+          fetched.predictedPC = m_loopBuffer->nextPC((std::uint32_t)fetchPC.to_ulong());
+        }
+        else if (m_branchPredictor != nullptr)
+        {
+          fetched.predictedPC = m_branchPredictor->predict((std::uint32_t)fetchPC.to_ulong());
+        }
+        fetched.seq = m_nextSeq++;
+        if (m_tracer != nullptr)
+        {
+          m_tracer->fetch(fetched.seq, (std::uint32_t)fetchPC.to_ulong(), (std::uint32_t)fetched.instr.to_ulong());
+        }
+        m_fetchQueue->push(fetched);
+        m_PC = fetchPC;
+        fetchPC = fetched.predictedPC;
+        numFetched++;
+        if (fromLoopBuffer)
+        {
+          more = numFetched < FETCH_BLOCK_BYTES / 4 && m_loopBuffer->lookup((std::uint32_t)fetchPC.to_ulong()) != nullptr;
+        }
+        else
+        {
+          more = (fetched.predictedPC == fetched.pcPlus4) && (fetchPC.to_ulong() & (FETCH_BLOCK_BYTES - 1)) != 0;
+        }
+      } while (!m_fetchQueue->full() && more);
+    }
+    else
+    {
+      PERF_COUNT(m_perfCounters.fetchStalls++);
+    }
+  }
+  m_IF_predictedPC = fetchPC;
+
+  // IF/IDWrite = 1 이면 queue의 맨 앞 명령을 IF/ID latch로 (queue가 비어 있으면 bubble)
+  if (m_HazDetUnit_to_IF_IFIDWrite == 1)
+  {
+    if (!m_fetchQueue->empty())
+    {
+      const FetchedInstruction &head = m_fetchQueue->front();
+      m_latch_IF_ID.pcPlus4 = head.pcPlus4;
+      m_latch_IF_ID.instr = head.instr;
+      m_latch_IF_ID.predictedPC = head.predictedPC;
+      m_latch_IF_ID.seq = head.seq;
+      m_latch_IF_ID.predecoded = head.predecoded;
+      m_latch_IF_ID.decoded = head.decoded;
+      m_latch_IF_ID.valid = 1;
+      m_fetchQueue->pop();
+    }
+    else
+    {
+      m_latch_IF_ID.instr = 0x00000020;
+      m_latch_IF_ID.valid = 0;
+      m_latch_IF_ID.predecoded = 0;
+    }
+  }
+  // early branch resolution의 IF.Flush: ID의 branch 뒤로 fetch된 명령(IF/ID로 들어간 명령과 queue 전체)은 wrong path
+  if (m_ID_to_IF_PCSrc == 1)
+  {
+    if (m_tracer != nullptr)
+    {
+      if (m_latch_IF_ID.valid == 1) { m_tracer->flush(m_latch_IF_ID.seq); }
+      for (unsigned i = 0; i < m_fetchQueue->size(); i++) { m_tracer->flush(m_fetchQueue->at(i).seq); }
+    }
+    m_latch_IF_ID.instr = 0x00000020;
+    m_latch_IF_ID.valid = 0;
+    m_latch_IF_ID.predecoded = 0;
+    m_fetchQueue->clear();
+    m_IF_predictedPC = m_ID_to_IF_branchTarget;
+  }
+  m_fetchQueue->sample();
+}
+
+bool PipelinedCPU::InstMemReady(const std::bitset<32> &pc)
+{
+  // fetch buffer에 없는 block이면 instruction memory에 요청 (읽고 있는 fetch block은 advanceCycle에서 한 cycle씩 진행)
+  return m_instPort.request((std::uint32_t)pc.to_ulong());
+}
+
 void PipelinedCPU::InstructionDecode()
 {
+  HOST_PROFILE(InstructionDecode);
   // 2. Decode - Parse the fetched instruction
-  std::bitset<6> opcode = m_latch_IF_ID.instr.to_ulong() >> 26;         // instruction code의 상위 6bit만 남게 left shift
-  std::bitset<5> rs = (m_latch_IF_ID.instr.to_ulong() >> 21) & 0b11111; // 0b11111 = and 연산통해 하위 5bit의 값만 가져옴
-  std::bitset<5> rt = (m_latch_IF_ID.instr.to_ulong() >> 16) & 0b11111;
-  std::bitset<5> rd = (m_latch_IF_ID.instr.to_ulong() >> 11) & 0b11111;
-  std::bitset<16> immediate = m_latch_IF_ID.instr.to_ulong() & 0xFFFF; // 하위 16bit만 가져옴
+  // loop buffer에서 온 명령은 이미 decode되어 있으므로 다시 decode하지 않는다.
+  DecodedInstruction decoded;
+  if (m_latch_IF_ID.predecoded == 1)
+  {
+    decoded = m_latch_IF_ID.decoded;
+  }
+  else
+  {
+    Decode(&m_latch_IF_ID.instr, &decoded);
+  }
+  const std::bitset<6> &opcode = decoded.opcode;
+  const std::bitset<5> &rs = decoded.rs;
+  const std::bitset<5> &rt = decoded.rt;
+  const std::bitset<5> &rd = decoded.rd;
+  // early branch resolution이면 beq(opcode 0x04)는 ID에서 비교하므로 operand hazard를 Hazard detection unit이 검사
+  std::bitset<1> earlyBranch = (m_earlyBranchResolution && opcode == 0x04);
   // Hazard detection unit 생성, PCWrite, IF/IDWrite, ctrlSelect signal 생성
   std::bitset<1> ctrlSelect = 0;
-  HazardDetectionUnit(&rs, &rt, &m_EX_to_HazDetUnit_memRead, &m_EX_to_HazDetUnit_rt,
+  if (m_tracer != nullptr && m_latch_IF_ID.valid == 1)
+  {
+    m_tracer->stage(m_latch_IF_ID.seq, PipelineTracer::ID);
+  }
+  HazardDetectionUnit(&m_latch_IF_ID.valid, &decoded, &m_EX_to_HazDetUnit, &m_MEM_to_HazDetUnit,
                       &m_HazDetUnit_to_IF_PCWrite, &m_HazDetUnit_to_IF_IFIDWrite, &ctrlSelect);
+  // bubble은 아무 register도 읽지 않는다.
+  std::bitset<1> readsRs = decoded.readsRs & m_latch_IF_ID.valid;
+  std::bitset<1> readsRt = decoded.readsRt & m_latch_IF_ID.valid;
+  PERF_COUNT(if (m_latch_IF_ID.valid == 1 && ctrlSelect == 0) {
+               m_perfCounters.countInstruction(opcode.to_ulong(), decoded.funct.to_ulong());
+             });
 
-  // Decode - Set control signals by opcode, and Set ID/EX latch
-  Control(&opcode, &m_latch_ID_EX.ctrlEXRegDst, &m_latch_ID_EX.ctrlMEMBranch, &m_latch_ID_EX.ctrlMEMMemRead,
-          &m_latch_ID_EX.ctrlWBMemToReg, &m_latch_ID_EX.ctrlEXALUOp, &m_latch_ID_EX.ctrlMEMMemWrite,
-          &m_latch_ID_EX.ctrlEXALUSrc, &m_latch_ID_EX.ctrlWBRegWrite);
+  // Set ID/EX latch
   // Hazard detection unit의 ctrlSelect = 1 이면 signal 전부 0으로, 0이면 만들어진 signal 그대로 보냄
   std::bitset<1> zero(0);
   std::bitset<2> zero_2bit(0);
-  CPU::Mux<1>(&m_latch_ID_EX.ctrlEXALUSrc, &zero, &ctrlSelect, &m_latch_ID_EX.ctrlEXALUSrc);
-  CPU::Mux<2>(&m_latch_ID_EX.ctrlEXALUOp, &zero_2bit, &ctrlSelect, &m_latch_ID_EX.ctrlEXALUOp);
-  CPU::Mux<1>(&m_latch_ID_EX.ctrlEXRegDst, &zero, &ctrlSelect, &m_latch_ID_EX.ctrlEXRegDst);
-  CPU::Mux<1>(&m_latch_ID_EX.ctrlMEMBranch, &zero, &ctrlSelect, &m_latch_ID_EX.ctrlMEMBranch);
-  CPU::Mux<1>(&m_latch_ID_EX.ctrlMEMMemRead, &zero, &ctrlSelect, &m_latch_ID_EX.ctrlMEMMemRead);
-  CPU::Mux<1>(&m_latch_ID_EX.ctrlMEMMemWrite, &zero, &ctrlSelect, &m_latch_ID_EX.ctrlMEMMemWrite);
-  CPU::Mux<1>(&m_latch_ID_EX.ctrlWBRegWrite, &zero, &ctrlSelect, &m_latch_ID_EX.ctrlWBRegWrite);
-  CPU::Mux<1>(&m_latch_ID_EX.ctrlWBMemToReg, &zero, &ctrlSelect, &m_latch_ID_EX.ctrlWBMemToReg);
+  CPU::Mux<1>(&decoded.aluSrc, &zero, &ctrlSelect, &m_latch_ID_EX.ctrlEXALUSrc);
+  CPU::Mux<2>(&decoded.aluOp, &zero_2bit, &ctrlSelect, &m_latch_ID_EX.ctrlEXALUOp);
+  CPU::Mux<1>(&decoded.regDst, &zero, &ctrlSelect, &m_latch_ID_EX.ctrlEXRegDst);
+  CPU::Mux<1>(&decoded.branch, &zero, &ctrlSelect, &m_latch_ID_EX.ctrlMEMBranch);
+  CPU::Mux<1>(&decoded.memRead, &zero, &ctrlSelect, &m_latch_ID_EX.ctrlMEMMemRead);
+  CPU::Mux<1>(&decoded.memWrite, &zero, &ctrlSelect, &m_latch_ID_EX.ctrlMEMMemWrite);
+  CPU::Mux<1>(&decoded.regWrite, &zero, &ctrlSelect, &m_latch_ID_EX.ctrlWBRegWrite);
+  CPU::Mux<1>(&decoded.memToReg, &zero, &ctrlSelect, &m_latch_ID_EX.ctrlWBMemToReg);
+  CPU::Mux<1>(&decoded.syscall, &zero, &ctrlSelect, &m_latch_ID_EX.ctrlWBSyscall);
+  CPU::Mux<1>(&decoded.mulDiv, &zero, &ctrlSelect, &m_latch_ID_EX.ctrlEXMulDiv);
+  CPU::Mux<1>(&decoded.readsHiLo, &zero, &ctrlSelect, &m_latch_ID_EX.ctrlEXReadHiLo);
+  CPU::Mux<1>(&readsRs, &zero, &ctrlSelect, &m_latch_ID_EX.readsRs);
+  CPU::Mux<1>(&readsRt, &zero, &ctrlSelect, &m_latch_ID_EX.readsRt);
+  // bubble을 넣는 경우 ID/EX latch는 명령이 아닌 bubble을 담고 있다고 표시 (retire 명령 수 집계용)
+  CPU::Mux<1>(&m_latch_IF_ID.valid, &zero, &ctrlSelect, &m_latch_ID_EX.valid);
 
   m_latch_ID_EX.pcPlus4 = m_latch_IF_ID.pcPlus4;
+  m_latch_ID_EX.predictedPC = m_latch_IF_ID.predictedPC;
+  m_latch_ID_EX.seq = m_latch_IF_ID.seq;
   // readData1, readData2에 현재 register에 저장된 값 저장, Writedata는 하지 않으므로 관련 port와 signal은 nullptr
   m_registerFile->access(&rs, &rt, nullptr, nullptr, nullptr, &m_latch_ID_EX.readData1, &m_latch_ID_EX.readData2);
-  SignExtend<16, 32>(&immediate, &m_latch_ID_EX.immediate);
+  m_latch_ID_EX.immediate = decoded.immediate;
   m_latch_ID_EX.instr_25_21 = rs; // IF/ID stage를 실행중인 명령(data forwarding을 받을 명령)의 rs값을 forwarding unit이 받아야 하므로 latch에 추가로 저장
   m_latch_ID_EX.instr_20_16 = rt; // rt값과 rd값중 뭐가 Writereg인지 결정하는 Mux가 EX stage에 있으므로 넘겨줘야함, 또한 rs와 같은 이유로 forwarding unit에 넘겨줘야함
   m_latch_ID_EX.instr_15_11 = rd; // WB 단계에서 rd(Write Register)에 WB 해줘야 하므로 latch에 저장해서 다음으로 넘김
+  // loop buffer가 담고 있는 loop의 명령이면 decode한 결과를 저장 (stall 중에 같은 명령을 다시 봐도 한 번만 저장됨)
+  if (m_loopBuffer != nullptr && m_latch_IF_ID.valid == 1)
+  {
+    if (m_latch_IF_ID.predecoded == 0)
+    {
+      m_loopBuffer->capture((std::uint32_t)m_latch_IF_ID.pcPlus4.to_ulong() - 4, m_latch_IF_ID.instr, decoded);
+    }
+    else if (ctrlSelect == 0)
+    {
+      m_loopBuffer->countDecode();
+    }
+  }
+
+  // early branch resolution: 비교기와 branch target adder를 ID에 두고 여기서 branch를 resolve한다.
+  m_ID_to_IF_PCSrc = 0;
+  if (earlyBranch == 1 && ctrlSelect == 0 && m_latch_IF_ID.valid == 1)
+  {
+    // EX/MEM의 ALU 결과를 ID로 forwarding (MEM/WB의 값은 이번 cycle의 WB가 이미 register file에 썼으므로 필요 없음)
+    // EX에 있는 명령의 결과나 MEM에 있는 load의 결과가 필요하면 Hazard detection unit이 이미 stall 시켰다.
+    std::bitset<32> rsValue = m_latch_ID_EX.readData1;
+    std::bitset<32> rtValue = m_latch_ID_EX.readData2;
+    if (m_enableDataForwarding && m_MEM_to_FwdUnit_regWrite == 1 && m_MEM_to_FwdUnit_rd != 0)
+    {
+      if (m_MEM_to_FwdUnit_rd == rs)
+      {
+        rsValue = m_MEM_to_FwdUnit_rdValue;
+        PERF_COUNT(m_perfCounters.branchForwards++);
+      }
+      if (m_MEM_to_FwdUnit_rd == rt)
+      {
+        rtValue = m_MEM_to_FwdUnit_rdValue;
+        PERF_COUNT(m_perfCounters.branchForwards++);
+      }
+    }
+    std::bitset<1> branchTaken = (rsValue == rtValue); // 비교기 (equality만 보면 되므로 ALU 대신)
+    std::bitset<32> shiftleft2Immediate;
+    std::bitset<32> branchTarget;
+    std::bitset<32> actualPC;
+    ShiftLeft2<32>(&m_latch_ID_EX.immediate, &shiftleft2Immediate);
+    Add<32>(&m_latch_IF_ID.pcPlus4, &shiftleft2Immediate, &branchTarget);
+    CPU::Mux<32>(&m_latch_IF_ID.pcPlus4, &branchTarget, &branchTaken, &actualPC);
+    // 이번 cycle에 IF가 fetch하는 PC: predictor가 있으면 예측한 PC, 없으면 PC + 4
+    // (delay slot이 있으면 이번에 fetch하는 명령은 delay slot이고, 그 다음에 fetch할 PC는 PC + 8)
+    std::bitset<32> fetchedPC = FlushesWrongPath() ? m_latch_IF_ID.predictedPC : m_latch_IF_ID.pcPlus4;
+    if (m_delaySlot)
+    {
+      std::bitset<32> four(4);
+      Add<32>(&m_latch_IF_ID.pcPlus4, &four, &fetchedPC);
+      CPU::Mux<32>(&fetchedPC, &branchTarget, &branchTaken, &actualPC);
+    }
+    m_ID_to_IF_PCSrc = (actualPC != fetchedPC);
+    m_ID_to_IF_branchTarget = actualPC;
+    std::uint32_t branchPC = (std::uint32_t)m_latch_IF_ID.pcPlus4.to_ulong() - 4;
+    if (m_branchPredictor != nullptr)
+    {
+      m_branchPredictor->resolve(branchPC, branchTaken == 1, (std::uint32_t)branchTarget.to_ulong(), m_ID_to_IF_PCSrc == 1);
+    }
+    if (m_branchTrace != nullptr)
+    {
+      m_branchTrace->record(branchPC, (std::uint32_t)branchTarget.to_ulong(), branchTaken == 1);
+    }
+    if (m_loopBuffer != nullptr && branchTaken == 1)
+    {
+      m_loopBuffer->branchTaken(branchPC, (std::uint32_t)branchTarget.to_ulong());
+    }
+    PERF_COUNT(m_perfCounters.branches++;
+               m_perfCounters.takenBranches += branchTaken.to_ulong();
+               m_perfCounters.redirectPenalty += m_delaySlot ? 0 : m_ID_to_IF_PCSrc.to_ulong();
+               m_perfCounters.mispredictions += (m_branchPredictor != nullptr) ? m_ID_to_IF_PCSrc.to_ulong() : 0);
+    if (m_profiler != nullptr && m_ID_to_IF_PCSrc == 1 && !m_delaySlot)
+    {
+      m_profiler->stall(PCProfiler::BranchRedirect, branchPC, (std::uint32_t)actualPC.to_ulong());
+    }
+    // branch는 ID에서 끝났으므로 MEM에서 다시 redirect하지 않도록 Branch signal을 지운다.
+    m_latch_ID_EX.ctrlMEMBranch = 0;
+  }
 }
 
 void PipelinedCPU::Execute()
 {
+  HOST_PROFILE(Execute);
+  if (m_tracer != nullptr && m_latch_ID_EX.valid == 1)
+  {
+    m_tracer->stage(m_latch_ID_EX.seq, PipelineTracer::EX);
+  }
   // 3. EX : Figure 4.51의 아랫 부분부터 구현
-  // ID stage에 있는 Hazard detection unit에 값을 전달하기 위해 연결된 포트에 ID/EX.MemRead 값과 ID/EX.rt 값 보냄
-  m_EX_to_HazDetUnit_memRead = m_latch_ID_EX.ctrlMEMMemRead;
-  m_EX_to_HazDetUnit_rt = m_latch_ID_EX.instr_20_16;
+  // ID stage에 있는 Hazard detection unit에 값을 전달하기 위해 연결된 포트에 ID/EX.MemRead 값 보냄 (rd는 RegDst MUX 뒤에서)
+  m_EX_to_HazDetUnit.memRead = m_latch_ID_EX.ctrlMEMMemRead;
+  m_EX_to_HazDetUnit.syscall = m_latch_ID_EX.ctrlWBSyscall;
+  m_EX_to_HazDetUnit.regWrite = m_latch_ID_EX.ctrlWBRegWrite;
   // 3-to-1 MUX를 위한 forwarding signal 생성, MUX에서 결정된 rs, rt 값 저장할 변수 생성
   std::bitset<2> forwardA;
   std::bitset<2> forwardB;
   std::bitset<32> forwarded_rsValue;
   std::bitset<32> forwarded_rtValue;
   // Data forwarding unit 생성, forwarding signal 생성
-  ForwardingUnit(&m_latch_ID_EX.instr_25_21, &m_latch_ID_EX.instr_20_16, &m_latch_EX_MEM.ctrlWBRegWrite,
-                 &m_latch_EX_MEM.rd, &m_latch_MEM_WB.ctrlWBRegWrite, &m_latch_MEM_WB.rd, &forwardA, &forwardB);
+  ForwardingUnit(&m_latch_ID_EX.instr_25_21, &m_latch_ID_EX.instr_20_16, &m_latch_ID_EX.readsRs,
+                 &m_latch_ID_EX.readsRt, &m_latch_EX_MEM.ctrlWBRegWrite, &m_latch_EX_MEM.rd,
+                 &m_latch_MEM_WB.ctrlWBRegWrite, &m_latch_MEM_WB.rd, &forwardA, &forwardB);
+  // 명령이 읽지 않는 operand(addi, lw의 rt 등)는 forwarding되지 않으며 forward 통계에도 세지 않는다.
+  PERF_COUNT(if (m_latch_ID_EX.readsRs == 1) { m_perfCounters.forwards[PerfCounters::OperandA][forwardA.to_ulong()]++; }
+             if (m_latch_ID_EX.readsRt == 1) { m_perfCounters.forwards[PerfCounters::OperandB][forwardB.to_ulong()]++; });
+  // forwarding의 producer: EX/MEM 경로는 이번 cycle에 MEM을 거친 명령 (이미 MEM/WB latch에 있음), MEM/WB 경로는 WB를 거친 명령
+  if (m_profiler != nullptr && m_latch_ID_EX.valid == 1)
+  {
+    std::uint32_t consumerPC = (std::uint32_t)m_latch_ID_EX.pcPlus4.to_ulong() - 4;
+    const std::bitset<2> *selects[2] = {&forwardA, &forwardB};
+    const std::bitset<1> *reads[2] = {&m_latch_ID_EX.readsRs, &m_latch_ID_EX.readsRt};
+    for (int i = 0; i < 2; i++)
+    {
+      if (*reads[i] == 0)
+      {
+        continue;
+      }
+      if (*selects[i] == 0b10)
+      {
+        m_profiler->forward((std::uint32_t)m_latch_MEM_WB.pcPlus4.to_ulong() - 4, consumerPC);
+      }
+      else if (*selects[i] == 0b01)
+      {
+        m_profiler->forward((std::uint32_t)m_WB_to_FwdUnit_pcPlus4.to_ulong() - 4, consumerPC);
+      }
+    }
+  }
   // ID/EX의 rs Data forwarding을 위한 3-to-1 MUX, forwardA signal 받음
-  Mux<32>(&m_latch_ID_EX.readData1, &m_WB_to_FwdUnit_rdValue, &m_MEM_to_FwdUnit_rdValue, &forwardA, &forwarded_rsValue);
+  CPU::Mux<32>(&m_latch_ID_EX.readData1, &m_WB_to_FwdUnit_rdValue, &m_MEM_to_FwdUnit_rdValue, &forwardA,
+               &forwarded_rsValue);
   // ID/EX의 rt Data forwarding을 위한 3-to-1 MUX, forwardB signal 받음
-  Mux<32>(&m_latch_ID_EX.readData2, &m_WB_to_FwdUnit_rdValue, &m_MEM_to_FwdUnit_rdValue, &forwardB, &forwarded_rtValue);
+  CPU::Mux<32>(&m_latch_ID_EX.readData2, &m_WB_to_FwdUnit_rdValue, &m_MEM_to_FwdUnit_rdValue, &forwardB,
+               &forwarded_rtValue);
   CPU::Mux<5>(&m_latch_ID_EX.instr_20_16, &m_latch_ID_EX.instr_15_11,
               &m_latch_ID_EX.ctrlEXRegDst, &m_latch_EX_MEM.rd); // EX stage의 맨 아래 MUX: regDst가 1이면 rd = rd, 0이면 rd = rt
+  m_EX_to_HazDetUnit.rd = m_latch_EX_MEM.rd; // load-use와 early branch resolution: ID의 명령이 이 결과를 기다려야 하는지 검사
   std::bitset<32> aluinput2;
   CPU::Mux<32>(&forwarded_rtValue, &m_latch_ID_EX.immediate,
                &m_latch_ID_EX.ctrlEXALUSrc, &aluinput2); // EX stage의 두번째 MUX: ALUSrc가 1이면 aluinput2 = immediate, 0이면 aluinput2 = forwardedrt
@@ -106,50 +450,207 @@ void PipelinedCPU::Execute()
   // ALU unit
   ALU(&forwarded_rsValue, &aluinput2, &aluControl,
       &m_latch_EX_MEM.aluResult, &m_latch_EX_MEM.aluZero); // ALU 연산 결과와 zero signal 생성
+  // multiplier/divider: mult, multu, div, divu는 여기서 issue하고 HI, LO에 결과를 쓴다. 결과가 나오기까지 걸리는
+  // cycle은 MulDivUnit이 세고, 그 전에 mfhi, mflo가 EX에 들어오지 않도록 Hazard detection unit이 ID에서 붙잡는다.
+  if (m_latch_ID_EX.ctrlEXMulDiv == 1)
+  {
+    MulDiv(&forwarded_rsValue, &forwarded_rtValue, &funct, &m_HI, &m_LO);
+    m_mulDivUnit.issue(MulDivUnit::isDivide(funct), getCurrCycle());
+  }
+  // mfhi, mflo: ALU 결과 대신 HI(funct 0x10)나 LO(funct 0x12)를 rd로 보낸다.
+  if (m_latch_ID_EX.ctrlEXReadHiLo == 1)
+  {
+    std::bitset<1> selectLO = funct.test(1);
+    CPU::Mux<32>(&m_HI, &m_LO, &selectLO, &m_latch_EX_MEM.aluResult);
+  }
   // ADD unit
   Add<32>(&m_latch_ID_EX.pcPlus4, &shiftleft2Immediate, &m_latch_EX_MEM.branchTarget); // branch 했을 때 변경될 branch target 주소 계산
   // Set remaining EX/MEM latch
+  m_latch_EX_MEM.pcPlus4 = m_latch_ID_EX.pcPlus4;
+  m_latch_EX_MEM.predictedPC = m_latch_ID_EX.predictedPC;
+  m_latch_EX_MEM.seq = m_latch_ID_EX.seq;
   m_latch_EX_MEM.readData2 = forwarded_rtValue; // 3-to-1 MUX에서 결정된 값이 이제 readData2 이므로 결정된 값을 EX/MEM latch로 넘겨준다.
   m_latch_EX_MEM.ctrlMEMBranch = m_latch_ID_EX.ctrlMEMBranch;
   m_latch_EX_MEM.ctrlMEMMemRead = m_latch_ID_EX.ctrlMEMMemRead;
   m_latch_EX_MEM.ctrlMEMMemWrite = m_latch_ID_EX.ctrlMEMMemWrite;
   m_latch_EX_MEM.ctrlWBRegWrite = m_latch_ID_EX.ctrlWBRegWrite;
   m_latch_EX_MEM.ctrlWBMemToReg = m_latch_ID_EX.ctrlWBMemToReg;
+  m_latch_EX_MEM.ctrlWBSyscall = m_latch_ID_EX.ctrlWBSyscall;
+  m_latch_EX_MEM.valid = m_latch_ID_EX.valid;
+  // load value prediction: 이 load가 읽을 값을 예측할 수 있으면 MEM에서 EX/MEM 경로로 그 값을 forwarding하므로
+  // 바로 뒤의 명령은 load-use bubble 없이 EX로 들어온다. (예측이 맞았는지는 MEM에서 실제로 읽은 값과 비교)
+  m_latch_EX_MEM.valuePredicted = 0;
+  if (m_loadValuePredictor != nullptr && m_enableDataForwarding && m_latch_ID_EX.valid == 1 &&
+      m_latch_ID_EX.ctrlMEMMemRead == 1)
+  {
+    std::uint32_t value;
+    if (m_loadValuePredictor->predict((std::uint32_t)m_latch_ID_EX.pcPlus4.to_ulong() - 4, &value))
+    {
+      m_latch_EX_MEM.valuePredicted = 1;
+      m_latch_EX_MEM.predictedValue = value;
+    }
+  }
+  m_EX_to_HazDetUnit.valuePredicted = m_latch_EX_MEM.valuePredicted;
 }
 
 void PipelinedCPU::MemoryAccess()
 {
+  HOST_PROFILE(MemoryAccess);
+  if (m_tracer != nullptr && m_latch_EX_MEM.valid == 1)
+  {
+    m_tracer->stage(m_latch_EX_MEM.seq, PipelineTracer::MEM);
+  }
   // 4. MemoryAccess
   // MEM 하기전 EX/MEM latch에 있는 regWrite, rd, rdValue를 forwarding unit에 넘겨준다.
   m_MEM_to_FwdUnit_regWrite = m_latch_EX_MEM.ctrlWBRegWrite; // 일단 두번째로 실행된 명령이 레지스터에 값을 쓰는 명령이어야 하고,
   // MEM/WB stage에 있는 두번쨰로 실행된 명령의 rd와 rd에 저장되어 있는 값을 조건이 만족하면 ID/EX stage를 실행중인 명령의 rs나 rt의 값으로 준다.
   m_MEM_to_FwdUnit_rd = m_latch_EX_MEM.rd;
   m_MEM_to_FwdUnit_rdValue = m_latch_EX_MEM.aluResult;
+  // 값을 예측한 load는 ALU 결과(주소) 대신 예측한 값을 forwarding
+  if (m_latch_EX_MEM.valuePredicted == 1)
+  {
+    m_MEM_to_FwdUnit_rdValue = m_latch_EX_MEM.predictedValue;
+  }
+  // syscall이 MEM에 있는 동안에도 뒤따르는 명령은 ID에서 대기해야 하므로 Hazard detection unit에 알림
+  m_MEM_to_HazDetUnit.syscall = m_latch_EX_MEM.ctrlWBSyscall;
+  // early branch resolution: load의 결과는 MEM이 끝나야 나옴
+  m_MEM_to_HazDetUnit.memRead = m_latch_EX_MEM.ctrlMEMMemRead;
+  m_MEM_to_HazDetUnit.regWrite = m_latch_EX_MEM.ctrlWBRegWrite;
+  m_MEM_to_HazDetUnit.rd = m_latch_EX_MEM.rd;
 
   // branch를 위한 and gate
   // PCSrc = 1이면 branch, 0이면 PC + 4
   // MEM 하기전 EX/MEM latch에 있는 PCSrc, branchTarget 값을 IF stage에 넘겨줘야 IF에서 MUX를 구현할 수 있다.
-  AND<1>(&m_latch_EX_MEM.ctrlMEMBranch, &m_latch_EX_MEM.aluZero, &m_MEM_to_IF_PCSrc); // PCSrc signal 생성
+  std::bitset<1> branchTaken;
+  AND<1>(&m_latch_EX_MEM.ctrlMEMBranch, &m_latch_EX_MEM.aluZero, &branchTaken); // PCSrc signal 생성
+  m_MEM_to_IF_PCSrc = branchTaken;
   m_MEM_to_IF_branchTarget = m_latch_EX_MEM.branchTarget;
+  // branch predictor가 있으면 실제 다음 PC(taken이면 branch target, 아니면 PC + 4)와 IF가 예측해서 fetch한 PC를 비교,
+  // 다르면(misprediction) IF를 실제 다음 PC로 redirect하고 뒤따르는 명령(IF/ID, ID/EX)을 flush
+  // (early branch resolution이면 branch는 이미 ID에서 resolve됨)
+  // fetch queue나 loop buffer가 있으면 predictor가 없어도 IF가 예측한 path를 따라 fetch하므로 같은 방식으로 flush
+  if (FlushesWrongPath() && !m_earlyBranchResolution)
+  {
+    std::bitset<32> actualPC;
+    CPU::Mux<32>(&m_latch_EX_MEM.pcPlus4, &m_latch_EX_MEM.branchTarget, &branchTaken, &actualPC);
+    m_MEM_to_IF_PCSrc = (m_latch_EX_MEM.valid == 1 && actualPC != m_latch_EX_MEM.predictedPC);
+    m_MEM_to_IF_branchTarget = actualPC;
+    if (m_branchPredictor != nullptr && m_latch_EX_MEM.valid == 1 && m_latch_EX_MEM.ctrlMEMBranch == 1)
+    {
+      m_branchPredictor->resolve((std::uint32_t)m_latch_EX_MEM.pcPlus4.to_ulong() - 4, branchTaken == 1,
+                                 (std::uint32_t)m_latch_EX_MEM.branchTarget.to_ulong(), m_MEM_to_IF_PCSrc == 1);
+    }
+  }
+  if (m_branchTrace != nullptr && m_latch_EX_MEM.valid == 1 && m_latch_EX_MEM.ctrlMEMBranch == 1)
+  {
+    m_branchTrace->record((std::uint32_t)m_latch_EX_MEM.pcPlus4.to_ulong() - 4,
+                          (std::uint32_t)m_latch_EX_MEM.branchTarget.to_ulong(), branchTaken == 1);
+  }
+  // taken된 backward branch가 짧은 loop를 닫으면 loop buffer가 그 loop를 담기 시작
+  if (m_loopBuffer != nullptr && m_latch_EX_MEM.valid == 1 && branchTaken == 1)
+  {
+    m_loopBuffer->branchTaken((std::uint32_t)m_latch_EX_MEM.pcPlus4.to_ulong() - 4,
+                              (std::uint32_t)m_latch_EX_MEM.branchTarget.to_ulong());
+  }
+  // redirect의 penalty: IF/ID, ID/EX에 이미 들어와 있는 뒤따르는 명령 수 (이번 cycle의 IF는 redirect된 PC를 fetch)
+  PERF_COUNT(if (m_latch_EX_MEM.valid == 1 && m_latch_EX_MEM.ctrlMEMBranch == 1) {
+               m_perfCounters.branches++;
+               m_perfCounters.takenBranches += branchTaken.to_ulong();
+             }
+             if (m_latch_EX_MEM.valid == 1 && m_MEM_to_IF_PCSrc == 1) {
+               m_perfCounters.redirectPenalty += m_latch_ID_EX.valid.to_ulong() + m_latch_IF_ID.valid.to_ulong() +
+                                                 ((m_fetchQueue != nullptr) ? m_fetchQueue->size() : 0);
+               m_perfCounters.mispredictions += (m_branchPredictor != nullptr) ? 1 : 0;
+             });
+  if (m_profiler != nullptr && m_latch_EX_MEM.valid == 1 && m_MEM_to_IF_PCSrc == 1)
+  {
+    unsigned penalty = m_latch_ID_EX.valid.to_ulong() + m_latch_IF_ID.valid.to_ulong() +
+                       ((m_fetchQueue != nullptr) ? m_fetchQueue->size() : 0);
+    if (penalty > 0)
+    {
+      m_profiler->stall(PCProfiler::BranchRedirect, (std::uint32_t)m_latch_EX_MEM.pcPlus4.to_ulong() - 4,
+                        (std::uint32_t)m_MEM_to_IF_branchTarget.to_ulong(), penalty);
+    }
+  }
+  if (FlushesWrongPath() && m_MEM_to_IF_PCSrc == 1)
+  {
+    FlushYounger();
+  }
   // 즉 같은 clock의 MEM stage에서 MUX를 통해 PC를 결정하고 IF에 있는 PC로 보낸다.
   // 이미 branchtarget = PC + 4 + offset*4인데, 그 값을 그대로 m_PC에 넘겨주면
   // IF stage 전반에서 +4가 또 이루어지므로, branchtarget에 -4를 해줘야 제대로 분기가 작동한다.
   // 과제 4에선 m_MEM_to_IF_PCSrc와 branchTarget 포트가 생겼으므로 Mux의 위치를 if로 옮길 수 있다.
 
+  // store-data forwarding: store의 rt(EX/MEM의 rd)를 이번 cycle에 WB를 거친 명령이 썼으면 그 값을 저장한다.
+  // (바로 앞의 lw면 EX에서 forwarding된 값은 lw의 주소이므로 여기서 바로잡는다. WB의 명령은 store 바로 앞의 명령이므로
+  // 이 값이 항상 최신이다.)
+  std::bitset<32> storeData = m_latch_EX_MEM.readData2;
+  if (m_storeDataForwarding && m_enableDataForwarding && m_latch_EX_MEM.ctrlMEMMemWrite == 1 &&
+      m_WB_to_FwdUnit_regWrite == 1 && m_WB_to_FwdUnit_rd != 0 && m_WB_to_FwdUnit_rd == m_latch_EX_MEM.rd)
+  {
+    storeData = m_WB_to_FwdUnit_rdValue;
+    PERF_COUNT(m_perfCounters.storeDataForwards++);
+  }
   // Data memory access
   // memRead, memWrite의 상태에 따라 read할지, write할지, 접근 안할건지 결정
   // (regWrite 신호에 따라 WriteRegister에 writeData를 write할지 결정)
-  m_dataMemory->access(&m_latch_EX_MEM.aluResult, &m_latch_EX_MEM.readData2, &m_latch_EX_MEM.ctrlMEMMemRead,
+  // data memory가 느리면 이 access의 요청은 advanceCycle이 pipeline을 멈춰 두고 미리 끝내 둔 상태
+  m_dataPort.access(&m_latch_EX_MEM.aluResult, &storeData, &m_latch_EX_MEM.ctrlMEMMemRead,
                        &m_latch_EX_MEM.ctrlMEMMemWrite, &m_latch_MEM_WB.readData);
+  PERF_COUNT(m_perfCounters.memReads += m_latch_EX_MEM.ctrlMEMMemRead.to_ulong());
+  PERF_COUNT(m_perfCounters.memWrites += m_latch_EX_MEM.ctrlMEMMemWrite.to_ulong());
+  // load value prediction: 예측한 값을 실제로 읽은 값과 비교. 이번 cycle에 EX에서 실행할 명령(ID/EX latch)이
+  // 틀린 값을 받게 되면 load 다음 명령부터 squash하고 IF가 load 다음 PC부터 다시 fetch (replay)
+  // (sw의 rt는 store-data forwarding이 있으면 EX에서 쓰지 않으므로 받은 것이 아니다.)
+  if (m_loadValuePredictor != nullptr && m_latch_EX_MEM.valid == 1 && m_latch_EX_MEM.ctrlMEMMemRead == 1)
+  {
+    if (m_latch_EX_MEM.valuePredicted == 1)
+    {
+      bool correct = (m_latch_MEM_WB.readData == m_latch_EX_MEM.predictedValue);
+      bool rtUsedInEX = m_latch_ID_EX.readsRt == 1 &&
+                        !(m_storeDataForwarding && m_latch_ID_EX.ctrlMEMMemWrite == 1);
+      bool used = m_latch_ID_EX.valid == 1 && m_latch_EX_MEM.rd != 0 &&
+                  ((m_latch_ID_EX.readsRs == 1 && m_latch_ID_EX.instr_25_21 == m_latch_EX_MEM.rd) ||
+                   (rtUsedInEX && m_latch_ID_EX.instr_20_16 == m_latch_EX_MEM.rd));
+      m_loadValuePredictor->verified(correct, used);
+      PERF_COUNT(m_perfCounters.valueForwards += used ? 1 : 0);
+      if (used && !correct)
+      {
+        PERF_COUNT(m_perfCounters.valueReplays += m_latch_ID_EX.valid.to_ulong() + m_latch_IF_ID.valid.to_ulong() +
+                                                  ((m_fetchQueue != nullptr) ? m_fetchQueue->size() : 0));
+        m_MEM_to_IF_PCSrc = 1;
+        m_MEM_to_IF_branchTarget = m_latch_EX_MEM.pcPlus4;
+        FlushYounger();
+      }
+    }
+    m_loadValuePredictor->train((std::uint32_t)m_latch_EX_MEM.pcPlus4.to_ulong() - 4,
+                                (std::uint32_t)m_latch_MEM_WB.readData.to_ulong());
+  }
+  if (m_latch_EX_MEM.valid == 1 && (m_latch_EX_MEM.ctrlMEMMemRead == 1 || m_latch_EX_MEM.ctrlMEMMemWrite == 1))
+  {
+    if (m_tracer != nullptr)
+    {
+      m_tracer->memoryAccess(m_latch_EX_MEM.ctrlMEMMemWrite == 1);
+    }
+    if (m_intervalStats != nullptr)
+    {
+      m_intervalStats->touch((std::uint32_t)m_latch_EX_MEM.aluResult.to_ulong());
+    }
+  }
   // Set remaining MEM/WB latch
+  m_latch_MEM_WB.pcPlus4 = m_latch_EX_MEM.pcPlus4;
+  m_latch_MEM_WB.seq = m_latch_EX_MEM.seq;
   m_latch_MEM_WB.aluResult = m_latch_EX_MEM.aluResult;
   m_latch_MEM_WB.rd = m_latch_EX_MEM.rd;
   m_latch_MEM_WB.ctrlWBRegWrite = m_latch_EX_MEM.ctrlWBRegWrite;
   m_latch_MEM_WB.ctrlWBMemToReg = m_latch_EX_MEM.ctrlWBMemToReg;
+  m_latch_MEM_WB.ctrlWBSyscall = m_latch_EX_MEM.ctrlWBSyscall;
+  m_latch_MEM_WB.valid = m_latch_EX_MEM.valid;
 }
 
 void PipelinedCPU::WriteBack()
 {
+  HOST_PROFILE(WriteBack);
   // 5. WriteBack
   // WB 하기전 MEM/WB latch에 있는 regWrite, rd, rdValue를 forwarding unit에 넘겨준다.
   // WB stage에서 미리 하지 않으면 다음에 실행될 MEM stage가 MEM/WB latch 값을 덮어쓰게 되어 이전 Data가 사라지기 때문이다.
@@ -166,55 +667,136 @@ void PipelinedCPU::WriteBack()
   // rdValue는 reg에 WB할 값을 forwarding으로 EX에 바로 넘겨주기 위한 포트
   m_WB_to_FwdUnit_rd = m_latch_MEM_WB.rd;
   m_WB_to_FwdUnit_rdValue = writeBackData;
+  m_WB_to_FwdUnit_pcPlus4 = m_latch_MEM_WB.pcPlus4;
   // regWrite 신호에 따라 register에 write back할지 결정
   m_registerFile->access(nullptr, nullptr, &m_latch_MEM_WB.rd, &writeBackData,
                          &m_latch_MEM_WB.ctrlWBRegWrite, nullptr, nullptr);
+  // WB를 마친 명령은 retire (bubble은 세지 않음)
+  if (m_latch_MEM_WB.valid == 1)
+  {
+    m_numRetired++;
+    if (m_profiler != nullptr)
+    {
+      m_profiler->retired((std::uint32_t)m_latch_MEM_WB.pcPlus4.to_ulong() - 4);
+    }
+    if (m_tracer != nullptr)
+    {
+      m_tracer->stage(m_latch_MEM_WB.seq, PipelineTracer::WB);
+      m_tracer->retire(m_latch_MEM_WB.seq);
+    }
+  }
+  // syscall은 retire 시점(WB)에 처리: 이보다 먼저 실행된 명령은 모두 register file에 반영된 상태
+  if (m_latch_MEM_WB.ctrlWBSyscall == 1)
+  {
+    m_syscallUnit->execute();
+  }
+}
+
+void PipelinedCPU::FlushYounger()
+{
+  if (m_tracer != nullptr)
+  {
+    if (m_latch_ID_EX.valid == 1) { m_tracer->flush(m_latch_ID_EX.seq); }
+    if (m_latch_IF_ID.valid == 1) { m_tracer->flush(m_latch_IF_ID.seq); }
+    for (unsigned i = 0; m_fetchQueue != nullptr && i < m_fetchQueue->size(); i++)
+    {
+      m_tracer->flush(m_fetchQueue->at(i).seq);
+    }
+  }
+  if (m_fetchQueue != nullptr)
+  {
+    m_fetchQueue->clear();
+  }
+  // ID/EX는 control signal을 모두 0으로 (HDU가 넣는 bubble과 같음)
+  m_latch_ID_EX.ctrlEXALUSrc.reset();
+  m_latch_ID_EX.ctrlEXALUOp.reset();
+  m_latch_ID_EX.ctrlEXRegDst.reset();
+  m_latch_ID_EX.ctrlMEMBranch.reset();
+  m_latch_ID_EX.ctrlMEMMemRead.reset();
+  m_latch_ID_EX.ctrlMEMMemWrite.reset();
+  m_latch_ID_EX.ctrlWBRegWrite.reset();
+  m_latch_ID_EX.ctrlWBMemToReg.reset();
+  m_latch_ID_EX.ctrlWBSyscall.reset();
+  m_latch_ID_EX.ctrlEXMulDiv.reset();
+  m_latch_ID_EX.ctrlEXReadHiLo.reset();
+  m_latch_ID_EX.readsRs.reset();
+  m_latch_ID_EX.readsRt.reset();
+  m_latch_ID_EX.valid = 0;
+  // IF/ID는 nop(add $0, $0, $0)으로 바꿔서 ID가 decode해도 아무 영향이 없게 한다.
+  m_latch_IF_ID.instr = 0x00000020;
+  m_latch_IF_ID.valid = 0;
+  m_latch_IF_ID.predecoded = 0;
 }
 
 void PipelinedCPU::ForwardingUnit(
     const std::bitset<5> *ID_EX_rs, const std::bitset<5> *ID_EX_rt,
+    const std::bitset<1> *ID_EX_readsRs, const std::bitset<1> *ID_EX_readsRt,
     const std::bitset<1> *EX_MEM_regWrite, const std::bitset<5> *EX_MEM_rd,
     const std::bitset<1> *MEM_WB_regWrite, const std::bitset<5> *MEM_WB_rd,
     std::bitset<2> *forwardA, std::bitset<2> *forwardB)
 {
-  // Forward A
-  if ((m_WB_to_FwdUnit_regWrite == 1 && m_WB_to_FwdUnit_rd != 0) // MEM/WB의 rd를 ID/EX의 rs로 forwarding하는 경우
-      && !(m_MEM_to_FwdUnit_regWrite == 1 && m_MEM_to_FwdUnit_rd != 0 && m_MEM_to_FwdUnit_rd == *ID_EX_rs) && m_WB_to_FwdUnit_rd == *ID_EX_rs)
+  // data forwarding이 꺼져 있거나 명령이 읽지 않는 operand(addi, lw의 rt 등)면 ID/EX의 rs, rt 값을 그대로 사용
+  *forwardA = 0b00;
+  *forwardB = 0b00;
+  if (!m_enableDataForwarding)
   {
-    *forwardA = 0b01;
-  }
-  else if (m_MEM_to_FwdUnit_regWrite == 1 && m_MEM_to_FwdUnit_rd != 0 && m_MEM_to_FwdUnit_rd == *ID_EX_rs)
-  { // EX/MEM의 rd를 ID/EX의 rs로 forwarding하는 경우
-    *forwardA = 0b10;
-  }
-  else
-  { // ID/EX의 rs 값를 그대로 쓰는 경우(forwarding 안하는 경우)
-    *forwardA = 0b00;
+    return;
   }
 
-  // Forward B
-  if ((m_WB_to_FwdUnit_regWrite == 1 && m_WB_to_FwdUnit_rd != 0) // MEM/WB의 rd를 ID/EX의 rt로 forwarding하는 경우
-      && !(m_MEM_to_FwdUnit_regWrite == 1 && m_MEM_to_FwdUnit_rd != 0 && m_MEM_to_FwdUnit_rd == *ID_EX_rt) && m_WB_to_FwdUnit_rd == *ID_EX_rt)
+  // EX/MEM과 MEM/WB 중 그 register를 쓰는 가장 최근 명령의 결과 (CPU::ForwardSelect: 오래된 것부터 1, 2)
+  const std::bitset<1> *regWrite[2] = {&m_WB_to_FwdUnit_regWrite, &m_MEM_to_FwdUnit_regWrite};
+  const std::bitset<5> *rd[2] = {&m_WB_to_FwdUnit_rd, &m_MEM_to_FwdUnit_rd};
+  if (*ID_EX_readsRs == 1)
   {
-    *forwardB = 0b01;
-  }
-  else if (m_MEM_to_FwdUnit_regWrite == 1 && m_MEM_to_FwdUnit_rd != 0 && m_MEM_to_FwdUnit_rd == *ID_EX_rt)
-  { // EX/MEM의 rd를 ID/EX의 rt로 forwarding하는 경우
-    *forwardB = 0b10;
+    ForwardSelect<2>(ID_EX_rs, regWrite, rd, 2, forwardA);
   }
-  else
-  { // ID/EX의 rt 값를 그대로 쓰는 경우(forwarding 안하는 경우)
-    *forwardB = 0b00;
+  if (*ID_EX_readsRt == 1)
+  {
+    ForwardSelect<2>(ID_EX_rt, regWrite, rd, 2, forwardB);
   }
 }
 
 void PipelinedCPU::HazardDetectionUnit(
-    const std::bitset<5> *IF_ID_rs, const std::bitset<5> *IF_ID_rt,
-    const std::bitset<1> *ID_EX_memRead, const std::bitset<5> *ID_EX_rt,
+    const std::bitset<1> *IF_ID_valid, const DecodedInstruction *IF_ID,
+    const HazardView *ID_EX, const HazardView *EX_MEM,
     std::bitset<1> *PCWrite, std::bitset<1> *IFIDWrite, std::bitset<1> *ctrlSelect)
 {
-  if (*ID_EX_memRead == 1 && (*ID_EX_rt == *IF_ID_rs || *ID_EX_rt == *IF_ID_rt))
+  std::bitset<1> mulDivBusy;
+  bool loadUse = LoadUseStall(IF_ID_valid, IF_ID, ID_EX);
+  bool syscallInFlight = SyscallDrainStall(IF_ID_valid, ID_EX, EX_MEM);
+  bool mulDivWait = MulDivStall(IF_ID_valid, IF_ID, &mulDivBusy);
+  bool branchOperands = BranchOperandStall(IF_ID, ID_EX, EX_MEM);
+  // rs, rt를 명령과 상관없이 비교했다면 넣었을 bubble
+  PERF_COUNT(if (!(loadUse || syscallInFlight || mulDivWait || branchOperands) &&
+                 ((m_enableHazardDetection && ID_EX->memRead == 1 && ID_EX->valuePredicted == 0 &&
+                   (ID_EX->rd == IF_ID->rs || ID_EX->rd == IF_ID->rt)) ||
+                  ID_EX->syscall == 1 || EX_MEM->syscall == 1)) {
+               m_perfCounters.bubblesAvoided++;
+             });
+  if (loadUse || syscallInFlight || mulDivWait || branchOperands)
   {
+    PERF_COUNT(if (loadUse) { m_perfCounters.loadUseBubbles++; }
+               else if (syscallInFlight) { m_perfCounters.syscallBubbles++; }
+               else if (mulDivWait) { m_perfCounters.mulDivBubbles++; }
+               else { m_perfCounters.branchBubbles++; });
+    if (!loadUse && !syscallInFlight && mulDivWait)
+    {
+      m_mulDivUnit.countStall(mulDivBusy == 1);
+    }
+    // 원인 명령: load나 syscall이 EX에 있으면 ID/EX latch, syscall이 MEM에 있으면 (MEM이 이미 채운) MEM/WB latch
+    // (branch operand stall은 profiler의 분류에 없으므로 세지 않음)
+    if (m_profiler != nullptr && m_latch_IF_ID.valid == 1 && (loadUse || syscallInFlight))
+    {
+      std::uint32_t victimPC = (std::uint32_t)m_latch_IF_ID.pcPlus4.to_ulong() - 4;
+      std::uint32_t causePC = (loadUse || ID_EX->syscall == 1) ? (std::uint32_t)m_latch_ID_EX.pcPlus4.to_ulong() - 4
+                                                               : (std::uint32_t)m_latch_MEM_WB.pcPlus4.to_ulong() - 4;
+      m_profiler->stall(loadUse ? PCProfiler::LoadUse : PCProfiler::SyscallDrain, causePC, victimPC);
+    }
+    if (m_tracer != nullptr && m_latch_IF_ID.valid == 1)
+    {
+      m_tracer->stall(m_latch_IF_ID.seq, loadUse ? "load-use" : syscallInFlight ? "syscall drain"
+                                       : mulDivWait ? "mul/div" : "branch operands");
+    }
     *PCWrite = 0;
     *IFIDWrite = 0;
     *ctrlSelect = 1;
@@ -226,3 +808,52 @@ void PipelinedCPU::HazardDetectionUnit(
     *ctrlSelect = 0;
   }
 }
+
+bool PipelinedCPU::LoadUseStall(const std::bitset<1> *IF_ID_valid, const DecodedInstruction *IF_ID,
+                                const HazardView *ID_EX)
+{
+  // load-use hazard 검사는 hazard detection이 켜져 있을 때만 한다.
+  // ID의 명령이 실제로 읽는 register만 비교: $zero에 load하는 경우, bubble은 붙잡을 필요가 없다.
+  std::bitset<1> readsRs = IF_ID->readsRs & *IF_ID_valid;
+  std::bitset<1> readsRt = IF_ID->readsRt & *IF_ID_valid;
+  // store-data forwarding: sw의 rt(store data)는 MEM에서 MEM/WB의 load 결과를 받을 수 있으므로 EX에서 필요한 값이 아니다.
+  if (m_storeDataForwarding && m_enableDataForwarding && IF_ID->memWrite == 1)
+  {
+    readsRt = 0;
+  }
+  std::bitset<1> hazard;
+  LoadUseHazard(&IF_ID->rs, &IF_ID->rt, &readsRs, &readsRt, &ID_EX->memRead, &ID_EX->rd, &hazard);
+  // EX가 값을 예측한 load는 그 값을 EX/MEM에서 forwarding하므로 기다리지 않는다.
+  return m_enableHazardDetection && ID_EX->valuePredicted == 0 && hazard == 1;
+}
+
+bool PipelinedCPU::SyscallDrainStall(const std::bitset<1> *IF_ID_valid, const HazardView *ID_EX,
+                                     const HazardView *EX_MEM)
+{
+  // syscall이 EX나 MEM에 있으면 retire($v0 write)할 때까지 ID의 명령을 붙잡아 둔다. bubble은 붙잡을 필요가 없다.
+  return *IF_ID_valid == 1 && (ID_EX->syscall == 1 || EX_MEM->syscall == 1);
+}
+
+bool PipelinedCPU::MulDivStall(const std::bitset<1> *IF_ID_valid, const DecodedInstruction *IF_ID, std::bitset<1> *busy)
+{
+  // multiplier/divider: 다음 cycle에 EX에 들어갈 mfhi, mflo는 HI, LO가 준비될 때까지 (data hazard),
+  // mult, div는 그 unit이 받을 수 있을 때까지 (structural hazard) 대기. syscall처럼 hazard detection과 상관없이 검사
+  std::bitset<1> result;
+  MulDivHazard(&m_mulDivUnit, IF_ID_valid, &IF_ID->readsHiLo, &IF_ID->mulDiv, &IF_ID->funct, &result, busy);
+  return result == 1 || *busy == 1;
+}
+
+bool PipelinedCPU::BranchOperandStall(const DecodedInstruction *IF_ID, const HazardView *ID_EX,
+                                      const HazardView *EX_MEM)
+{
+  // early branch resolution: ID에서 비교하는 beq(opcode 0x04)는 EX에 있는 명령(ALU 연산이든 load든)의 결과나
+  // MEM에 있는 load의 결과가 나올 때까지 대기 (MEM에 있는 ALU 연산의 결과는 EX/MEM에서 ID로 forwarding,
+  // forwarding이 꺼져 있으면 역시 대기)
+  if (!m_enableHazardDetection || !m_earlyBranchResolution || IF_ID->opcode != 0x04)
+  {
+    return false;
+  }
+  return (ID_EX->regWrite == 1 && ID_EX->rd != 0 && (ID_EX->rd == IF_ID->rs || ID_EX->rd == IF_ID->rt)) ||
+         (EX_MEM->regWrite == 1 && (EX_MEM->memRead == 1 || !m_enableDataForwarding) && EX_MEM->rd != 0 &&
+          (EX_MEM->rd == IF_ID->rs || EX_MEM->rd == IF_ID->rt));
+}
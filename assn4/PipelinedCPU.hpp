@@ -1,7 +1,15 @@
 #ifndef __PIPELINED_CPU_HPP__
 #define __PIPELINED_CPU_HPP__
 
+#include "BranchPredictor.hpp"
 #include "CPU.hpp"
+#include "FetchQueue.hpp"
+#include "LoopBuffer.hpp"
+#include "MemoryPort.hpp"
+#include "MulDivUnit.hpp"
+#include "PCProfiler.hpp"
+#include "PipelineTracer.hpp"
+#include "ValuePredictor.hpp"
 
 class PipelinedCPU : public CPU {
   public:
@@ -12,10 +20,20 @@ class PipelinedCPU : public CPU {
       const bool enableHazardDetection = false
     ) : CPU(initialPC, regFileName, instMemFileName, dataMemFileName),
         m_enableDataForwarding(enableDataForwarding),
-        m_enableHazardDetection(enableHazardDetection) {
+        m_enableHazardDetection(enableHazardDetection),
+        m_earlyBranchResolution(false), m_delaySlot(false), m_storeDataForwarding(false),
+        m_branchPredictor(nullptr), m_fetchQueue(nullptr), m_loopBuffer(nullptr), m_loadValuePredictor(nullptr),
+        m_instPort(m_instMemory, FETCH_BLOCK_BYTES, true), m_dataPort(m_dataMemory, 4, false), m_dataCache(nullptr),
+        m_profiler(nullptr), m_tracer(nullptr), m_nextSeq(0) {
       // initialize the latches
       m_latch_IF_ID.pcPlus4.reset();
       m_latch_IF_ID.instr.reset();
+      m_latch_IF_ID.valid.reset();
+      m_latch_IF_ID.predecoded.reset();
+      m_latch_ID_EX.valid.reset();
+      m_latch_EX_MEM.valid.reset();
+      m_latch_MEM_WB.valid.reset();
+      m_latch_IF_ID.seq = m_latch_ID_EX.seq = m_latch_EX_MEM.seq = m_latch_MEM_WB.seq = 0;
       m_latch_ID_EX.ctrlEXALUSrc.reset();
       m_latch_ID_EX.ctrlEXALUOp.reset();
       m_latch_ID_EX.ctrlEXRegDst.reset();
@@ -24,13 +42,190 @@ class PipelinedCPU : public CPU {
       m_latch_ID_EX.ctrlMEMMemWrite.reset();
       m_latch_ID_EX.ctrlWBRegWrite.reset();
       m_latch_ID_EX.ctrlWBMemToReg.reset();
+      m_latch_ID_EX.ctrlWBSyscall.reset();
+      m_latch_ID_EX.ctrlEXMulDiv.reset();
+      m_latch_ID_EX.ctrlEXReadHiLo.reset();
+      m_latch_ID_EX.readsRs.reset();
+      m_latch_ID_EX.readsRt.reset();
       m_latch_EX_MEM.ctrlMEMBranch.reset();
       m_latch_EX_MEM.ctrlMEMMemRead.reset();
       m_latch_EX_MEM.ctrlMEMMemWrite.reset();
       m_latch_EX_MEM.ctrlWBRegWrite.reset();
       m_latch_EX_MEM.ctrlWBMemToReg.reset();
+      m_latch_EX_MEM.ctrlWBSyscall.reset();
+      m_latch_EX_MEM.valuePredicted.reset();
       m_latch_MEM_WB.ctrlWBRegWrite.reset();
       m_latch_MEM_WB.ctrlWBMemToReg.reset();
+      m_latch_MEM_WB.ctrlWBSyscall.reset();
+      std::bitset<32> four(4);
+      Add<32>(&m_PC, &four, &m_IF_predictedPC);
+    }
+    virtual ~PipelinedCPU() {
+      if (m_tracer != nullptr) {
+        // the instructions still in flight (e.g., behind an exit) never retire; after an exit the
+        // MEM-WB latch still holds the exit itself
+        if (m_latch_MEM_WB.valid == 1 && !isHalted()) { m_tracer->flush(m_latch_MEM_WB.seq); }
+        if (m_latch_EX_MEM.valid == 1) { m_tracer->flush(m_latch_EX_MEM.seq); }
+        if (m_latch_ID_EX.valid == 1) { m_tracer->flush(m_latch_ID_EX.seq); }
+        if (m_latch_IF_ID.valid == 1) { m_tracer->flush(m_latch_IF_ID.seq); }
+        for (unsigned i = 0; m_fetchQueue != nullptr && i < m_fetchQueue->size(); i++) {
+          m_tracer->flush(m_fetchQueue->at(i).seq);
+        }
+      }
+      delete m_tracer;
+      delete m_profiler;
+      delete m_branchPredictor;
+      delete m_fetchQueue;
+      delete m_loopBuffer;
+      delete m_loadValuePredictor;
+      delete m_dataCache;
+    }
+    // predict the branches in IF and flush the wrong path when they resolve in MEM (see
+    // BranchPredictor.hpp); without a predictor the instructions after a branch always execute.
+    // The CPU owns `predictor'.
+    void setBranchPredictor(BranchPredictor *predictor) {
+      if (m_delaySlot && predictor != nullptr) {
+        fprintf(stderr, "ERROR: a branch predictor cannot be used with a delay slot.\n");
+        fflush(stderr);
+        assert(!m_delaySlot);
+      }
+      delete m_branchPredictor;
+      m_branchPredictor = predictor;
+    }
+    const BranchPredictor *getBranchPredictor() const { return m_branchPredictor; }
+    // resolve the branches in ID instead of MEM: the comparator and the target adder move to ID, which
+    // gets its own forwarding path from EX-MEM and stalls while an operand is still being computed by
+    // the instruction in EX (or loaded by the one in MEM); a wrong fetch after the branch is flushed
+    void enableEarlyBranchResolution() { m_earlyBranchResolution = true; }
+    // forward the result of the instruction in WB (e.g., a load) to the store data of a store in MEM, so
+    // that a store of a just-loaded value does not wait for it in ID (with data forwarding only)
+    void enableStoreDataForwarding() { m_storeDataForwarding = true; }
+    // the instruction after a branch (its delay slot) always executes and a taken branch redirects the
+    // fetch after it, as in MIPS; implies early branch resolution (the slot hides its one-cycle penalty).
+    // The programs need one instruction after every branch (mipsasm -p 1, optionally with -f).
+    void enableDelaySlot() {
+      if (m_branchPredictor != nullptr) {
+        fprintf(stderr, "ERROR: a branch predictor cannot be used with a delay slot.\n");
+        fflush(stderr);
+        assert(m_branchPredictor == nullptr);
+      }
+      if (m_fetchQueue != nullptr || m_instPort.latency() > 1) {
+        fprintf(stderr, "ERROR: a delay slot cannot be used with a fetch queue or a slow instruction memory.\n");
+        fflush(stderr);
+        assert(m_fetchQueue == nullptr && m_instPort.latency() <= 1);
+      }
+      if (m_loopBuffer != nullptr) {
+        fprintf(stderr, "ERROR: a delay slot cannot be used with a loop buffer.\n");
+        fflush(stderr);
+        assert(m_loopBuffer == nullptr);
+      }
+      if (m_loadValuePredictor != nullptr) {
+        fprintf(stderr, "ERROR: a delay slot cannot be used with a load value predictor.\n");
+        fflush(stderr);
+        assert(m_loadValuePredictor == nullptr);
+      }
+      m_earlyBranchResolution = true;
+      m_delaySlot = true;
+    }
+    // decouple IF from ID with a queue of `entries' instructions: IF fetches ahead along the predicted
+    // path (PC + 4 without a branch predictor) up to a fetch block per cycle while the queue has room,
+    // and ID takes its instruction from the head, so a stall in ID no longer stops the fetch. Every
+    // fetch off the path is flushed when its branch resolves (the padding nops are not needed).
+    void enableFetchQueue(const unsigned entries) {
+      if (m_delaySlot) {
+        fprintf(stderr, "ERROR: a delay slot cannot be used with a fetch queue or a slow instruction memory.\n");
+        fflush(stderr);
+        assert(!m_delaySlot);
+      }
+      delete m_fetchQueue;
+      m_fetchQueue = new FetchQueue(entries);
+    }
+    const FetchQueue *getFetchQueue() const { return m_fetchQueue; }
+    // IF reads the instruction memory through a buffer holding one aligned block of FETCH_BLOCK_BYTES;
+    // fetching from another block takes `cycles' cycles (1 = the ideal memory of the textbook pipeline)
+    void setInstMemLatency(const unsigned cycles) {
+      if (m_delaySlot && cycles > 1) {
+        fprintf(stderr, "ERROR: a delay slot cannot be used with a fetch queue or a slow instruction memory.\n");
+        fflush(stderr);
+        assert(!m_delaySlot);
+      }
+      m_instPort.setLatency(cycles);
+    }
+    // MEM reads and writes the data memory through a port whose every access takes `cycles' cycles
+    // (1 = the ideal memory of the textbook pipeline); while a load or a store waits for it, the whole
+    // pipeline holds (see PipelinedCPU::advanceCycle)
+    void setDataMemLatency(const unsigned cycles) { m_dataPort.setLatency(cycles); }
+    // an L1 data cache in front of the data memory (see DataCache.hpp): each load and store takes the
+    // cycles the cache tells in place of setDataMemLatency, and a miss holds the pipeline the same way.
+    // The CPU owns `cache'.
+    void setDataCache(DataCache *cache) {
+      delete m_dataCache;
+      m_dataCache = cache;
+      m_dataPort.setCache(cache);
+    }
+    const DataCache *getDataCache() const { return m_dataCache; }
+    const MemoryPort &getInstPort() const { return m_instPort; }
+    const MemoryPort &getDataPort() const { return m_dataPort; }
+    static const std::uint32_t FETCH_BLOCK_BYTES = 16;
+    // stream short loops from a buffer of `entries' decoded instructions (see LoopBuffer.hpp): once a
+    // loop body has been captured, IF takes it from the buffer (no instruction memory read, no wait
+    // for the fetch block) with the loop branch predicted taken, and ID skips its decode. The exit
+    // from the loop is flushed like a misprediction (the padding nops are not needed).
+    void enableLoopBuffer(const unsigned entries) {
+      if (m_delaySlot) {
+        fprintf(stderr, "ERROR: a delay slot cannot be used with a loop buffer.\n");
+        fflush(stderr);
+        assert(!m_delaySlot);
+      }
+      delete m_loopBuffer;
+      m_loopBuffer = new LoopBuffer(entries);
+    }
+    const LoopBuffer *getLoopBuffer() const { return m_loopBuffer; }
+    // predict the value of a load in EX (see ValuePredictor.hpp) and forward it from EX-MEM, so that the
+    // instruction after the load does not wait for it in ID; MEM checks the prediction against the loaded
+    // value, and if the instruction in EX took a wrong one, squashes the instructions after the load and
+    // fetches them again (with data forwarding only). The CPU owns `predictor'.
+    void setLoadValuePredictor(LoadValuePredictor *predictor) {
+      if (m_delaySlot && predictor != nullptr) {
+        fprintf(stderr, "ERROR: a delay slot cannot be used with a load value predictor.\n");
+        fflush(stderr);
+        assert(!m_delaySlot);
+      }
+      delete m_loadValuePredictor;
+      m_loadValuePredictor = predictor;
+    }
+    const LoadValuePredictor *getLoadValuePredictor() const { return m_loadValuePredictor; }
+    // mult and multu take `cycles' cycles until mfhi/mflo can read their result (see MulDivUnit.hpp); a
+    // `pipelined' multiplier accepts one every cycle, an iterative one holds the next in ID until it is
+    // done. Without a call, the multiplier and the divider are as fast as the ALU.
+    void setMultiplier(const unsigned cycles, const bool pipelined) { m_mulDivUnit.configure(false, cycles, pipelined); }
+    // the same for div and divu
+    void setDivider(const unsigned cycles, const bool pipelined) { m_mulDivUnit.configure(true, cycles, pipelined); }
+    const MulDivUnit &getMulDivUnit() const { return m_mulDivUnit; }
+    // charge the stalls and forwards to PCs from now on (see PCProfiler.hpp)
+    void enableProfiler() {
+      if (m_profiler == nullptr) {
+        m_profiler = new PCProfiler();
+      }
+    }
+    // report the pipeline events to `tracer' from now on (see PipelineTracer.hpp); the CPU owns the tracer
+    void addTracer(PipelineTracer *tracer) {
+      if (m_tracer == nullptr) {
+        m_tracer = tracer;
+        return;
+      }
+      TracerList *list = dynamic_cast<TracerList *>(m_tracer);
+      if (list == nullptr) {
+        list = new TracerList();
+        list->add(m_tracer);
+        m_tracer = list;
+      }
+      list->add(tracer);
+    }
+    void writeProfile(FILE *file, const size_t maxEntries = 20) {
+      if (m_profiler != nullptr) {
+        m_profiler->writeReport(file, m_instMemory, getCurrCycle(), getNumRetired(), maxEntries);
+      }
     }
   public:
     /******************************************************************/
@@ -39,7 +234,23 @@ class PipelinedCPU : public CPU {
     /******************************************************************/
     virtual void advanceCycle() {
       CPU::advanceCycle();
+      if (m_tracer != nullptr) {
+        m_tracer->cycle(getCurrCycle());
+      }
+      m_instPort.tick();
+      m_dataPort.tick();
+      // a load or a store in MEM waits for the data memory: no stage moves (the instruction in WB retires
+      // once the access completes, so EX still finds it on its forwarding path)
+      const bool store = m_latch_EX_MEM.ctrlMEMMemWrite == 1;
+      if (m_latch_EX_MEM.valid == 1 && (m_latch_EX_MEM.ctrlMEMMemRead == 1 || store) &&
+          !m_dataPort.request((std::uint32_t)m_latch_EX_MEM.aluResult.to_ulong(), store)) {
+        PERF_COUNT(m_perfCounters.memStalls++);
+        return;
+      }
       WriteBack();
+      if (isHalted()) {
+        return; // exit retired; the younger instructions never leave the pipeline
+      }
       MemoryAccess();
       Execute();
       InstructionDecode();
@@ -50,6 +261,11 @@ class PipelinedCPU : public CPU {
     struct {
       std::bitset<32> pcPlus4;  // PC+4
       std::bitset<32> instr;    // 32-bit instruction
+      std::bitset<32> predictedPC; // the PC IF fetched next (with a branch predictor)
+      std::bitset<1> valid;     // 1 if an instruction was fetched (0 = bubble)
+      unsigned long long seq;   // fetch sequence number (for the tracer)
+      std::bitset<1> predecoded; // 1 if `decoded' holds instr already decoded (from the loop buffer)
+      DecodedInstruction decoded;
     } m_latch_IF_ID; // IF-ID latch
     struct {
       std::bitset<32> pcPlus4;        // PC+4 (from IF)
@@ -67,8 +283,17 @@ class PipelinedCPU : public CPU {
       std::bitset<1> ctrlMEMMemWrite; // `MemWrite' for MEM
       std::bitset<1> ctrlWBRegWrite;  // `RegWrite' for WB
       std::bitset<1> ctrlWBMemToReg;  // `MemToReg' for WB
+      std::bitset<1> ctrlWBSyscall;   // `syscall' to be serviced in WB
+      std::bitset<1> ctrlEXMulDiv;    // mult, multu, div, divu: issue to the multiplier/divider in EX
+      std::bitset<1> ctrlEXReadHiLo;  // mfhi, mflo: HI or LO in place of the ALU result
+      std::bitset<1> readsRs;         // 1 if the instruction reads rs (0 for a bubble)
+      std::bitset<1> readsRt;         // 1 if the instruction reads rt (0 for a bubble)
+      std::bitset<32> predictedPC;    // the PC IF fetched next (from IF)
+      std::bitset<1> valid;           // 1 if the latch holds an instruction (0 = bubble)
+      unsigned long long seq;         // fetch sequence number (for the tracer)
     } m_latch_ID_EX; // ID-EX latch
     struct {
+      std::bitset<32> pcPlus4;        // PC+4 (from ID; identifies the instruction)
       std::bitset<32> branchTarget;   // (PC+4)+(Immed<<2)
       std::bitset<32> aluResult;      // result from the ALU
       std::bitset<1> aluZero;         // zero from the ALU
@@ -79,16 +304,27 @@ class PipelinedCPU : public CPU {
       std::bitset<1> ctrlMEMMemWrite; // `MemWrite' for MEM
       std::bitset<1> ctrlWBRegWrite;  // `RegWrite' for WB
       std::bitset<1> ctrlWBMemToReg;  // `MemToReg' for WB
+      std::bitset<1> ctrlWBSyscall;   // `syscall' to be serviced in WB
+      std::bitset<32> predictedPC;    // the PC IF fetched next (from ID)
+      std::bitset<1> valuePredicted;  // 1 if a load whose value was predicted (in predictedValue)
+      std::bitset<32> predictedValue; // the value forwarded for the load until MEM reads the real one
+      std::bitset<1> valid;           // 1 if the latch holds an instruction (0 = bubble)
+      unsigned long long seq;         // fetch sequence number (for the tracer)
     } m_latch_EX_MEM; // EX-MEM latch
     struct {
+      std::bitset<32> pcPlus4;        // PC+4 (from EX; identifies the instruction)
       std::bitset<32> readData;       // readData from the data memory
       std::bitset<32> aluResult;      // result from the ALU (from EX)
       std::bitset<5> rd;              // rd (from EX)
       std::bitset<1> ctrlWBRegWrite;  // `RegWrite' for WB
       std::bitset<1> ctrlWBMemToReg;  // `MemToReg' for WB
+      std::bitset<1> ctrlWBSyscall;   // `syscall' to be serviced in WB
+      std::bitset<1> valid;           // 1 if the latch holds an instruction (0 = bubble)
+      unsigned long long seq;         // fetch sequence number (for the tracer)
     } m_latch_MEM_WB; // MEM-WB latch
   public:
     virtual void printPVS() {
+      HOST_PROFILE(PrintPVS);
       CPU::printPVS();
       printf("Latches:\n");
       printf("  IF-ID Latch:\n");
@@ -136,6 +372,18 @@ class PipelinedCPU : public CPU {
     void Execute();
     void MemoryAccess();
     void WriteBack();
+    // the IF stage of a decoupled front end (see enableFetchQueue)
+    void FetchIntoQueue();
+    // whether IF fetches along a predicted path, which the branches check and flush when they resolve
+    bool FlushesWrongPath() const {
+      return m_branchPredictor != nullptr || m_fetchQueue != nullptr || m_loopBuffer != nullptr;
+    }
+    // turns the instructions in the IF-ID and ID-EX latches (and the fetch queue) into bubbles (a
+    // mispredicted branch in MEM)
+    void FlushYounger();
+    // whether the instruction memory returns the block of `pc' this cycle; starts the access if the
+    // fetch buffer holds another block
+    bool InstMemReady(const std::bitset<32> &pc);
 
   /*********************************************************/
   /*      +------------- Assignment #4 -------------+      */
@@ -146,37 +394,21 @@ class PipelinedCPU : public CPU {
     // configuration parameters
     bool m_enableDataForwarding;
     bool m_enableHazardDetection;
-
-    /**************************************************/
-    /* PipelinedCPU::Mux                              */
-    /*   - Three-to-one multiplexer                   */
-    /*   - if select = 0/1/2 then output = input0/1/2 */
-    /**************************************************/
-    template<size_t N>
-    void Mux(
-      const std::bitset<N> *input0, const std::bitset<N> *input1,
-      const std::bitset<N> *input2, const std::bitset<2> *select,
-      std::bitset<N> *output
-    ) {
-      switch (select->to_ulong()) {
-        case 0:
-          (*output) = (*input0);
-          break;
-        case 1:
-          (*output) = (*input1);
-          break;
-        case 2:
-          (*output) = (*input2);
-          break;
-        default: {
-          fprintf(stderr, "ERROR: `select' %lu is out-of-range.\n",
-                  select->to_ulong());
-          fflush(stderr);
-          assert(select->to_ulong() >= 0 && select->to_ulong() < 3);
-          break;
-        }
-      }
-    }
+    bool m_earlyBranchResolution;
+    bool m_delaySlot;
+    bool m_storeDataForwarding;
+    BranchPredictor *m_branchPredictor; // <-- nullptr: no prediction, no flush
+    FetchQueue *m_fetchQueue;           // <-- nullptr: IF writes the IF-ID latch
+    LoopBuffer *m_loopBuffer;           // <-- nullptr: every fetch reads the instruction memory
+    LoadValuePredictor *m_loadValuePredictor; // <-- nullptr: a load-use hazard always stalls
+    MulDivUnit m_mulDivUnit;
+    MemoryPort m_instPort; // <-- IF's port to m_instMemory, with the fetch buffer of one block
+    MemoryPort m_dataPort; // <-- MEM's port to m_dataMemory
+    DataCache *m_dataCache; // <-- nullptr: every access takes the latency of m_dataPort
+    // optional instrumentation
+    PCProfiler *m_profiler;
+    PipelineTracer *m_tracer;
+    unsigned long long m_nextSeq; // <-- the sequence number of the next fetched instruction
 
     /****************************************************************************/
     /* PipelinedCPU::ForwardingUnit                                             */
@@ -184,9 +416,12 @@ class PipelinedCPU : public CPU {
     /*   - forwardA/B = 0 (if the ReadData1/2 of the ID stage should be used)   */
     /*                  1 (if the ALUResult of the MEM-WB latch should be used) */
     /*                  2 (if the ALUResult of the EX-MEM latch should be used) */
+    /*   - forwardA/B = 0 for an operand the instruction does not read          */
+    /*     (readsRs/readsRt), whose value is a don't-care                       */
     /****************************************************************************/
     void ForwardingUnit(
       const std::bitset<5> *ID_EX_rs, const std::bitset<5> *ID_EX_rt,
+      const std::bitset<1> *ID_EX_readsRs, const std::bitset<1> *ID_EX_readsRt,
       const std::bitset<1> *EX_MEM_regWrite, const std::bitset<5> *EX_MEM_rd,
       const std::bitset<1> *MEM_WB_regWrite, const std::bitset<5> *MEM_WB_rd,
       std::bitset<2> *forwardA, std::bitset<2> *forwardB
@@ -198,30 +433,76 @@ class PipelinedCPU : public CPU {
     std::bitset<1>  m_WB_to_FwdUnit_regWrite = 0;   // populated in WB
     std::bitset<5>  m_WB_to_FwdUnit_rd;             // populated in WB
     std::bitset<32> m_WB_to_FwdUnit_rdValue;        // populated in WB
+    std::bitset<32> m_WB_to_FwdUnit_pcPlus4;        // populated in WB (the producer, for the profiler)
+
+    // The data to be passed to the Hazard Detection Unit from the later stages: what it sees of the instruction
+    // in EX (the ID-EX latch) and the one in MEM (the EX-MEM latch), which those stages already consumed
+    struct HazardView {
+      std::bitset<1> memRead = 0;
+      std::bitset<1> regWrite = 0;
+      std::bitset<5> rd;                 // the register it writes (after the RegDst Mux: rt for a load)
+      std::bitset<1> syscall = 0;
+      std::bitset<1> valuePredicted = 0; // a load whose value EX predicted (only in EX)
+    };
+    HazardView m_EX_to_HazDetUnit;  // populated in EX
+    HazardView m_MEM_to_HazDetUnit; // populated in MEM
 
     /************************************************************************/
     /* PipelinedCPU::HazardDetectionUnit                                    */
-    /*   - Detects a load-use data hazard and inserts a bubble if necessary */
-    /*   - if (a load-use data hazard exists) {                             */
+    /*   - Holds the instruction in ID (IF_ID) and inserts a bubble if one  */
+    /*     of the stall causes below holds for it                           */
+    /*   - if (it must stall) {                                             */
     /*       PCWrite = IFIDWrite = 0; ctrlSelect = 1;                       */
     /*     } else {                                                         */
     /*       PCWrite = IFIDWrite = 1; ctrlSelect = 0;                       */
     /*     }                                                                */
     /************************************************************************/
     void HazardDetectionUnit(
-      const std::bitset<5> *IF_ID_rs, const std::bitset<5> *IF_ID_rt,
-      const std::bitset<1> *ID_EX_memRead, const std::bitset<5> *ID_EX_rt,
+      const std::bitset<1> *IF_ID_valid, const DecodedInstruction *IF_ID,
+      const HazardView *ID_EX, const HazardView *EX_MEM,
       std::bitset<1> *PCWrite, std::bitset<1> *IFIDWrite, std::bitset<1> *ctrlSelect
     );
-    // The data to be passed to the Hazard Detection Unit from the later stages
-    std::bitset<1> m_EX_to_HazDetUnit_memRead = 0;  // populated in EX
-    std::bitset<5> m_EX_to_HazDetUnit_rt;           // populated in EX
+    /************************************************************************/
+    /* PipelinedCPU::LoadUseStall                                           */
+    /*   - A load-use data hazard, only on the registers the instruction    */
+    /*     actually reads (readsRs/readsRt from decode, never $zero, never  */
+    /*     for a bubble, not the store data MEM forwards)                   */
+    /*   - No bubble behind a load whose value EX predicted                 */
+    /************************************************************************/
+    bool LoadUseStall(const std::bitset<1> *IF_ID_valid, const DecodedInstruction *IF_ID, const HazardView *ID_EX);
+    /************************************************************************/
+    /* PipelinedCPU::SyscallDrainStall                                      */
+    /*   - A `syscall' is in EX or MEM: it may write $v0 when it retires    */
+    /************************************************************************/
+    bool SyscallDrainStall(const std::bitset<1> *IF_ID_valid, const HazardView *ID_EX, const HazardView *EX_MEM);
+    /************************************************************************/
+    /* PipelinedCPU::MulDivStall                                            */
+    /*   - An mfhi/mflo before HI and LO are ready, or a mult or div before */
+    /*     its unit can accept it (busy = 1; see MulDivUnit.hpp)            */
+    /************************************************************************/
+    bool MulDivStall(const std::bitset<1> *IF_ID_valid, const DecodedInstruction *IF_ID, std::bitset<1> *busy);
+    /************************************************************************/
+    /* PipelinedCPU::BranchOperandStall                                     */
+    /*   - With early branch resolution, a branch in ID while the           */
+    /*     instruction in EX writes one of its operands, or the load in MEM */
+    /*     does                                                             */
+    /************************************************************************/
+    bool BranchOperandStall(const DecodedInstruction *IF_ID, const HazardView *ID_EX, const HazardView *EX_MEM);
     // The data to be passed to the IF stage from the Hazard Detection Unit
     std::bitset<1> m_HazDetUnit_to_IF_PCWrite = 1;    // populated in ID
     std::bitset<1> m_HazDetUnit_to_IF_IFIDWrite = 1;  // populated in ID
     // The data to be passed from the MEM stage to the IF stage
+    // (with a branch predictor: PCSrc = 1 on a misprediction, branchTarget = the correct next PC;
+    // with a load value predictor, also the PC after a load whose wrong predicted value was used)
     std::bitset<1>  m_MEM_to_IF_PCSrc = 0;
     std::bitset<32> m_MEM_to_IF_branchTarget;
+    // The data to be passed from the ID stage to the IF stage (with early branch resolution:
+    // PCSrc = 1 if the instruction IF fetches in this cycle is on the wrong path, or with a delay slot, if
+    // the fetch after it must go elsewhere; branchTarget = the correct PC)
+    std::bitset<1>  m_ID_to_IF_PCSrc = 0;
+    std::bitset<32> m_ID_to_IF_branchTarget;
+    // The PC predicted to follow the one IF fetched last (when IF fetches along a predicted path)
+    std::bitset<32> m_IF_predictedPC;
 };
 
 #endif
@@ -6,6 +6,7 @@ void RegisterFile::access(
   const std::bitset<1> *regWrite,
   std::bitset<32> *readData1, std::bitset<32> *readData2
 ) {
+  HOST_PROFILE(RegisterFileAccessCall);
   if (regWrite != nullptr && regWrite->all()) {
     assert(writeRegister != nullptr && writeData != nullptr);
     if (*writeRegister != 0) { // prevent $0 (= $zero) from being written
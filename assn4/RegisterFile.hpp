@@ -1,8 +1,12 @@
 #ifndef __REGISTER_FILE_HPP__
 #define __REGISTER_FILE_HPP__
 
+#include "HostProfiler.hpp"
+#include "Verbosity.hpp"
+
 #include <bitset>
 #include <cassert>
+#include <cstdint>
 #include <cstdio>
 
 class RegisterFile {
@@ -21,7 +25,9 @@ class RegisterFile {
         std::uint32_t reg, val;
         while (fscanf(initFile, " %u %x", &reg, &val) == 2) {
           if (reg != 0) {
-            printf("INFO: $%02u <-- 0x%08lx\n", reg, (unsigned long)val);
+            if (!quietMode()) {
+              printf("INFO: $%02u <-- 0x%08lx\n", reg, (unsigned long)val);
+            }
             m_registers[reg] = val;
           }
         }
@@ -34,6 +40,22 @@ class RegisterFile {
         }
       }
     }
+    // write the non-zero registers in the register initialization file format
+    void dumpRegisters(FILE *file) {
+      for (size_t i = 0; i < 32; i++) {
+        if (m_registers[i].any()) {
+          fprintf(file, "%u %08lx\n", (unsigned)i, m_registers[i].to_ulong());
+        }
+      }
+    }
+    // FNV-1a hash of the registers; used to compare the final states of two runs
+    std::uint64_t digest() {
+      std::uint64_t hash = 14695981039346656037ULL;
+      for (size_t i = 0; i < 32; i++) {
+        hash = (hash ^ m_registers[i].to_ulong()) * 1099511628211ULL;
+      }
+      return hash;
+    }
     void access(
       const std::bitset<5> *readRegister1, const std::bitset<5> *readRegister2,
       const std::bitset<5> *writeRegister, const std::bitset<32> *writeData,
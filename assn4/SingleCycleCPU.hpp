@@ -0,0 +1,23 @@
+#ifndef __SINGLE_CYCLE_CPU_HPP__
+#define __SINGLE_CYCLE_CPU_HPP__
+
+#include "CPU.hpp"
+
+class SingleCycleCPU : public CPU {
+  public:
+    SingleCycleCPU(
+      const std::uint32_t initialPC, const char *regFileName,
+      const char *instMemFileName, const char *dataMemFileName
+    ) : CPU(initialPC, regFileName, instMemFileName, dataMemFileName),
+        m_delaySlot(false), m_delayedBranch(0), m_delayedTarget(0) { }
+    // the instruction after a branch (its delay slot) always executes; a taken branch jumps after it
+    void enableDelaySlot() { m_delaySlot = true; }
+    virtual void advanceCycle();
+  private:
+    bool m_delaySlot;
+    std::bitset<1> m_delayedBranch;  // the previous instruction was a taken branch (delay slot mode)
+    std::bitset<32> m_delayedTarget; // its target
+};
+
+#endif
+
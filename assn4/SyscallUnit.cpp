@@ -0,0 +1,92 @@
+#include "SyscallUnit.hpp"
+
+#define REG_V0 2
+#define REG_A0 4
+
+const SyscallUnit::Service SyscallUnit::s_services[] = {
+  {  1, "print_int",    &SyscallUnit::PrintInt },
+  {  4, "print_string", &SyscallUnit::PrintString },
+  {  9, "sbrk",         &SyscallUnit::Sbrk },
+  { 10, "exit",         &SyscallUnit::Exit },
+  { 11, "print_char",   &SyscallUnit::PrintChar },
+  { 17, "exit2",        &SyscallUnit::Exit2 },
+};
+
+void SyscallUnit::execute() {
+  const std::uint32_t code = readRegister(REG_V0);
+  for (size_t i = 0; i < sizeof(s_services) / sizeof(s_services[0]); i++) {
+    if (s_services[i].code == code) {
+      (this->*s_services[i].handler)();
+      return;
+    }
+  }
+  printf("WARNING: Unsupported syscall %lu\n", (unsigned long)code);
+  fflush(stdout);
+}
+
+void SyscallUnit::PrintInt() {
+  char text[16];
+  int length = snprintf(text, sizeof(text), "%d", (std::int32_t)readRegister(REG_A0));
+  m_sink.write(text, length);
+}
+
+void SyscallUnit::PrintString() {
+  // The data memory is always little-endian (see CPU::CPU), so the byte at `addr' is the
+  // least significant byte of the word starting at `addr'.
+  std::bitset<1> memRead(1);
+  std::bitset<1> memWrite(0);
+  for (std::uint32_t addr = readRegister(REG_A0); addr + 3 < MEMORY_SIZE; addr++) {
+    std::bitset<32> address(addr);
+    std::bitset<32> word;
+    m_dataMemory->access(&address, nullptr, &memRead, &memWrite, &word);
+    const char c = (char)(word.to_ulong() & 0xFF);
+    if (c == '\0') {
+      break;
+    }
+    m_sink.put(c);
+  }
+}
+
+void SyscallUnit::Sbrk() {
+  const std::uint32_t request = readRegister(REG_A0);
+  const std::uint32_t size = (request + 3) & ~3u; // keep the heap word-aligned
+  // 비교는 남은 공간 기준으로 (m_heapBreak + size 는 32비트에서 wrap 될 수 있음)
+  if (size < request || size > MEMORY_SIZE - m_heapBreak) {
+    printf("ERROR: sbrk(%lu) exceeds the data memory\n", (unsigned long)request);
+    fflush(stdout);
+    writeRegister(REG_V0, 0xFFFFFFFF);
+    return;
+  }
+  writeRegister(REG_V0, m_heapBreak);
+  m_heapBreak += size;
+}
+
+void SyscallUnit::Exit() {
+  m_halted = true;
+  m_exitCode = 0;
+  m_sink.flush();
+}
+
+void SyscallUnit::PrintChar() {
+  m_sink.put((char)(readRegister(REG_A0) & 0xFF));
+}
+
+void SyscallUnit::Exit2() {
+  m_halted = true;
+  m_exitCode = (int)readRegister(REG_A0);
+  m_sink.flush();
+}
+
+std::uint32_t SyscallUnit::readRegister(const unsigned index) {
+  std::bitset<5> readRegister(index);
+  std::bitset<32> readData1, readData2;
+  m_registerFile->access(&readRegister, &readRegister, nullptr, nullptr, nullptr, &readData1, &readData2);
+  return (std::uint32_t)readData1.to_ulong();
+}
+
+void SyscallUnit::writeRegister(const unsigned index, const std::uint32_t value) {
+  std::bitset<5> writeRegister(index);
+  std::bitset<32> writeData(value);
+  std::bitset<1> regWrite(1);
+  m_registerFile->access(nullptr, nullptr, &writeRegister, &writeData, &regWrite, nullptr, nullptr);
+}
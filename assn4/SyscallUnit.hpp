@@ -0,0 +1,93 @@
+#ifndef __SYSCALL_UNIT_HPP__
+#define __SYSCALL_UNIT_HPP__
+
+#include "Memory.hpp"
+#include "RegisterFile.hpp"
+
+#include <cstdint>
+#include <cstdio>
+
+#define SYSCALL_HEAP_BASE (16 * 1024 * 1024) // <-- sbrk hands out memory from 16 MB upwards
+
+/****************************************************************/
+/* OutputSink                                                   */
+/*   - Buffers the output of the simulated program and writes   */
+/*     it to the host file only when the buffer fills up or the */
+/*     program exits                                            */
+/****************************************************************/
+class OutputSink {
+  public:
+    OutputSink(FILE *file, const size_t capacity = 4096)
+      : m_file(file), m_buffer(new char[capacity]), m_capacity(capacity), m_length(0) { }
+    void write(const char *data, const size_t length) {
+      for (size_t i = 0; i < length; i++) {
+        put(data[i]);
+      }
+    }
+    void put(const char c) {
+      if (m_length == m_capacity) {
+        flush();
+      }
+      m_buffer[m_length++] = c;
+    }
+    void flush() {
+      if (m_length > 0) {
+        fwrite(m_buffer, 1, m_length, m_file);
+        fflush(m_file);
+        m_length = 0;
+      }
+    }
+    ~OutputSink() {
+      flush();
+      delete[] m_buffer;
+    }
+  private:
+    FILE *m_file;
+    char *m_buffer;
+    size_t m_capacity;
+    size_t m_length;
+};
+
+/*****************************************************************************/
+/* SyscallUnit                                                               */
+/*   - Services the `syscall' instruction when it retires                    */
+/*   - The service number is read from $v0 and the arguments from $a0..$a3, */
+/*     following the MARS conventions                                        */
+/*   - Supported services: print_int (1), print_string (4), sbrk (9),       */
+/*     exit (10), print_char (11), exit2 (17)                                */
+/*****************************************************************************/
+class SyscallUnit {
+  public:
+    SyscallUnit(RegisterFile *registerFile, Memory *dataMemory, FILE *outputFile = stdout)
+      : m_registerFile(registerFile), m_dataMemory(dataMemory), m_sink(outputFile),
+        m_heapBreak(SYSCALL_HEAP_BASE), m_halted(false), m_exitCode(0) { }
+    void execute();
+    bool isHalted() const { return m_halted; }
+    int exitCode() const { return m_exitCode; }
+  private:
+    // host-side service table
+    struct Service {
+      std::uint32_t code;
+      const char *name;
+      void (SyscallUnit::*handler)();
+    };
+    static const Service s_services[];
+    void PrintInt();
+    void PrintString();
+    void Sbrk();
+    void Exit();
+    void PrintChar();
+    void Exit2();
+
+    std::uint32_t readRegister(const unsigned index);
+    void writeRegister(const unsigned index, const std::uint32_t value);
+
+    RegisterFile *m_registerFile;
+    Memory *m_dataMemory;
+    OutputSink m_sink;
+    std::uint32_t m_heapBreak; // <-- the next address handed out by sbrk
+    bool m_halted;
+    int m_exitCode;
+};
+
+#endif
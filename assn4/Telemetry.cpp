@@ -0,0 +1,89 @@
+#include "Telemetry.hpp"
+
+#include "HostProfiler.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+Telemetry::Telemetry(const char *program, const char *cpu, const unsigned long long periodCycles)
+  : m_block(nullptr), m_period(periodCycles > 0 ? periodCycles : 1), m_nextUpdate(0) {
+  snprintf(m_name, sizeof(m_name), "/" TELEMETRY_PREFIX "%d", (int)getpid());
+  int fd = shm_open(m_name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+  if (fd < 0) {
+    printf("WARNING: cannot create the telemetry segment `%s'\n", m_name);
+    return;
+  }
+  if (ftruncate(fd, sizeof(TelemetryBlock)) != 0) {
+    printf("WARNING: cannot size the telemetry segment `%s'\n", m_name);
+    close(fd);
+    shm_unlink(m_name);
+    return;
+  }
+  void *address = mmap(nullptr, sizeof(TelemetryBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (address == MAP_FAILED) {
+    printf("WARNING: cannot map the telemetry segment `%s'\n", m_name);
+    shm_unlink(m_name);
+    return;
+  }
+  m_block = new (address) TelemetryBlock(); // zero-filled by ftruncate
+  m_block->pid = (std::int32_t)getpid();
+  snprintf(m_block->program, sizeof(m_block->program), "%s", program);
+  snprintf(m_block->cpu, sizeof(m_block->cpu), "%s", cpu);
+  m_block->counters.startTime = m_block->counters.updateTime = HostProfiler::now();
+  m_block->sequence.store(0, std::memory_order_release);
+  // the viewers skip a segment until the magic is there
+  std::atomic_thread_fence(std::memory_order_release);
+  m_block->magic = TELEMETRY_MAGIC;
+}
+
+Telemetry::~Telemetry() {
+  if (m_block != nullptr) {
+    munmap(m_block, sizeof(TelemetryBlock));
+    shm_unlink(m_name);
+  }
+}
+
+void Telemetry::publish(const PerfCounters &counters, const bool halted) {
+  m_nextUpdate = counters.cycles + m_period;
+  if (m_block == nullptr) {
+    return;
+  }
+  TelemetryCounters &out = m_block->counters;
+  double now = HostProfiler::now();
+  std::uint32_t sequence = m_block->sequence.load(std::memory_order_relaxed);
+  m_block->sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  out.cyclesPerSecond = (now > out.updateTime) ? (counters.cycles - out.cycles) / (now - out.updateTime) : 0.0;
+  out.cycles = counters.cycles;
+  out.retired = counters.retired;
+  out.loadUseBubbles = counters.loadUseBubbles;
+  out.syscallBubbles = counters.syscallBubbles;
+  out.redirectPenalty = counters.redirectPenalty;
+  out.memReads = counters.memReads;
+  out.memWrites = counters.memWrites;
+  out.cpi = counters.cpi();
+  out.updateTime = now;
+  out.halted = halted ? 1 : 0;
+
+  m_block->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void Telemetry::read(const TelemetryBlock *block, TelemetryCounters *snapshot) {
+  while (true) {
+    std::uint32_t before = block->sequence.load(std::memory_order_acquire);
+    if (before % 2 == 0) {
+      memcpy(snapshot, &block->counters, sizeof(*snapshot));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (block->sequence.load(std::memory_order_relaxed) == before) {
+        return;
+      }
+    }
+  }
+}
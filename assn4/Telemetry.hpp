@@ -0,0 +1,72 @@
+#ifndef __TELEMETRY_HPP__
+#define __TELEMETRY_HPP__
+
+#include "PerfCounters.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+#define TELEMETRY_PREFIX "mipssim." // the segments are /dev/shm/mipssim.<pid>
+#define TELEMETRY_MAGIC 0x4D495053544C4D31ULL // "MIPSTLM1"
+
+// the counters of a run, as published (see Telemetry::publish)
+struct TelemetryCounters {
+  std::uint64_t cycles;
+  std::uint64_t retired;
+  std::uint64_t loadUseBubbles;
+  std::uint64_t syscallBubbles;
+  std::uint64_t redirectPenalty;
+  std::uint64_t memReads;
+  std::uint64_t memWrites;
+  double cpi;
+  double cyclesPerSecond; // since the previous update
+  double startTime;       // host time (CLOCK_MONOTONIC, s) of the first update
+  double updateTime;      // host time of the last update
+  std::int32_t halted;    // the simulated program has exited (or the simulator is done)
+};
+
+/******************************************************************************/
+/* TelemetryBlock                                                             */
+/*   - The layout of a telemetry segment; written by one simulator, read by  */
+/*     any number of viewers (mipstop)                                       */
+/*   - The counters are guarded by a seqlock: the writer makes `sequence'    */
+/*     odd, updates the counters and makes it even again; a reader retries  */
+/*     until it reads the same even value before and after its copy         */
+/******************************************************************************/
+struct TelemetryBlock {
+  std::uint64_t magic;
+  std::int32_t pid;
+  char program[64]; // the instruction memory file of the run
+  char cpu[32];     // the simulated CPU, e.g., "PipelinedCPU"
+  std::atomic<std::uint32_t> sequence;
+  TelemetryCounters counters;
+};
+
+/******************************************************************************/
+/* Telemetry                                                                  */
+/*   - Publishes the counters of a CPU into a POSIX shared-memory segment    */
+/*     (/dev/shm/mipssim.<pid>) every `periodCycles' cycles, for mipstop to  */
+/*     watch a run live                                                      */
+/*   - The segment is mapped once; an update is a few stores and a read of   */
+/*     the (vDSO) monotonic clock, no system calls                           */
+/*   - The segment is unlinked when the Telemetry is destroyed              */
+/******************************************************************************/
+class Telemetry {
+  public:
+    // stays disabled (isOpen() == false) if the segment cannot be created
+    Telemetry(const char *program, const char *cpu, const unsigned long long periodCycles = 65536);
+    ~Telemetry();
+    bool isOpen() const { return m_block != nullptr; }
+    bool due(const unsigned long long cycle) const { return cycle >= m_nextUpdate; }
+    void publish(const PerfCounters &counters, const bool halted = false);
+
+    // viewer side: a consistent copy of the counters (spins while the writer is in the middle of an update)
+    static void read(const TelemetryBlock *block, TelemetryCounters *snapshot);
+  private:
+    TelemetryBlock *m_block;
+    char m_name[64];
+    unsigned long long m_period;
+    unsigned long long m_nextUpdate;
+};
+
+#endif
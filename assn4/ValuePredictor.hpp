@@ -0,0 +1,116 @@
+#ifndef __VALUE_PREDICTOR_HPP__
+#define __VALUE_PREDICTOR_HPP__
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/******************************************************************************/
+/* LoadValuePredictor                                                         */
+/*   - Predicts the value a load returns from the values the same load        */
+/*     returned before (see PipelinedCPU::setLoadValuePredictor)              */
+/*   - A direct-mapped table indexed and tagged by the PC of the load; each   */
+/*     entry holds the last value, the stride between the last two values     */
+/*     (last-value prediction keeps it 0) and a 2-bit confidence counter      */
+/*   - The prediction (last + stride) is made only with confidence 3, i.e.,   */
+/*     after three right values in a row; a wrong value resets it             */
+/*   - Trained in MEM with every loaded value                                 */
+/******************************************************************************/
+class LoadValuePredictor {
+  public:
+    LoadValuePredictor(const bool stride, const unsigned entries)
+      : m_stride(stride), m_entries(entries), m_mask(entries - 1), m_loads(0), m_predictions(0), m_correct(0),
+        m_used(0), m_replays(0) {
+      for (size_t i = 0; i < m_entries.size(); i++) {
+        m_entries[i].valid = false;
+      }
+    }
+    // "last[:entries]" or "stride[:entries]" (default 256 entries, a power of two); nullptr if `spec' is
+    // malformed
+    static LoadValuePredictor *create(const std::string &spec) {
+      size_t colon = spec.find(':');
+      std::string name = spec.substr(0, colon);
+      unsigned long entries = 256;
+      if (colon != std::string::npos) {
+        char *end;
+        entries = strtoul(spec.c_str() + colon + 1, &end, 0);
+        if (*end != '\0') {
+          return nullptr;
+        }
+      }
+      if (entries == 0 || (entries & (entries - 1)) != 0 || (name != "last" && name != "stride")) {
+        return nullptr;
+      }
+      return new LoadValuePredictor(name == "stride", (unsigned)entries);
+    }
+    // the spec that creates an equal predictor
+    std::string name() const {
+      return std::string(m_stride ? "stride:" : "last:") + std::to_string(m_entries.size());
+    }
+
+    // the value the load at `pc' is predicted to return; false if the predictor is not confident
+    bool predict(const std::uint32_t pc, std::uint32_t *value) const {
+      const Entry &entry = m_entries[(pc >> 2) & m_mask];
+      if (!entry.valid || entry.pc != pc || entry.confidence < 3) {
+        return false;
+      }
+      *value = entry.last + entry.stride;
+      return true;
+    }
+    // the load at `pc' returned `value'
+    void train(const std::uint32_t pc, const std::uint32_t value) {
+      Entry &entry = m_entries[(pc >> 2) & m_mask];
+      m_loads++;
+      if (!entry.valid || entry.pc != pc) {
+        entry.valid = true;
+        entry.pc = pc;
+        entry.last = value;
+        entry.stride = 0;
+        entry.confidence = 0;
+        return;
+      }
+      if (entry.last + entry.stride == value) {
+        entry.confidence += (entry.confidence < 3) ? 1 : 0;
+      } else {
+        entry.confidence = 0;
+        entry.stride = m_stride ? value - entry.last : 0;
+      }
+      entry.last = value;
+    }
+    // a predicted load was checked in MEM; `used' if its value reached a dependent instruction in place
+    // of a load-use bubble (a wrong one is replayed)
+    void verified(const bool correct, const bool used) {
+      m_predictions++;
+      m_correct += correct ? 1 : 0;
+      m_used += used ? 1 : 0;
+      m_replays += (used && !correct) ? 1 : 0;
+    }
+
+    std::uint64_t getLoads() const { return m_loads; }
+    std::uint64_t getPredictions() const { return m_predictions; }
+    std::uint64_t getCorrect() const { return m_correct; }
+    std::uint64_t getUsed() const { return m_used; }
+    std::uint64_t getReplays() const { return m_replays; }
+    // the loads predicted, and the predictions that were right
+    double coverage() const { return (m_loads > 0) ? (double)m_predictions / m_loads : 0.0; }
+    double accuracy() const { return (m_predictions > 0) ? (double)m_correct / m_predictions : 1.0; }
+  private:
+    struct Entry {
+      bool valid;
+      std::uint32_t pc;
+      std::uint32_t last;
+      std::uint32_t stride;
+      std::uint8_t confidence;
+    };
+    bool m_stride;
+    std::vector<Entry> m_entries;
+    std::uint32_t m_mask;
+    std::uint64_t m_loads;
+    std::uint64_t m_predictions;
+    std::uint64_t m_correct;
+    std::uint64_t m_used;
+    std::uint64_t m_replays;
+};
+
+#endif
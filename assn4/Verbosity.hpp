@@ -0,0 +1,14 @@
+#ifndef __VERBOSITY_HPP__
+#define __VERBOSITY_HPP__
+
+/*******************************************************************/
+/* quietMode                                                       */
+/*   - When set, the INFO messages of the simulator are suppressed */
+/*     (e.g., while benchmarking); warnings and errors still print */
+/*******************************************************************/
+inline bool &quietMode() {
+  static bool quiet = false;
+  return quiet;
+}
+
+#endif
@@ -0,0 +1,909 @@
+#include "DualIssueCPU.hpp"
+#include "OutOfOrderCPU.hpp"
+#include "PipelinedCPU.hpp"
+#include "SingleCycleCPU.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Each workload is a triplet of images `<prefix>_{regFile,instMemFile,dataMemFile}'. The workloads
+// that end with an exit syscall are run to completion and their final state is checked against
+// SingleCycleCPU; the assn4/tests programs have no exit and run for the cycles of their reference
+// outputs.
+struct Workload {
+  const char *name;
+  std::uint32_t initialPC;
+  const char *prefix;
+  unsigned long long maxCycles;
+  bool untilExit;
+};
+
+static const Workload s_suite[] = {
+  { "ex1",       0x0000, "tests/ex1",           16,       false },
+  { "ex2",       0x0000, "tests/ex2",           20,       false },
+  { "ex3",       0x0000, "tests/ex3",           15,       false },
+  { "ex4",       0x1000, "tests/ex4",           12,       false },
+  { "fibonacci", 0x0000, "workloads/fibonacci", 10000000, true },
+  { "findindex", 0x0000, "workloads/findindex", 10000000, true },
+  { "lcm",       0x0000, "workloads/lcm",       10000000, true },
+  { "lcmdiv",    0x0000, "workloads/lcmdiv",    10000000, true },
+  { "quicksort", 0x0000, "workloads/quicksort", 10000000, true },
+  { "memcpy",    0x0000, "workloads/memcpy",    10000000, true },
+  { "matmul",    0x0000, "workloads/matmul",    10000000, true },
+  { "mergesort", 0x0000, "workloads/mergesort", 10000000, true },
+};
+
+// a CPU to run the workloads on: SingleCycleCPU on the padded images unless the setters below say otherwise,
+// so each row of a study sets only what it changes, e.g.,
+// Config("PipelinedCPU(gshare)").setPipelined().setPredictor("gshare").setImages("nopad")
+struct Config {
+  explicit Config(const char *name)
+    : name(name), pipelined(false), enableDataForwarding(false), enableHazardDetection(false), predictor(nullptr),
+      images(nullptr), earlyBranch(false), delaySlot(false), fetchQueue(0), instMemLatency(1), loopBuffer(0),
+      storeDataForwarding(false), valuePredictor(nullptr), multiplier(nullptr), divider(nullptr), dualIssue(false),
+      outOfOrder(nullptr), dataMemLatency(1), dataCache(nullptr) { }
+  Config &setPipelined(const bool forwarding = true, const bool hazardDetection = true) {
+    pipelined = true;
+    enableDataForwarding = forwarding;
+    enableHazardDetection = hazardDetection;
+    return *this;
+  }
+  Config &setPredictor(const char *spec) { predictor = spec; return *this; }
+  Config &setImages(const char *directory) { images = directory; return *this; }
+  Config &setEarlyBranch() { earlyBranch = true; return *this; }
+  Config &setDelaySlot() { delaySlot = true; return *this; }
+  Config &setFetchQueue(const unsigned entries) { fetchQueue = entries; return *this; }
+  Config &setInstMemLatency(const unsigned cycles) { instMemLatency = cycles; return *this; }
+  Config &setLoopBuffer(const unsigned entries) { loopBuffer = entries; return *this; }
+  Config &setStoreDataForwarding() { storeDataForwarding = true; return *this; }
+  Config &setValuePredictor(const char *spec) { valuePredictor = spec; return *this; }
+  Config &setMultiplier(const char *timing) { multiplier = timing; return *this; }
+  Config &setDivider(const char *timing) { divider = timing; return *this; }
+  Config &setDualIssue() { dualIssue = true; return *this; }
+  Config &setOutOfOrder(const char *window) { outOfOrder = window; return *this; }
+  Config &setDataMemLatency(const unsigned cycles) { dataMemLatency = cycles; return *this; }
+  Config &setDataCache(const char *spec) { dataCache = spec; return *this; }
+
+  const char *name;
+  bool pipelined;
+  bool enableDataForwarding;
+  bool enableHazardDetection;
+  const char *predictor; // see BranchPredictor::create; nullptr = no prediction, no flush
+  const char *images;    // the workloads/ subdirectory of the images (see the Makefile); nullptr: workloads/
+  bool earlyBranch;      // resolve the branches in ID (see PipelinedCPU::enableEarlyBranchResolution)
+  bool delaySlot;        // see PipelinedCPU::enableDelaySlot
+  unsigned fetchQueue;   // entries of the fetch queue (see PipelinedCPU::enableFetchQueue); 0: the IF-ID latch
+  unsigned instMemLatency; // see PipelinedCPU::setInstMemLatency
+  unsigned loopBuffer;   // entries of the loop buffer (see PipelinedCPU::enableLoopBuffer); 0: none
+  bool storeDataForwarding; // see PipelinedCPU::enableStoreDataForwarding
+  const char *valuePredictor; // see LoadValuePredictor::create; nullptr = a load-use hazard always stalls
+  const char *multiplier; // see PipelinedCPU::setMultiplier and MulDivUnit::parseTiming; nullptr = 1 cycle
+  const char *divider;    // see PipelinedCPU::setDivider; nullptr = 1 cycle
+  bool dualIssue;         // DualIssueCPU in place of PipelinedCPU (only the forwarding, the hazard detection
+                          // and the multiplier/divider apply)
+  const char *outOfOrder; // OutOfOrderCPU with this window (see OutOfOrderCPU::parseWindow) in place of
+                          // PipelinedCPU (only the predictor and the multiplier/divider apply); nullptr: none
+  unsigned dataMemLatency; // see PipelinedCPU::setDataMemLatency
+  const char *dataCache;   // see DataCache::create; nullptr: MEM reads the data memory directly
+};
+
+static const Config s_configs[] = {
+  Config("SingleCycleCPU"),
+  Config("PipelinedCPU(fwd=0,hdu=0)").setPipelined(false, false),
+  Config("PipelinedCPU(fwd=0,hdu=1)").setPipelined(false, true),
+  Config("PipelinedCPU(fwd=1,hdu=0)").setPipelined(true, false),
+  Config("PipelinedCPU(fwd=1,hdu=1)").setPipelined(),
+};
+
+// the studies compare each config against the first pipelined one (the baseline)
+// -P: the branch predictors against the padded (no flush) pipeline
+static const Config s_branchConfigs[] = {
+  Config("SingleCycleCPU(nopad)").setImages("nopad"),
+  Config("PipelinedCPU(padded)").setPipelined(),
+  Config("PipelinedCPU(nt)").setPipelined().setPredictor("nt").setImages("nopad"),
+  Config("PipelinedCPU(btfn)").setPipelined().setPredictor("btfn").setImages("nopad"),
+  Config("PipelinedCPU(bimodal)").setPipelined().setPredictor("bimodal").setImages("nopad"),
+  Config("PipelinedCPU(gshare)").setPipelined().setPredictor("gshare").setImages("nopad"),
+};
+
+// -E: the branches resolved in ID against MEM, with and without a dynamic predictor
+static const Config s_earlyBranchConfigs[] = {
+  Config("SingleCycleCPU(nopad)").setImages("nopad"),
+  Config("PipelinedCPU(mem,nt)").setPipelined().setPredictor("nt").setImages("nopad"),
+  Config("PipelinedCPU(id,nt)").setPipelined().setPredictor("nt").setImages("nopad").setEarlyBranch(),
+  Config("PipelinedCPU(mem,gshare)").setPipelined().setPredictor("gshare").setImages("nopad"),
+  Config("PipelinedCPU(id,gshare)").setPipelined().setPredictor("gshare").setImages("nopad").setEarlyBranch(),
+};
+
+// -D: a delay slot (a nop, or filled by mipsasm -f) against flushing the fetch after a taken branch
+static const Config s_delaySlotConfigs[] = {
+  Config("SingleCycleCPU(nopad)").setImages("nopad"),
+  Config("PipelinedCPU(id,flush)").setPipelined().setImages("nopad").setEarlyBranch(),
+  Config("PipelinedCPU(id,slot=nop)").setPipelined().setImages("slot").setEarlyBranch().setDelaySlot(),
+  Config("PipelinedCPU(id,slot=filled)").setPipelined().setImages("filled").setEarlyBranch().setDelaySlot(),
+};
+
+// -F: a decoupled front end (fetch queue) against the IF-ID latch, as the instruction memory slows down
+// (bimodal: gshare indexes with the history at resolve time, which lags further behind the fetch when IF
+// runs ahead, and would mix its accuracy loss into the comparison)
+static const Config s_fetchQueueConfigs[] = {
+  Config("SingleCycleCPU(nopad)").setImages("nopad"),
+  Config("PipelinedCPU(latch,imem=1)").setPipelined().setPredictor("bimodal").setImages("nopad"),
+  Config("PipelinedCPU(queue=8,imem=1)").setPipelined().setPredictor("bimodal").setImages("nopad").setFetchQueue(8),
+  Config("PipelinedCPU(latch,imem=2)").setPipelined().setPredictor("bimodal").setImages("nopad").setInstMemLatency(2),
+  Config("PipelinedCPU(queue=4,imem=2)").setPipelined().setPredictor("bimodal").setImages("nopad").setFetchQueue(4)
+      .setInstMemLatency(2),
+  Config("PipelinedCPU(queue=8,imem=2)").setPipelined().setPredictor("bimodal").setImages("nopad").setFetchQueue(8)
+      .setInstMemLatency(2),
+  Config("PipelinedCPU(latch,imem=4)").setPipelined().setPredictor("bimodal").setImages("nopad").setInstMemLatency(4),
+  Config("PipelinedCPU(queue=4,imem=4)").setPipelined().setPredictor("bimodal").setImages("nopad").setFetchQueue(4)
+      .setInstMemLatency(4),
+  Config("PipelinedCPU(queue=8,imem=4)").setPipelined().setPredictor("bimodal").setImages("nopad").setFetchQueue(8)
+      .setInstMemLatency(4),
+  Config("PipelinedCPU(queue=16,imem=4)").setPipelined().setPredictor("bimodal").setImages("nopad").setFetchQueue(16)
+      .setInstMemLatency(4),
+};
+
+// -U: a loop buffer against fetching every instruction from the instruction memory (the simulator also
+// skips the decode of the buffered instructions: the host time is against the config above without one)
+static const Config s_loopBufferConfigs[] = {
+  Config("SingleCycleCPU(nopad)").setImages("nopad"),
+  Config("PipelinedCPU(latch,imem=1)").setPipelined().setPredictor("bimodal").setImages("nopad"),
+  Config("PipelinedCPU(loop=8,imem=1)").setPipelined().setPredictor("bimodal").setImages("nopad").setLoopBuffer(8),
+  Config("PipelinedCPU(loop=16,imem=1)").setPipelined().setPredictor("bimodal").setImages("nopad").setLoopBuffer(16),
+  Config("PipelinedCPU(loop=64,imem=1)").setPipelined().setPredictor("bimodal").setImages("nopad").setLoopBuffer(64),
+  Config("PipelinedCPU(latch,imem=2)").setPipelined().setPredictor("bimodal").setImages("nopad").setInstMemLatency(2),
+  Config("PipelinedCPU(loop=16,imem=2)").setPipelined().setPredictor("bimodal").setImages("nopad")
+      .setInstMemLatency(2).setLoopBuffer(16),
+  Config("PipelinedCPU(queue=8,imem=2)").setPipelined().setPredictor("bimodal").setImages("nopad").setFetchQueue(8)
+      .setInstMemLatency(2),
+  Config("PipelinedCPU(queue=8,loop=16,imem=2)").setPipelined().setPredictor("bimodal").setImages("nopad")
+      .setFetchQueue(8).setInstMemLatency(2).setLoopBuffer(16),
+};
+
+// -S: forwarding a loaded value to the store data in MEM against waiting for it in ID, with and without
+// the branch padding
+static const Config s_storeDataConfigs[] = {
+  Config("SingleCycleCPU"),
+  Config("PipelinedCPU(padded)").setPipelined(),
+  Config("PipelinedCPU(padded,store)").setPipelined().setStoreDataForwarding(),
+  Config("PipelinedCPU(bimodal)").setPipelined().setPredictor("bimodal").setImages("nopad"),
+  Config("PipelinedCPU(bimodal,store)").setPipelined().setPredictor("bimodal").setImages("nopad")
+      .setStoreDataForwarding(),
+};
+
+// -V: the load value predictors against the load-use stall, with and without the branch padding
+static const Config s_valueConfigs[] = {
+  Config("SingleCycleCPU"),
+  Config("PipelinedCPU(padded)").setPipelined(),
+  Config("PipelinedCPU(padded,last)").setPipelined().setValuePredictor("last"),
+  Config("PipelinedCPU(padded,stride)").setPipelined().setValuePredictor("stride"),
+  Config("PipelinedCPU(stride,store)").setPipelined().setStoreDataForwarding().setValuePredictor("stride"),
+  Config("PipelinedCPU(bimodal)").setPipelined().setPredictor("bimodal").setImages("nopad"),
+  Config("PipelinedCPU(bimodal,stride)").setPipelined().setPredictor("bimodal").setImages("nopad")
+      .setValuePredictor("stride"),
+};
+
+// -M: the multiplier/divider timings against a single-cycle unit (the workloads without mult/div stay as they are)
+static const Config s_mulDivConfigs[] = {
+  Config("SingleCycleCPU"),
+  Config("PipelinedCPU(mul=1,div=1)").setPipelined(),
+  Config("PipelinedCPU(mul=4p,div=32)").setPipelined().setMultiplier("4p").setDivider("32"),
+  Config("PipelinedCPU(mul=4,div=32)").setPipelined().setMultiplier("4").setDivider("32"),
+  Config("PipelinedCPU(mul=4p,div=16)").setPipelined().setMultiplier("4p").setDivider("16"),
+  Config("PipelinedCPU(mul=32,div=32)").setPipelined().setMultiplier("32").setDivider("32"),
+  Config("PipelinedCPU(bimodal,1,1)").setPipelined().setPredictor("bimodal").setImages("nopad"),
+  Config("PipelinedCPU(bimodal,4p,32)").setPipelined().setPredictor("bimodal").setImages("nopad").setMultiplier("4p")
+      .setDivider("32"),
+};
+
+// -I: the dual-issue CPU against the scalar pipeline that flushes the same way (nt), and both running the
+// padding nops instead
+static const Config s_dualIssueConfigs[] = {
+  Config("SingleCycleCPU(nopad)").setImages("nopad"),
+  Config("PipelinedCPU(nt)").setPipelined().setPredictor("nt").setImages("nopad"),
+  Config("PipelinedCPU(padded)").setPipelined(),
+  Config("PipelinedCPU(bimodal)").setPipelined().setPredictor("bimodal").setImages("nopad"),
+  Config("DualIssueCPU(nt)").setPipelined().setImages("nopad").setDualIssue(),
+  Config("DualIssueCPU(padded)").setPipelined().setDualIssue(),
+  Config("PipelinedCPU(nt,4p,32)").setPipelined().setPredictor("nt").setImages("nopad").setMultiplier("4p")
+      .setDivider("32"),
+  Config("DualIssueCPU(nt,4p,32)").setPipelined().setImages("nopad").setMultiplier("4p").setDivider("32")
+      .setDualIssue(),
+};
+
+// -O: the out-of-order CPU from 1 to 8 wide against the scalar and the dual-issue pipelines; its windows are
+// "width:rob:rs:lsq"
+static const Config s_outOfOrderConfigs[] = {
+  Config("SingleCycleCPU(nopad)").setImages("nopad"),
+  Config("PipelinedCPU(bimodal)").setPipelined().setPredictor("bimodal").setImages("nopad"),
+  Config("DualIssueCPU(nt)").setPipelined().setImages("nopad").setDualIssue(),
+  Config("OutOfOrderCPU(1w,nt)").setPipelined().setImages("nopad").setOutOfOrder("1:16:8:8"),
+  Config("OutOfOrderCPU(1w,bimodal)").setPipelined().setPredictor("bimodal").setImages("nopad")
+      .setOutOfOrder("1:16:8:8"),
+  Config("OutOfOrderCPU(2w,nt)").setPipelined().setImages("nopad").setOutOfOrder("2:32:16:16"),
+  Config("OutOfOrderCPU(2w,bimodal)").setPipelined().setPredictor("bimodal").setImages("nopad")
+      .setOutOfOrder("2:32:16:16"),
+  Config("OutOfOrderCPU(4w,bimodal)").setPipelined().setPredictor("bimodal").setImages("nopad")
+      .setOutOfOrder("4:64:32:16"),
+  Config("OutOfOrderCPU(8w,bimodal)").setPipelined().setPredictor("bimodal").setImages("nopad")
+      .setOutOfOrder("8:128:64:32"),
+  Config("PipelinedCPU(bimodal,4p,32)").setPipelined().setPredictor("bimodal").setImages("nopad").setMultiplier("4p")
+      .setDivider("32"),
+  Config("OutOfOrderCPU(4w,bimodal,4p,32)").setPipelined().setPredictor("bimodal").setImages("nopad")
+      .setMultiplier("4p").setDivider("32").setOutOfOrder("4:64:32:16"),
+};
+
+// -C: the L1 data cache (see DataCache::create) against an ideal data memory, and a 20-cycle memory without
+// it (a miss takes 20 cycles); the sizes, associativities, replacements and write policies
+static const Config s_dataCacheConfigs[] = {
+  Config("SingleCycleCPU(nopad)").setImages("nopad"),
+  Config("PipelinedCPU(bimodal)").setPipelined().setPredictor("bimodal").setImages("nopad"),
+  Config("PipelinedCPU(bimodal,mem=20)").setPipelined().setPredictor("bimodal").setImages("nopad")
+      .setDataMemLatency(20),
+  Config("PipelinedCPU(bimodal,D$=lru:8k:2:32)").setPipelined().setPredictor("bimodal").setImages("nopad")
+      .setDataCache("lru"),
+  Config("PipelinedCPU(bimodal,D$=lru:1k:1:16)").setPipelined().setPredictor("bimodal").setImages("nopad")
+      .setDataCache("lru:1024:1:16"),
+  Config("PipelinedCPU(bimodal,D$=lru:1k:4:16)").setPipelined().setPredictor("bimodal").setImages("nopad")
+      .setDataCache("lru:1024:4:16"),
+  Config("PipelinedCPU(bimodal,D$=plru:1k:4:16)").setPipelined().setPredictor("bimodal").setImages("nopad")
+      .setDataCache("plru:1024:4:16"),
+  Config("PipelinedCPU(bimodal,D$=random:1k:4:16)").setPipelined().setPredictor("bimodal").setImages("nopad")
+      .setDataCache("random:1024:4:16"),
+  Config("PipelinedCPU(bimodal,D$=lru:1k:4:16,wt)").setPipelined().setPredictor("bimodal").setImages("nopad")
+      .setDataCache("lru:1024:4:16,wt"),
+  Config("PipelinedCPU(bimodal,D$=lru:1k:4:16,nwa)").setPipelined().setPredictor("bimodal").setImages("nopad")
+      .setDataCache("lru:1024:4:16,nwa"),
+  Config("PipelinedCPU(bimodal,D$=lru:32k:4:64)").setPipelined().setPredictor("bimodal").setImages("nopad")
+      .setDataCache("lru:32768:4:64"),
+};
+
+// what a child process reports back about a single run
+struct RunResult {
+  bool crashed;
+  bool halted;
+  int exitCode;
+  unsigned long long cycles;
+  unsigned long long instructions;
+  double wallSeconds;                // the average of the timed runs
+  unsigned iterations;               // the runs on fresh CPUs that were timed
+  bool timed;                        // they added up to the minimum time (see simulate)
+  std::uint64_t digest;
+  unsigned long long branches;       // resolved by the branch predictor (0 without one)
+  unsigned long long mispredictions;
+  double fetchQueueOccupancy;        // the average queued instructions (0 without a fetch queue)
+  double fetchQueueEmpty;            // the fractions of the cycles the queue ended empty, full
+  double fetchQueueFull;
+  unsigned long long loopBufferFetches; // the fetches served by the loop buffer (0 without one)
+  unsigned long long loopBufferDecodes; // the decodes it saved
+  unsigned long long loopsCaptured;
+  unsigned long long valueLoads;       // the loads the value predictor saw (0 without one)
+  unsigned long long valuePredictions; // the loads it predicted, and the right ones
+  unsigned long long valueCorrect;
+  unsigned long long valueUsed;        // the predictions a dependent instruction took in place of a bubble
+  unsigned long long valueReplays;     // the used ones that were wrong
+  unsigned long long multiplies;       // the operations issued to the multiplier and the divider
+  unsigned long long divides;
+  unsigned long long mulDivResultStalls; // the cycles an mfhi/mflo waited for HI/LO in ID
+  unsigned long long mulDivBusyStalls;   // the cycles a mult/div waited for its unit in ID
+  unsigned long long issueCycles[3];     // the cycles the dual-issue CPU issued 0, 1, 2 instructions
+  unsigned long long pairLimits[DualIssueCPU::NUM_PAIR_LIMITS]; // the cycles it issued one, by the reason
+  double windowOccupancy[OutOfOrderCPU::NUM_WINDOWS]; // the average entries of the out-of-order CPU in use
+  unsigned long long windowFull[OutOfOrderCPU::NUM_WINDOWS]; // the cycles a full window stopped its dispatch
+  unsigned long long squashed;           // the instructions it squashed after a wrong prediction
+  unsigned long long cdbConflicts;       // the results that waited for a CDB slot
+  unsigned long long cacheAccesses;      // the loads and stores the data cache saw (0 without one)
+  unsigned long long cacheHits;
+  unsigned long long cacheMisses[DataCache::NUM_MISS_TYPES];
+  unsigned long long writebacks;         // the dirty blocks it wrote back
+  unsigned long long memoryWrites;       // the stores it wrote through to memory
+  unsigned long long dataStallCycles;    // the cycles the pipeline held for the data memory
+};
+
+static double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static CPU *createCPU(const Workload &workload, const Config &config) {
+  std::string prefix(workload.prefix);
+  if (config.images != nullptr) {
+    size_t slash = prefix.rfind('/');
+    prefix.insert((slash == std::string::npos) ? 0 : slash + 1, std::string(config.images) + "/");
+  }
+  std::string regFileName = prefix + "_regFile";
+  std::string instMemFileName = prefix + "_instMemFile";
+  std::string dataMemFileName = prefix + "_dataMemFile";
+
+  CPU *cpu;
+  unsigned cycles;
+  bool pipelined;
+  if (config.outOfOrder != nullptr) {
+    unsigned width = 2, robEntries = 32, rsEntries = 16, lsqEntries = 16;
+    OutOfOrderCPU::parseWindow(config.outOfOrder, &width, &robEntries, &rsEntries, &lsqEntries);
+    cpu = new OutOfOrderCPU(workload.initialPC - 4, regFileName.c_str(), instMemFileName.c_str(),
+                            dataMemFileName.c_str(), width, robEntries, rsEntries, lsqEntries);
+    if (config.predictor != nullptr) {
+      static_cast<OutOfOrderCPU *>(cpu)->setBranchPredictor(BranchPredictor::create(config.predictor));
+    }
+    if (config.multiplier != nullptr && MulDivUnit::parseTiming(config.multiplier, &cycles, &pipelined)) {
+      static_cast<OutOfOrderCPU *>(cpu)->setMultiplier(cycles, pipelined);
+    }
+    if (config.divider != nullptr && MulDivUnit::parseTiming(config.divider, &cycles, &pipelined)) {
+      static_cast<OutOfOrderCPU *>(cpu)->setDivider(cycles, pipelined);
+    }
+  } else if (config.dualIssue) {
+    cpu = new DualIssueCPU(workload.initialPC - 4, regFileName.c_str(), instMemFileName.c_str(),
+                           dataMemFileName.c_str(), config.enableDataForwarding, config.enableHazardDetection);
+    if (config.multiplier != nullptr && MulDivUnit::parseTiming(config.multiplier, &cycles, &pipelined)) {
+      static_cast<DualIssueCPU *>(cpu)->setMultiplier(cycles, pipelined);
+    }
+    if (config.divider != nullptr && MulDivUnit::parseTiming(config.divider, &cycles, &pipelined)) {
+      static_cast<DualIssueCPU *>(cpu)->setDivider(cycles, pipelined);
+    }
+  } else if (config.pipelined) {
+    // the pipelined CPU adds 4 to the PC before fetching (see testPipelinedCPU)
+    cpu = new PipelinedCPU(workload.initialPC - 4, regFileName.c_str(), instMemFileName.c_str(),
+                           dataMemFileName.c_str(), config.enableDataForwarding,
+                           config.enableHazardDetection);
+    if (config.predictor != nullptr) {
+      static_cast<PipelinedCPU *>(cpu)->setBranchPredictor(BranchPredictor::create(config.predictor));
+    }
+    if (config.earlyBranch) {
+      static_cast<PipelinedCPU *>(cpu)->enableEarlyBranchResolution();
+    }
+    if (config.delaySlot) {
+      static_cast<PipelinedCPU *>(cpu)->enableDelaySlot();
+    }
+    if (config.fetchQueue > 0) {
+      static_cast<PipelinedCPU *>(cpu)->enableFetchQueue(config.fetchQueue);
+    }
+    static_cast<PipelinedCPU *>(cpu)->setInstMemLatency(config.instMemLatency);
+    static_cast<PipelinedCPU *>(cpu)->setDataMemLatency(config.dataMemLatency);
+    if (config.dataCache != nullptr) {
+      static_cast<PipelinedCPU *>(cpu)->setDataCache(DataCache::create(config.dataCache));
+    }
+    if (config.loopBuffer > 0) {
+      static_cast<PipelinedCPU *>(cpu)->enableLoopBuffer(config.loopBuffer);
+    }
+    if (config.storeDataForwarding) {
+      static_cast<PipelinedCPU *>(cpu)->enableStoreDataForwarding();
+    }
+    if (config.valuePredictor != nullptr) {
+      static_cast<PipelinedCPU *>(cpu)->setLoadValuePredictor(LoadValuePredictor::create(config.valuePredictor));
+    }
+    if (config.multiplier != nullptr && MulDivUnit::parseTiming(config.multiplier, &cycles, &pipelined)) {
+      static_cast<PipelinedCPU *>(cpu)->setMultiplier(cycles, pipelined);
+    }
+    if (config.divider != nullptr && MulDivUnit::parseTiming(config.divider, &cycles, &pipelined)) {
+      static_cast<PipelinedCPU *>(cpu)->setDivider(cycles, pipelined);
+    }
+  } else {
+    cpu = new SingleCycleCPU(workload.initialPC, regFileName.c_str(), instMemFileName.c_str(),
+                             dataMemFileName.c_str());
+  }
+  return cpu;
+}
+
+// returns the wall time of running the workload to its end (the construction of the CPU is not timed)
+static double timeRun(CPU *cpu, const Workload &workload) {
+  double start = now();
+  while (cpu->getCurrCycle() < workload.maxCycles && !cpu->isHalted()) {
+    cpu->advanceCycle();
+  }
+  return now() - start;
+}
+
+// at most this many times the minimum time goes to reaching it (constructing a CPU zeroes 64 MB of memory,
+// about 0.1 s, so a workload that finishes in microseconds can never add up to it)
+static const double TIMING_BUDGET = 20.0;
+
+// Runs the workload on fresh CPUs until the timed runs add up to `minSeconds', so that the clock is not read
+// around a few microseconds. A workload that would need more than TIMING_BUDGET * minSeconds of constructions
+// and runs to get there stops after the runs it already had and is reported as untimed: the regression check
+// compares it on its cycles only.
+static RunResult simulate(const Workload &workload, const Config &config, const double minSeconds) {
+  const double begin = now();
+  CPU *cpu = createCPU(workload, config);
+  double seconds = timeRun(cpu, workload);
+
+  RunResult result;
+  result.iterations = 1;
+  result.crashed = false;
+  result.halted = cpu->isHalted();
+  result.exitCode = cpu->exitCode();
+  result.cycles = cpu->getCurrCycle();
+  result.instructions = cpu->getNumRetired();
+  result.digest = cpu->stateDigest();
+  result.branches = result.mispredictions = 0;
+  if (config.predictor != nullptr) {
+    const BranchPredictor *predictor = (config.outOfOrder != nullptr)
+                                       ? static_cast<OutOfOrderCPU *>(cpu)->getBranchPredictor()
+                                       : static_cast<PipelinedCPU *>(cpu)->getBranchPredictor();
+    result.branches = predictor->getBranches();
+    result.mispredictions = predictor->getMispredictions();
+  }
+  result.fetchQueueOccupancy = result.fetchQueueEmpty = result.fetchQueueFull = 0;
+  if (config.fetchQueue > 0) {
+    const FetchQueue *queue = static_cast<PipelinedCPU *>(cpu)->getFetchQueue();
+    result.fetchQueueOccupancy = queue->averageOccupancy();
+    result.fetchQueueEmpty = queue->emptyFraction();
+    result.fetchQueueFull = queue->fullFraction();
+  }
+  result.loopBufferFetches = result.loopBufferDecodes = result.loopsCaptured = 0;
+  if (config.loopBuffer > 0) {
+    const LoopBuffer *loopBuffer = static_cast<PipelinedCPU *>(cpu)->getLoopBuffer();
+    result.loopBufferFetches = loopBuffer->getFetchesServed();
+    result.loopBufferDecodes = loopBuffer->getDecodesSkipped();
+    result.loopsCaptured = loopBuffer->getLoopsCaptured();
+  }
+  result.valueLoads = result.valuePredictions = result.valueCorrect = result.valueUsed = result.valueReplays = 0;
+  if (config.valuePredictor != nullptr) {
+    const LoadValuePredictor *predictor = static_cast<PipelinedCPU *>(cpu)->getLoadValuePredictor();
+    result.valueLoads = predictor->getLoads();
+    result.valuePredictions = predictor->getPredictions();
+    result.valueCorrect = predictor->getCorrect();
+    result.valueUsed = predictor->getUsed();
+    result.valueReplays = predictor->getReplays();
+  }
+  result.multiplies = result.divides = result.mulDivResultStalls = result.mulDivBusyStalls = 0;
+  if (config.pipelined) {
+    const MulDivUnit &unit = (config.outOfOrder != nullptr) ? static_cast<OutOfOrderCPU *>(cpu)->getMulDivUnit()
+                             : config.dualIssue ? static_cast<DualIssueCPU *>(cpu)->getMulDivUnit()
+                             : static_cast<PipelinedCPU *>(cpu)->getMulDivUnit();
+    result.multiplies = unit.getIssued(false);
+    result.divides = unit.getIssued(true);
+    result.mulDivResultStalls = unit.getResultStalls();
+    result.mulDivBusyStalls = unit.getBusyStalls();
+  }
+  memset(result.issueCycles, 0, sizeof(result.issueCycles));
+  memset(result.pairLimits, 0, sizeof(result.pairLimits));
+  if (config.dualIssue) {
+    const DualIssueCPU *dual = static_cast<DualIssueCPU *>(cpu);
+    for (unsigned n = 0; n < 3; n++) {
+      result.issueCycles[n] = dual->getIssueCycles(n);
+    }
+    for (int limit = 0; limit < DualIssueCPU::NUM_PAIR_LIMITS; limit++) {
+      result.pairLimits[limit] = dual->getPairLimits(limit);
+    }
+  }
+  memset(result.windowOccupancy, 0, sizeof(result.windowOccupancy));
+  memset(result.windowFull, 0, sizeof(result.windowFull));
+  result.squashed = result.cdbConflicts = 0;
+  if (config.outOfOrder != nullptr) {
+    const OutOfOrderCPU *ooo = static_cast<OutOfOrderCPU *>(cpu);
+    for (int window = 0; window < OutOfOrderCPU::NUM_WINDOWS; window++) {
+      result.windowOccupancy[window] = ooo->averageOccupancy(window);
+      result.windowFull[window] = ooo->getFullCycles(window);
+    }
+    result.squashed = ooo->getSquashed();
+    result.cdbConflicts = ooo->getCDBConflicts();
+  }
+  result.cacheAccesses = result.cacheHits = result.writebacks = result.memoryWrites = result.dataStallCycles = 0;
+  memset(result.cacheMisses, 0, sizeof(result.cacheMisses));
+  if (config.pipelined && !config.dualIssue && config.outOfOrder == nullptr) {
+    result.dataStallCycles = static_cast<PipelinedCPU *>(cpu)->getDataPort().getBusyCycles();
+  }
+  if (config.dataCache != nullptr) {
+    const DataCache *cache = static_cast<PipelinedCPU *>(cpu)->getDataCache();
+    result.cacheAccesses = cache->getAccesses();
+    result.cacheHits = cache->getHits(false) + cache->getHits(true);
+    for (int type = 0; type < DataCache::NUM_MISS_TYPES; type++) {
+      result.cacheMisses[type] = cache->getMisses((DataCache::MissType)type);
+    }
+    result.writebacks = cache->getWritebacks();
+    result.memoryWrites = cache->getMemoryWrites();
+  }
+  delete cpu;
+
+  // the simulation is deterministic: the other runs only add to the time
+  while (seconds < minSeconds && seconds > 0) {
+    const double perIteration = (now() - begin) / result.iterations;
+    const double needed = std::ceil((minSeconds - seconds) / (seconds / result.iterations));
+    if (now() - begin + needed * perIteration > TIMING_BUDGET * minSeconds) {
+      break;
+    }
+    cpu = createCPU(workload, config);
+    seconds += timeRun(cpu, workload);
+    delete cpu;
+    result.iterations++;
+  }
+  result.timed = (seconds >= minSeconds);
+  result.wallSeconds = seconds / result.iterations;
+  return result;
+}
+
+// Runs the simulation in a child process, so that a configuration that derails the program
+// (e.g., no forwarding) cannot take the whole benchmark down, and each run starts from a fresh heap.
+static RunResult run(const Workload &workload, const Config &config, const double minSeconds) {
+  RunResult result;
+  memset(&result, 0, sizeof(result));
+  result.crashed = true;
+
+  int fds[2];
+  if (pipe(fds) != 0) {
+    perror("pipe");
+    return result;
+  }
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    quietMode() = true;
+    if (freopen("/dev/null", "w", stdout) == NULL) { _exit(1); } // the program's own output
+    RunResult childResult = simulate(workload, config, minSeconds);
+    ssize_t written = write(fds[1], &childResult, sizeof(childResult));
+    _exit(written == (ssize_t)sizeof(childResult) ? 0 : 1);
+  }
+  close(fds[1]);
+  if (pid > 0) {
+    RunResult childResult;
+    if (read(fds[0], &childResult, sizeof(childResult)) == (ssize_t)sizeof(childResult)) {
+      result = childResult;
+    }
+    waitpid(pid, nullptr, 0);
+  }
+  close(fds[0]);
+  return result;
+}
+
+static std::string runKey(const std::string &workload, const std::string &config) {
+  return workload + " / " + config;
+}
+
+// what the regression check compares a run with
+struct BaselineRun {
+  double cyclesPerSecond;
+  unsigned long long cycles;
+  bool timed; // false in the files written before the runs were looped up to a minimum time
+};
+
+// Reads the `cyclesPerSecond', `cycles' and `timed' of each run from a JSON file written by this program
+// (one run per line).
+static bool readBaseline(const char *fileName, std::map<std::string, BaselineRun> *baseline) {
+  FILE *file = fopen(fileName, "r");
+  if (file == NULL) {
+    fprintf(stderr, "ERROR: cannot open the baseline `%s'\n", fileName);
+    return false;
+  }
+  char line[4096];
+  while (fgets(line, sizeof(line), file) != NULL) {
+    char workload[256], config[256];
+    const char *w = strstr(line, "\"workload\": \"");
+    const char *c = strstr(line, "\"config\": \"");
+    const char *cps = strstr(line, "\"cyclesPerSecond\": ");
+    const char *cycles = strstr(line, "\"cycles\": ");
+    const char *timed = strstr(line, "\"timed\": ");
+    if (w == NULL || c == NULL || cps == NULL || cycles == NULL
+        || sscanf(w, "\"workload\": \"%255[^\"]\"", workload) != 1
+        || sscanf(c, "\"config\": \"%255[^\"]\"", config) != 1) {
+      continue;
+    }
+    BaselineRun &run = (*baseline)[runKey(workload, config)];
+    run.cyclesPerSecond = atof(cps + strlen("\"cyclesPerSecond\": "));
+    run.cycles = strtoull(cycles + strlen("\"cycles\": "), nullptr, 10);
+    run.timed = (timed != NULL && strncmp(timed + strlen("\"timed\": "), "true", 4) == 0);
+  }
+  fclose(file);
+  return true;
+}
+
+// the median of the repetitions, so that one run slowed down by the host does not move the result
+static double median(std::vector<double> samples) {
+  std::sort(samples.begin(), samples.end());
+  const size_t n = samples.size();
+  return (n % 2 == 1) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+}
+
+int main(int argc, char **argv) {
+  const char *outputFileName = nullptr;
+  const char *baselineFileName = nullptr;
+  const char *filter = nullptr;
+  double threshold = 0.10;
+  int repetitions = 5;
+  double minSeconds = 0.05;
+  const Config *configs = s_configs;
+  size_t numConfigs = sizeof(s_configs) / sizeof(s_configs[0]);
+  bool study = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "o:b:t:r:m:w:PEDFUSVMIOC")) != -1) {
+    switch (opt) {
+      case 'o': outputFileName = optarg; break;
+      case 'b': baselineFileName = optarg; break;
+      case 't': threshold = atof(optarg); break;
+      case 'r': repetitions = atoi(optarg); break;
+      case 'm': minSeconds = atof(optarg) / 1000; break;
+      case 'w': filter = optarg; break;
+      case 'P':
+        configs = s_branchConfigs;
+        numConfigs = sizeof(s_branchConfigs) / sizeof(s_branchConfigs[0]);
+        study = true;
+        break;
+      case 'E':
+        configs = s_earlyBranchConfigs;
+        numConfigs = sizeof(s_earlyBranchConfigs) / sizeof(s_earlyBranchConfigs[0]);
+        study = true;
+        break;
+      case 'D':
+        configs = s_delaySlotConfigs;
+        numConfigs = sizeof(s_delaySlotConfigs) / sizeof(s_delaySlotConfigs[0]);
+        study = true;
+        break;
+      case 'F':
+        configs = s_fetchQueueConfigs;
+        numConfigs = sizeof(s_fetchQueueConfigs) / sizeof(s_fetchQueueConfigs[0]);
+        study = true;
+        break;
+      case 'U':
+        configs = s_loopBufferConfigs;
+        numConfigs = sizeof(s_loopBufferConfigs) / sizeof(s_loopBufferConfigs[0]);
+        study = true;
+        break;
+      case 'S':
+        configs = s_storeDataConfigs;
+        numConfigs = sizeof(s_storeDataConfigs) / sizeof(s_storeDataConfigs[0]);
+        study = true;
+        break;
+      case 'V':
+        configs = s_valueConfigs;
+        numConfigs = sizeof(s_valueConfigs) / sizeof(s_valueConfigs[0]);
+        study = true;
+        break;
+      case 'M':
+        configs = s_mulDivConfigs;
+        numConfigs = sizeof(s_mulDivConfigs) / sizeof(s_mulDivConfigs[0]);
+        study = true;
+        break;
+      case 'I':
+        configs = s_dualIssueConfigs;
+        numConfigs = sizeof(s_dualIssueConfigs) / sizeof(s_dualIssueConfigs[0]);
+        study = true;
+        break;
+      case 'O':
+        configs = s_outOfOrderConfigs;
+        numConfigs = sizeof(s_outOfOrderConfigs) / sizeof(s_outOfOrderConfigs[0]);
+        study = true;
+        break;
+      case 'C':
+        configs = s_dataCacheConfigs;
+        numConfigs = sizeof(s_dataCacheConfigs) / sizeof(s_dataCacheConfigs[0]);
+        study = true;
+        break;
+      default:
+        fprintf(stderr, "Usage: %s [-o results.json] [-b baseline.json] [-t threshold] [-r repetitions]", argv[0]);
+        fprintf(stderr, " [-m minimum-ms] [-w workload] [-P | -E | -D | -F | -U | -S | -V | -M | -I | -O | -C]\n");
+        fprintf(stderr, "  -r  the median of this many repetitions (default 5), each timed over runs that add up to\n");
+        fprintf(stderr, "      -m milliseconds (default 50); a shorter workload is checked on its cycles only\n");
+        fprintf(stderr, "  -P  compare the branch predictors (needs the workloads/nopad images)\n");
+        fprintf(stderr, "  -E  compare the branches resolved in ID and in MEM (needs the workloads/nopad images)\n");
+        fprintf(stderr, "  -D  compare a delay slot with flushing (needs the workloads/{nopad,slot,filled} images)\n");
+        fprintf(stderr, "  -F  compare a fetch queue with the IF-ID latch under a slow instruction memory (needs the\n");
+        fprintf(stderr, "      workloads/nopad images)\n");
+        fprintf(stderr, "  -U  compare a loop buffer with fetching from the instruction memory (needs the\n");
+        fprintf(stderr, "      workloads/nopad images)\n");
+        fprintf(stderr, "  -S  compare store-data forwarding in MEM with the load-use stall (needs the workloads/nopad\n");
+        fprintf(stderr, "      images)\n");
+        fprintf(stderr, "  -V  compare the load value predictors with the load-use stall (needs the workloads/nopad\n");
+        fprintf(stderr, "      images)\n");
+        fprintf(stderr, "  -M  compare the multiplier/divider timings with a single-cycle unit (needs the\n");
+        fprintf(stderr, "      workloads/nopad images)\n");
+        fprintf(stderr, "  -I  compare the dual-issue CPU with the scalar pipeline (needs the workloads/nopad images)\n");
+        fprintf(stderr, "  -O  compare the out-of-order CPU with the in-order pipelines (needs the workloads/nopad\n");
+        fprintf(stderr, "      images)\n");
+        fprintf(stderr, "  -C  compare the L1 data caches with an ideal and a slow data memory (needs the\n");
+        fprintf(stderr, "      workloads/nopad images)\n");
+        exit(-1);
+    }
+  }
+
+  std::map<std::string, BaselineRun> baseline;
+  if (baselineFileName != nullptr && !readBaseline(baselineFileName, &baseline)) {
+    exit(-1);
+  }
+  FILE *output = stdout;
+  if (outputFileName != nullptr && (output = fopen(outputFileName, "w")) == NULL) {
+    fprintf(stderr, "ERROR: cannot open `%s' for writing\n", outputFileName);
+    exit(-1);
+  }
+
+  int regressions = 0;
+  bool first = true;
+  fprintf(output, "{\n  \"threshold\": %.3f,\n  \"runs\": [\n", threshold);
+  for (size_t w = 0; w < sizeof(s_suite) / sizeof(s_suite[0]); w++) {
+    const Workload &workload = s_suite[w];
+    if ((filter != nullptr && strcmp(filter, workload.name) != 0) || (study && !workload.untilExit)) {
+      continue;
+    }
+    std::uint64_t referenceDigest = 0;
+    const Config *baselineConfig = nullptr;
+    unsigned long long baselineCycles = 0;
+    double plainSeconds = 0; // the last pipelined config without a loop buffer
+    double baselineSeconds = 0;
+    for (size_t c = 0; c < numConfigs; c++) {
+      const Config &config = configs[c];
+      // the median of the repetitions (the simulation itself is deterministic); an untimed one is not repeated
+      RunResult result = run(workload, config, minSeconds);
+      std::vector<double> samples(1, result.wallSeconds);
+      for (int r = 1; r < repetitions && !result.crashed && result.timed; r++) {
+        RunResult again = run(workload, config, minSeconds);
+        if (!again.crashed) {
+          samples.push_back(again.wallSeconds);
+        }
+      }
+      result.wallSeconds = median(samples);
+      if (config.pipelined && config.loopBuffer == 0) {
+        plainSeconds = result.wallSeconds;
+      }
+      if (!config.pipelined) {
+        referenceDigest = result.digest;
+      } else if (baselineConfig == nullptr) {
+        baselineConfig = &config;
+        baselineCycles = result.cycles;
+        baselineSeconds = result.wallSeconds;
+      }
+      double cyclesPerSecond = (result.wallSeconds > 0) ? result.cycles / result.wallSeconds : 0;
+      double mips = (result.wallSeconds > 0) ? result.instructions / result.wallSeconds / 1e6 : 0;
+      double cpi = (result.instructions > 0) ? (double)result.cycles / result.instructions : 0;
+      const char *correct = !workload.untilExit ? "null"
+                            : (!result.crashed && result.halted && result.digest == referenceDigest) ? "true"
+                            : "false";
+
+      fprintf(output, "%s    {\"workload\": \"%s\", \"config\": \"%s\", \"cpu\": \"%s\", \"forwarding\": %s, "
+              "\"hazardDetection\": %s, \"crashed\": %s, \"halted\": %s, \"correct\": %s, "
+              "\"cycles\": %llu, \"instructions\": %llu, \"wallSeconds\": %.6f, \"timed\": %s, \"iterations\": %u, "
+              "\"cyclesPerSecond\": %.1f, \"simulatedMIPS\": %.4f, \"cpi\": %.4f",
+              first ? "" : ",\n", workload.name, config.name,
+              (config.outOfOrder != nullptr) ? "OutOfOrderCPU" : config.dualIssue ? "DualIssueCPU" : config.pipelined ? "PipelinedCPU" : "SingleCycleCPU",
+              config.enableDataForwarding ? "true" : "false", config.enableHazardDetection ? "true" : "false",
+              result.crashed ? "true" : "false", result.halted ? "true" : "false", correct,
+              result.cycles, result.instructions, result.wallSeconds, result.timed ? "true" : "false",
+              result.iterations, cyclesPerSecond, mips, cpi);
+      if (study) {
+        double accuracy = (result.branches > 0) ? 1.0 - (double)result.mispredictions / result.branches : 1.0;
+        fprintf(output, ", \"predictor\": \"%s\", \"earlyBranch\": %s, \"delaySlot\": %s, "
+                "\"branches\": %llu, \"mispredictions\": %llu, \"accuracy\": %.4f",
+                (config.predictor != nullptr) ? config.predictor : "", config.earlyBranch ? "true" : "false",
+                config.delaySlot ? "true" : "false", result.branches, result.mispredictions, accuracy);
+        fprintf(output, ", \"fetchQueue\": %u, \"instMemLatency\": %u, \"fetchQueueOccupancy\": %.3f, "
+                "\"fetchQueueEmpty\": %.4f, \"fetchQueueFull\": %.4f", config.fetchQueue, config.instMemLatency,
+                result.fetchQueueOccupancy, result.fetchQueueEmpty, result.fetchQueueFull);
+        fprintf(output, ", \"loopBuffer\": %u, \"loopsCaptured\": %llu, \"loopBufferFetches\": %llu, "
+                "\"loopBufferDecodes\": %llu", config.loopBuffer, result.loopsCaptured, result.loopBufferFetches,
+                result.loopBufferDecodes);
+        fprintf(output, ", \"storeDataForwarding\": %s", config.storeDataForwarding ? "true" : "false");
+        fprintf(output, ", \"valuePredictor\": \"%s\", \"loads\": %llu, \"valuePredictions\": %llu, "
+                "\"valueCorrect\": %llu, \"valueUsed\": %llu, \"valueReplays\": %llu",
+                (config.valuePredictor != nullptr) ? config.valuePredictor : "", result.valueLoads,
+                result.valuePredictions, result.valueCorrect, result.valueUsed, result.valueReplays);
+        fprintf(output, ", \"multiplier\": \"%s\", \"divider\": \"%s\", \"multiplies\": %llu, \"divides\": %llu, "
+                "\"mulDivResultStalls\": %llu, \"mulDivBusyStalls\": %llu",
+                (config.multiplier != nullptr) ? config.multiplier : "1p",
+                (config.divider != nullptr) ? config.divider : "1p", result.multiplies, result.divides,
+                result.mulDivResultStalls, result.mulDivBusyStalls);
+        fprintf(output, ", \"dualIssue\": %s, \"ipc\": %.4f, \"issueCycles\": [%llu, %llu, %llu], \"pairLimits\": {",
+                config.dualIssue ? "true" : "false", (result.cycles > 0) ? (double)result.instructions / result.cycles : 0.0,
+                result.issueCycles[0], result.issueCycles[1], result.issueCycles[2]);
+        for (int limit = 0; limit < DualIssueCPU::NUM_PAIR_LIMITS; limit++) {
+          fprintf(output, "%s\"%s\": %llu", (limit > 0) ? ", " : "", DualIssueCPU::pairLimitName(limit),
+                  result.pairLimits[limit]);
+        }
+        fprintf(output, "}");
+        fprintf(output, ", \"outOfOrder\": \"%s\", \"squashed\": %llu, \"cdbConflicts\": %llu",
+                (config.outOfOrder != nullptr) ? config.outOfOrder : "", result.squashed, result.cdbConflicts);
+        for (int window = 0; window < OutOfOrderCPU::NUM_WINDOWS; window++) {
+          fprintf(output, ", \"%sOccupancy\": %.3f, \"%sFull\": %llu", OutOfOrderCPU::windowName(window),
+                  result.windowOccupancy[window], OutOfOrderCPU::windowName(window), result.windowFull[window]);
+        }
+        fprintf(output, ", \"dataMemLatency\": %u, \"dataCache\": \"%s\", \"cacheAccesses\": %llu, \"hitRate\": %.4f",
+                config.dataMemLatency, (config.dataCache != nullptr) ? config.dataCache : "", result.cacheAccesses,
+                (result.cacheAccesses > 0) ? (double)result.cacheHits / result.cacheAccesses : 1.0);
+        for (int type = 0; type < DataCache::NUM_MISS_TYPES; type++) {
+          fprintf(output, ", \"%sMisses\": %llu", DataCache::missTypeName((DataCache::MissType)type),
+                  result.cacheMisses[type]);
+        }
+        fprintf(output, ", \"writebacks\": %llu, \"memoryWrites\": %llu, \"dataStallCycles\": %llu, "
+                "\"dataStallCPI\": %.4f", result.writebacks, result.memoryWrites, result.dataStallCycles,
+                (result.instructions > 0) ? (double)result.dataStallCycles / result.instructions : 0.0);
+      }
+      fprintf(output, "}");
+      first = false;
+      fprintf(stderr, "%-10s %-26s %10llu cycles  CPI %6.3f  %12.0f cycles/s%s", workload.name, config.name,
+              result.cycles, cpi, cyclesPerSecond,
+              result.crashed ? "  (crashed)" : !result.timed ? "  (untimed)" : "");
+      if (study && config.predictor != nullptr && result.branches > 0) {
+        fprintf(stderr, "  accuracy %6.2f%%", 100.0 * (1.0 - (double)result.mispredictions / result.branches));
+      }
+      if (study && config.fetchQueue > 0) {
+        fprintf(stderr, "  queue %5.2f (empty %5.1f%%, full %5.1f%%)", result.fetchQueueOccupancy,
+                100.0 * result.fetchQueueEmpty, 100.0 * result.fetchQueueFull);
+      }
+      if (study && config.loopBuffer > 0) {
+        fprintf(stderr, "  loop buffer %llu fetches (%5.1f%% of retired), host %.2fx", result.loopBufferFetches,
+                (result.instructions > 0) ? 100.0 * result.loopBufferFetches / result.instructions : 0.0,
+                (result.wallSeconds > 0) ? plainSeconds / result.wallSeconds : 0.0);
+      }
+      if (study && config.valuePredictor != nullptr) {
+        fprintf(stderr, "  coverage %5.1f%% accuracy %5.1f%% used %llu replayed %llu",
+                (result.valueLoads > 0) ? 100.0 * result.valuePredictions / result.valueLoads : 0.0,
+                (result.valuePredictions > 0) ? 100.0 * result.valueCorrect / result.valuePredictions : 100.0,
+                result.valueUsed, result.valueReplays);
+      }
+      if (study && (config.multiplier != nullptr || config.divider != nullptr)) {
+        fprintf(stderr, "  mul/div %llu+%llu, waited %llu for HI/LO, %llu busy", result.multiplies, result.divides,
+                result.mulDivResultStalls, result.mulDivBusyStalls);
+      }
+      if (study && config.dualIssue) {
+        unsigned long long issuing = result.issueCycles[1] + result.issueCycles[2];
+        int worst = 0;
+        for (int limit = 0; limit < DualIssueCPU::NUM_PAIR_LIMITS; limit++) {
+          worst = (result.pairLimits[limit] > result.pairLimits[worst]) ? limit : worst;
+        }
+        fprintf(stderr, "  IPC %5.3f, paired %5.1f%% of issuing cycles (alone mostly: %s)",
+                (result.cycles > 0) ? (double)result.instructions / result.cycles : 0.0,
+                (issuing > 0) ? 100.0 * result.issueCycles[2] / issuing : 0.0, DualIssueCPU::pairLimitName(worst));
+      }
+      if (study && config.outOfOrder != nullptr) {
+        fprintf(stderr, "  IPC %5.3f, occupancy rob %5.1f rs %5.1f lsq %5.1f, full rob %5.1f%% rs %5.1f%% lsq %5.1f%%, "
+                "squashed %llu", (result.cycles > 0) ? (double)result.instructions / result.cycles : 0.0,
+                result.windowOccupancy[OutOfOrderCPU::WindowROB], result.windowOccupancy[OutOfOrderCPU::WindowRS],
+                result.windowOccupancy[OutOfOrderCPU::WindowLSQ],
+                (result.cycles > 0) ? 100.0 * result.windowFull[OutOfOrderCPU::WindowROB] / result.cycles : 0.0,
+                (result.cycles > 0) ? 100.0 * result.windowFull[OutOfOrderCPU::WindowRS] / result.cycles : 0.0,
+                (result.cycles > 0) ? 100.0 * result.windowFull[OutOfOrderCPU::WindowLSQ] / result.cycles : 0.0,
+                result.squashed);
+      }
+      if (study && (config.dataCache != nullptr || config.dataMemLatency > 1)) {
+        if (config.dataCache != nullptr) {
+          fprintf(stderr, "  hit rate %5.1f%% (misses %llu compulsory, %llu capacity, %llu conflict), %llu writebacks",
+                  (result.cacheAccesses > 0) ? 100.0 * result.cacheHits / result.cacheAccesses : 100.0,
+                  result.cacheMisses[DataCache::Compulsory], result.cacheMisses[DataCache::Capacity],
+                  result.cacheMisses[DataCache::Conflict], result.writebacks);
+        }
+        fprintf(stderr, "%sstall CPI %5.3f, host %.2fx", (config.dataCache != nullptr) ? ", " : "  ",
+                (result.instructions > 0) ? (double)result.dataStallCycles / result.instructions : 0.0,
+                (result.wallSeconds > 0) ? baselineSeconds / result.wallSeconds : 0.0);
+      }
+      if (study && config.pipelined && &config != baselineConfig) {
+        fprintf(stderr, "  %+9lld cycles (%+6.2f%%) vs %s%s", (long long)result.cycles - (long long)baselineCycles,
+                100.0 * ((double)result.cycles / baselineCycles - 1.0), baselineConfig->name,
+                (result.digest != referenceDigest) ? "  (WRONG STATE)" : "");
+      }
+      fprintf(stderr, "\n");
+
+      // cycles/s only between runs timed over the minimum time; the cycles of every run must not change
+      std::map<std::string, BaselineRun>::const_iterator it = baseline.find(runKey(workload.name, config.name));
+      if (it != baseline.end() && !result.crashed && result.cycles != it->second.cycles) {
+        fprintf(stderr, "REGRESSION: %s / %s: %llu cycles (baseline %llu)\n", workload.name, config.name,
+                result.cycles, it->second.cycles);
+        regressions++;
+      } else if (it != baseline.end() && !result.crashed && result.timed && it->second.timed
+                 && cyclesPerSecond < it->second.cyclesPerSecond * (1.0 - threshold)) {
+        fprintf(stderr, "REGRESSION: %s / %s: %.0f cycles/s (baseline %.0f, -%.1f%%)\n", workload.name,
+                config.name, cyclesPerSecond, it->second.cyclesPerSecond,
+                100.0 * (1.0 - cyclesPerSecond / it->second.cyclesPerSecond));
+        regressions++;
+      }
+    }
+  }
+  fprintf(output, "\n  ]\n}\n");
+  if (output != stdout) {
+    fclose(output);
+  }
+  if (baselineFileName != nullptr) {
+    fprintf(stderr, "%d regression(s) against `%s' (threshold %.1f%%)\n", regressions, baselineFileName,
+            100.0 * threshold);
+  }
+  return (regressions > 0) ? 1 : 0;
+}
@@ -0,0 +1,288 @@
+#include "PipelinedCPU.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+// Microbenchmarks of the datapath primitives the CPUs call every cycle. The binary measures the
+// backend it was built with: benchPrimitives (bit-serial) or benchPrimitivesWord (-DWORD_DATAPATH).
+#ifdef WORD_DATAPATH
+#define BACKEND_NAME "word"
+#else
+#define BACKEND_NAME "bit-serial"
+#endif
+
+#define NUM_OPERANDS 1024 // operands cycle through a table so the results cannot be precomputed
+#define OPERAND_MASK (NUM_OPERANDS - 1)
+
+static double now() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+class PrimitiveBench {
+  public:
+    PrimitiveBench()
+      : m_cpu(new PipelinedCPU(0, nullptr, nullptr, nullptr)), m_dataMemory(Memory::LittleEndian) {
+      std::uint32_t state = 0x12345678;
+      for (size_t i = 0; i < NUM_OPERANDS; i++) {
+        state = state * 1664525 + 1013904223;
+        m_a[i] = state;
+        state = state * 1664525 + 1013904223;
+        m_b[i] = state;
+        m_immediate[i] = state >> 16;
+        m_select[i] = (state >> 8) % 3;
+        m_address[i] = (state >> 4) & 0xFFFC; // 64 KB of data memory
+        m_register[i] = state >> 27;
+      }
+    }
+    ~PrimitiveBench() { delete m_cpu; }
+
+    typedef std::uint64_t (PrimitiveBench::*Body)(size_t iterations);
+    struct Case {
+      const char *name;
+      Body body;
+    };
+    static const Case s_cases[];
+
+    std::uint64_t add(size_t iterations) {
+      std::bitset<32> output;
+      std::uint64_t sum = 0;
+      for (size_t i = 0; i < iterations; i++) {
+        m_cpu->Add<32>(&m_a[i & OPERAND_MASK], &m_b[i & OPERAND_MASK], &output);
+        sum += output.to_ulong();
+      }
+      return sum;
+    }
+    template<unsigned Control>
+    std::uint64_t alu(size_t iterations) {
+      const std::bitset<4> control(Control);
+      std::bitset<32> output;
+      std::bitset<1> zero;
+      std::uint64_t sum = 0;
+      for (size_t i = 0; i < iterations; i++) {
+        m_cpu->ALU(&m_a[i & OPERAND_MASK], &m_b[i & OPERAND_MASK], &control, &output, &zero);
+        sum += output.to_ulong() + (zero.to_ullong() << 32);
+      }
+      return sum;
+    }
+    std::uint64_t signExtend(size_t iterations) {
+      std::bitset<32> output;
+      std::uint64_t sum = 0;
+      for (size_t i = 0; i < iterations; i++) {
+        m_cpu->SignExtend<16, 32>(&m_immediate[i & OPERAND_MASK], &output);
+        sum += output.to_ulong();
+      }
+      return sum;
+    }
+    std::uint64_t shiftLeft2(size_t iterations) {
+      std::bitset<32> output;
+      std::uint64_t sum = 0;
+      for (size_t i = 0; i < iterations; i++) {
+        m_cpu->ShiftLeft2<32>(&m_a[i & OPERAND_MASK], &output);
+        sum += output.to_ulong();
+      }
+      return sum;
+    }
+    std::uint64_t mux3(size_t iterations) {
+      std::bitset<32> output;
+      std::uint64_t sum = 0;
+      for (size_t i = 0; i < iterations; i++) {
+        m_cpu->Mux<32>(&m_a[i & OPERAND_MASK], &m_b[i & OPERAND_MASK], &m_a[(i + 1) & OPERAND_MASK],
+                       &m_select[i & OPERAND_MASK], &output);
+        sum += output.to_ulong();
+      }
+      return sum;
+    }
+    std::uint64_t memoryRead(size_t iterations) {
+      const std::bitset<1> memRead(1), memWrite(0);
+      std::bitset<32> readData;
+      std::uint64_t sum = 0;
+      for (size_t i = 0; i < iterations; i++) {
+        m_dataMemory.access(&m_address[i & OPERAND_MASK], nullptr, &memRead, &memWrite, &readData);
+        sum += readData.to_ulong();
+      }
+      return sum;
+    }
+    std::uint64_t memoryWrite(size_t iterations) {
+      const std::bitset<1> memRead(0), memWrite(1);
+      std::bitset<32> readData;
+      for (size_t i = 0; i < iterations; i++) {
+        m_dataMemory.access(&m_address[i & OPERAND_MASK], &m_a[i & OPERAND_MASK], &memRead, &memWrite, &readData);
+      }
+      return iterations;
+    }
+    std::uint64_t registerRead(size_t iterations) {
+      std::bitset<32> readData1, readData2;
+      std::uint64_t sum = 0;
+      for (size_t i = 0; i < iterations; i++) {
+        m_registerFile.access(&m_register[i & OPERAND_MASK], &m_register[(i + 1) & OPERAND_MASK],
+                              nullptr, nullptr, nullptr, &readData1, &readData2);
+        sum += readData1.to_ulong() + readData2.to_ulong();
+      }
+      return sum;
+    }
+    std::uint64_t registerWrite(size_t iterations) {
+      const std::bitset<1> regWrite(1);
+      for (size_t i = 0; i < iterations; i++) {
+        m_registerFile.access(nullptr, nullptr, &m_register[i & OPERAND_MASK], &m_a[i & OPERAND_MASK],
+                              &regWrite, nullptr, nullptr);
+      }
+      return iterations;
+    }
+  private:
+    CPU *m_cpu; // <-- the datapath primitives are public members of CPU
+    Memory m_dataMemory;
+    RegisterFile m_registerFile;
+    std::bitset<32> m_a[NUM_OPERANDS];
+    std::bitset<32> m_b[NUM_OPERANDS];
+    std::bitset<16> m_immediate[NUM_OPERANDS];
+    std::bitset<2> m_select[NUM_OPERANDS];
+    std::bitset<32> m_address[NUM_OPERANDS];
+    std::bitset<5> m_register[NUM_OPERANDS];
+};
+
+const PrimitiveBench::Case PrimitiveBench::s_cases[] = {
+  { "Add<32>",                &PrimitiveBench::add },
+  { "ALU(and)",               &PrimitiveBench::alu<0> },
+  { "ALU(or)",                &PrimitiveBench::alu<1> },
+  { "ALU(add)",               &PrimitiveBench::alu<2> },
+  { "ALU(sub)",               &PrimitiveBench::alu<6> },
+  { "ALU(slt)",               &PrimitiveBench::alu<7> },
+  { "ALU(nor)",               &PrimitiveBench::alu<12> },
+  { "SignExtend<16,32>",      &PrimitiveBench::signExtend },
+  { "ShiftLeft2<32>",         &PrimitiveBench::shiftLeft2 },
+  { "Mux<32>(3-to-1)",        &PrimitiveBench::mux3 },
+  { "Memory::access(read)",   &PrimitiveBench::memoryRead },
+  { "Memory::access(write)",  &PrimitiveBench::memoryWrite },
+  { "RegisterFile::access(read)",  &PrimitiveBench::registerRead },
+  { "RegisterFile::access(write)", &PrimitiveBench::registerWrite },
+};
+
+// Reads the `nsPerOp' of each primitive from a JSON file written by this program (one result per line).
+static bool readBaseline(const char *fileName, std::map<std::string, double> *baseline) {
+  FILE *file = fopen(fileName, "r");
+  if (file == NULL) {
+    fprintf(stderr, "ERROR: cannot open the baseline `%s'\n", fileName);
+    return false;
+  }
+  char line[4096];
+  while (fgets(line, sizeof(line), file) != NULL) {
+    char backend[256], primitive[256];
+    const char *b = strstr(line, "\"backend\": \"");
+    const char *p = strstr(line, "\"primitive\": \"");
+    const char *ns = strstr(line, "\"nsPerOp\": ");
+    if (b == NULL || p == NULL || ns == NULL
+        || sscanf(b, "\"backend\": \"%255[^\"]\"", backend) != 1
+        || sscanf(p, "\"primitive\": \"%255[^\"]\"", primitive) != 1) {
+      continue;
+    }
+    (*baseline)[std::string(backend) + " / " + primitive] = atof(ns + strlen("\"nsPerOp\": "));
+  }
+  fclose(file);
+  return true;
+}
+
+int main(int argc, char **argv) {
+  const char *outputFileName = nullptr;
+  const char *baselineFileName = nullptr;
+  const char *filter = nullptr;
+  double threshold = 0.10;
+  int repetitions = 10;
+  int warmUps = 2;
+  size_t iterations = 200000;
+  int opt;
+  while ((opt = getopt(argc, argv, "o:b:t:r:u:n:c:")) != -1) {
+    switch (opt) {
+      case 'o': outputFileName = optarg; break;
+      case 'b': baselineFileName = optarg; break;
+      case 't': threshold = atof(optarg); break;
+      case 'r': repetitions = atoi(optarg); break;
+      case 'u': warmUps = atoi(optarg); break;
+      case 'n': iterations = (size_t)atol(optarg); break;
+      case 'c': filter = optarg; break;
+      default:
+        fprintf(stderr, "Usage: %s [-o results.json] [-b baseline.json] [-t threshold] [-r repetitions]", argv[0]);
+        fprintf(stderr, " [-u warmUps] [-n iterations] [-c primitive]\n");
+        exit(-1);
+    }
+  }
+  if (repetitions < 1 || iterations == 0) {
+    fprintf(stderr, "ERROR: need at least one repetition of at least one iteration\n");
+    exit(-1);
+  }
+
+  std::map<std::string, double> baseline;
+  if (baselineFileName != nullptr && !readBaseline(baselineFileName, &baseline)) {
+    exit(-1);
+  }
+  FILE *output = stdout;
+  if (outputFileName != nullptr && (output = fopen(outputFileName, "w")) == NULL) {
+    fprintf(stderr, "ERROR: cannot open `%s' for writing\n", outputFileName);
+    exit(-1);
+  }
+
+  quietMode() = true;
+  PrimitiveBench bench;
+  volatile std::uint64_t sink = 0; // keeps the compiler from dropping the loops
+  int regressions = 0;
+  bool first = true;
+  fprintf(output, "{\n  \"backend\": \"%s\",\n  \"threshold\": %.3f,\n  \"results\": [\n", BACKEND_NAME, threshold);
+  for (size_t c = 0; c < sizeof(PrimitiveBench::s_cases) / sizeof(PrimitiveBench::s_cases[0]); c++) {
+    const PrimitiveBench::Case &benchCase = PrimitiveBench::s_cases[c];
+    if (filter != nullptr && strstr(benchCase.name, filter) == NULL) {
+      continue;
+    }
+    for (int r = 0; r < warmUps; r++) {
+      sink = sink + (bench.*benchCase.body)(iterations);
+    }
+    std::vector<double> nsPerOp(repetitions);
+    for (int r = 0; r < repetitions; r++) {
+      double start = now();
+      sink = sink + (bench.*benchCase.body)(iterations);
+      nsPerOp[r] = (now() - start) * 1e9 / iterations;
+    }
+    double mean = 0, variance = 0, min = nsPerOp[0];
+    for (int r = 0; r < repetitions; r++) {
+      mean += nsPerOp[r] / repetitions;
+      if (nsPerOp[r] < min) { min = nsPerOp[r]; }
+    }
+    for (int r = 0; r < repetitions; r++) {
+      variance += (nsPerOp[r] - mean) * (nsPerOp[r] - mean) / repetitions;
+    }
+    double stddev = sqrt(variance);
+
+    fprintf(output, "%s    {\"backend\": \"%s\", \"primitive\": \"%s\", \"iterations\": %lu, \"repetitions\": %d, "
+            "\"nsPerOp\": %.4f, \"minNsPerOp\": %.4f, \"stddevNsPerOp\": %.4f}",
+            first ? "" : ",\n", BACKEND_NAME, benchCase.name, (unsigned long)iterations, repetitions, mean, min,
+            stddev);
+    first = false;
+    fprintf(stderr, "%-10s %-28s %9.3f ns/op  (min %8.3f, stddev %7.3f, %5.1f%%)\n", BACKEND_NAME, benchCase.name,
+            mean, min, stddev, (mean > 0) ? 100.0 * stddev / mean : 0.0);
+
+    std::map<std::string, double>::const_iterator it
+      = baseline.find(std::string(BACKEND_NAME) + " / " + benchCase.name);
+    if (it != baseline.end() && mean > it->second * (1.0 + threshold)) {
+      fprintf(stderr, "REGRESSION: %s / %s: %.3f ns/op (baseline %.3f, +%.1f%%)\n", BACKEND_NAME, benchCase.name,
+              mean, it->second, 100.0 * (mean / it->second - 1.0));
+      regressions++;
+    }
+  }
+  fprintf(output, "\n  ]\n}\n");
+  if (output != stdout) {
+    fclose(output);
+  }
+  if (baselineFileName != nullptr) {
+    fprintf(stderr, "%d regression(s) against `%s' (threshold %.1f%%)\n", regressions, baselineFileName,
+            100.0 * threshold);
+  }
+  return (regressions > 0) ? 1 : 0;
+}
@@ -0,0 +1,65 @@
+#include "DataCache.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// a short reference stream and the counters DataCache must end with
+struct CacheCase {
+  const char *name;
+  const char *spec;
+  const char *references; // <-- "l"/"s" + hexadecimal address, separated by spaces
+  std::uint64_t hits, compulsory, capacity, conflict, writebacks, memoryWrites;
+};
+
+static const CacheCase s_cases[] = {
+  // a store that does not allocate leaves the block out: the load after it is still the first to bring it in
+  {"nwa store then load", "lru:1024:4:16,nwa", "s100 l100 l104", 1, 2, 0, 0, 0, 1},
+  {"nwa stores only", "lru:1024:4:16,nwa", "s100 s100 s200", 0, 3, 0, 0, 0, 3},
+  {"nwa store after load", "lru:1024:4:16,nwa", "l100 s104", 1, 1, 0, 0, 0, 0},
+  // write-through allocates on a store miss and sends every store to memory
+  {"wt store then load", "lru:1024:4:16,wt", "s100 l100 s104", 2, 1, 0, 0, 0, 2},
+  {"wt,nwa store then load", "lru:1024:4:16,wt,nwa", "s100 l100 s104", 1, 2, 0, 0, 0, 2},
+  // 4 direct-mapped sets: 0x0 and 0x40 share a set, 5 blocks do not fit at all
+  {"conflict", "lru:64:1:16", "l0 l40 l0", 0, 2, 0, 1, 0, 0},
+  {"capacity", "lru:64:1:16", "l0 l10 l20 l30 l40 l0", 0, 5, 1, 0, 0, 0},
+  {"write-back victim", "lru:64:1:16", "s0 l40", 0, 2, 0, 0, 1, 0},
+};
+
+static bool check(const CacheCase &c) {
+  DataCache *cache = DataCache::create(c.spec);
+  if (cache == nullptr) {
+    printf("%s: MALFORMED %s\n", c.name, c.spec);
+    return false;
+  }
+  for (const char *p = c.references; *p != '\0';) {
+    const bool write = (*p == 's');
+    char *end;
+    cache->access((std::uint32_t)strtoul(p + 1, &end, 16), write);
+    p = end + strspn(end, " ");
+  }
+  const std::uint64_t hits = cache->getHits(false) + cache->getHits(true);
+  const bool ok = hits == c.hits && cache->getMisses(DataCache::Compulsory) == c.compulsory &&
+                  cache->getMisses(DataCache::Capacity) == c.capacity &&
+                  cache->getMisses(DataCache::Conflict) == c.conflict && cache->getWritebacks() == c.writebacks &&
+                  cache->getMemoryWrites() == c.memoryWrites;
+  if (ok) {
+    printf("%s: ok\n", c.name);
+  } else {
+    printf("%s: MISMATCH (hits %llu compulsory %llu capacity %llu conflict %llu writebacks %llu memoryWrites %llu)\n",
+           c.name, (unsigned long long)hits, (unsigned long long)cache->getMisses(DataCache::Compulsory),
+           (unsigned long long)cache->getMisses(DataCache::Capacity),
+           (unsigned long long)cache->getMisses(DataCache::Conflict), (unsigned long long)cache->getWritebacks(),
+           (unsigned long long)cache->getMemoryWrites());
+  }
+  delete cache;
+  return ok;
+}
+
+int main() {
+  bool ok = true;
+  for (size_t i = 0; i < sizeof(s_cases) / sizeof(s_cases[0]); i++) {
+    ok = check(s_cases[i]) && ok;
+  }
+  return ok ? 0 : 1;
+}
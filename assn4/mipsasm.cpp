@@ -0,0 +1,43 @@
+#include "Assembler.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char **argv) {
+  unsigned branchPadding = 0;
+  std::uint32_t textBase = 0x0, dataBase = 0x0;
+  bool fillDelaySlots = false;
+  int argi = 1;
+  for (; argi < argc && argv[argi][0] == '-'; argi++) {
+    if (strcmp(argv[argi], "-f") == 0) {
+      fillDelaySlots = true;
+    } else if (argi + 1 >= argc) {
+      break;
+    } else if (strcmp(argv[argi], "-p") == 0) {
+      branchPadding = (unsigned)atoi(argv[++argi]);
+    } else if (strcmp(argv[argi], "-T") == 0) {
+      textBase = (std::uint32_t)strtoul(argv[++argi], nullptr, 0);
+    } else if (strcmp(argv[argi], "-D") == 0) {
+      dataBase = (std::uint32_t)strtoul(argv[++argi], nullptr, 0);
+    } else {
+      break;
+    }
+  }
+  if (argc - argi != 2) {
+    fprintf(stderr, "Usage: %s [-p branchPadding] [-f] [-T textBase] [-D dataBase] sourceFileName outputPrefix\n",
+            argv[0]);
+    fprintf(stderr, "  writes outputPrefix_instMemFile, outputPrefix_dataMemFile and outputPrefix_regFile\n");
+    fprintf(stderr, "  -f fills the first nop after each branch with the instruction before it when possible\n");
+    fprintf(stderr, "     (`-p 1 -f' targets the CPUs with a branch delay slot)\n");
+    exit(-1);
+  }
+
+  Assembler assembler(textBase, dataBase);
+  assembler.setBranchPadding(branchPadding);
+  assembler.setFillDelaySlots(fillDelaySlots);
+  if (!assembler.assemble(argv[argi]) || !assembler.writeImages(argv[argi + 1])) {
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,175 @@
+#include "BranchPredictor.hpp"
+#include "BranchTrace.hpp"
+#include "HostProfiler.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+// Trace-driven evaluation of branch predictors (see BranchTrace.hpp)
+//   - Replays the branch streams recorded with -r through every predictor configuration (the -c specs,
+//     or a default sweep of the table sizes, history lengths and BTB sizes), each starting cold on
+//     each trace, and prints the mispredictions per 1000 retired instructions (MPKI)
+//   - A misprediction is a wrong next fetch PC, as in PipelinedCPU: a wrong direction, or a taken
+//     branch missing from the BTB
+//   - The replay loop is instantiated per predictor class so that the predictor calls inline; the
+//     configurations are spread over `jobs' threads
+
+struct Trace {
+  std::string name;
+  std::vector<BranchRecord> records;
+  unsigned long long retired;
+};
+
+static std::vector<std::string> defaultSpecs() {
+  std::vector<std::string> specs;
+  specs.push_back("nt");
+  specs.push_back("btfn");
+  for (unsigned entries = 64; entries <= 16384; entries *= 4) {
+    specs.push_back("bimodal:" + std::to_string(entries));
+  }
+  for (unsigned log2Entries = 8; log2Entries <= 14; log2Entries += 2) {
+    for (unsigned historyBits = 2; historyBits <= log2Entries; historyBits += 2) {
+      specs.push_back("gshare:" + std::to_string(1u << log2Entries) + ":" + std::to_string(historyBits));
+    }
+  }
+  for (unsigned log2Entries = 8; log2Entries <= 14; log2Entries += 2) {
+    specs.push_back("tournament:" + std::to_string(1u << log2Entries) + ":" + std::to_string(log2Entries));
+  }
+  const unsigned btbEntries[] = { 8, 32, 128 }; // the others use the default 512
+  for (size_t i = 0; i < sizeof(btbEntries) / sizeof(btbEntries[0]); i++) {
+    specs.push_back("bimodal:4096,btb=" + std::to_string(btbEntries[i]));
+    specs.push_back("gshare:4096:12,btb=" + std::to_string(btbEntries[i]));
+  }
+  return specs;
+}
+
+template <class P>
+static std::uint64_t replay(P *predictor, const std::vector<BranchRecord> &records) {
+  for (size_t i = 0; i < records.size(); i++) {
+    const std::uint32_t pc = records[i].pc(), target = records[i].target;
+    const bool taken = records[i].taken();
+    const std::uint32_t actualPC = taken ? target : pc + 4;
+    predictor->resolve(pc, taken, target, predictor->predict(pc) != actualPC);
+  }
+  return predictor->getMispredictions();
+}
+
+// the mispredictions of `spec' on `trace', with a fresh predictor
+static std::uint64_t evaluate(const std::string &spec, const Trace &trace) {
+  BranchPredictor *predictor = BranchPredictor::create(spec);
+  std::uint64_t mispredictions;
+  if (StaticNotTakenPredictor *p = dynamic_cast<StaticNotTakenPredictor *>(predictor)) {
+    mispredictions = replay(p, trace.records);
+  } else if (StaticBTFNPredictor *p = dynamic_cast<StaticBTFNPredictor *>(predictor)) {
+    mispredictions = replay(p, trace.records);
+  } else if (BimodalPredictor *p = dynamic_cast<BimodalPredictor *>(predictor)) {
+    mispredictions = replay(p, trace.records);
+  } else if (GSharePredictor *p = dynamic_cast<GSharePredictor *>(predictor)) {
+    mispredictions = replay(p, trace.records);
+  } else if (TournamentPredictor *p = dynamic_cast<TournamentPredictor *>(predictor)) {
+    mispredictions = replay(p, trace.records);
+  } else {
+    mispredictions = replay(predictor, trace.records); // a predictor added without a case above
+  }
+  delete predictor;
+  return mispredictions;
+}
+
+static double mpki(const std::uint64_t mispredictions, const unsigned long long retired) {
+  return (retired > 0) ? 1000.0 * mispredictions / retired : 0.0;
+}
+
+int main(int argc, char **argv) {
+  std::vector<std::string> specs;
+  unsigned jobs = std::thread::hardware_concurrency();
+  int opt;
+  while ((opt = getopt(argc, argv, "c:j:")) != -1) {
+    switch (opt) {
+      case 'c': specs.push_back(optarg); break;
+      case 'j': jobs = (unsigned)atoi(optarg); break;
+      default: argc = 0; break;
+    }
+  }
+  if (argc - optind < 1) {
+    fprintf(stderr, "Usage: %s [-c predictorSpec]... [-j jobs] branchTraceFileName...\n", argv[0]);
+    fprintf(stderr, "  -c predictorSpec  a configuration to evaluate (see BranchPredictor::create); repeatable,\n");
+    fprintf(stderr, "                    replaces the default sweep\n");
+    fprintf(stderr, "  -j jobs           threads replaying the configurations (the number of cores)\n");
+    exit(-1);
+  }
+  if (specs.empty()) {
+    specs = defaultSpecs();
+  }
+  for (size_t i = 0; i < specs.size(); i++) {
+    BranchPredictor *predictor = BranchPredictor::create(specs[i]);
+    if (predictor == nullptr) {
+      fprintf(stderr, "ERROR: unknown branch predictor `%s'\n", specs[i].c_str());
+      exit(-1);
+    }
+    specs[i] = predictor->name();
+    delete predictor;
+  }
+  jobs = (jobs == 0) ? 1 : jobs;
+
+  std::vector<Trace> traces(argc - optind);
+  std::uint64_t numBranches = 0;
+  unsigned long long numRetired = 0;
+  for (size_t t = 0; t < traces.size(); t++) {
+    const char *fileName = argv[optind + t];
+    if (!BranchTraceWriter::read(fileName, &traces[t].records, &traces[t].retired)) {
+      exit(-1);
+    }
+    const char *name = strrchr(fileName, '/');
+    traces[t].name = (name != NULL) ? name + 1 : fileName;
+    numBranches += traces[t].records.size();
+    numRetired += traces[t].retired;
+  }
+
+  // mispredictions[c * traces.size() + t]; thread j takes the configurations j, j + jobs, ...
+  std::vector<std::uint64_t> mispredictions(specs.size() * traces.size());
+  double start = HostProfiler::now();
+  std::vector<std::thread> threads;
+  for (unsigned j = 0; j < jobs && j < specs.size(); j++) {
+    threads.push_back(std::thread([&, j]() {
+      for (size_t c = j; c < specs.size(); c += jobs) {
+        for (size_t t = 0; t < traces.size(); t++) {
+          mispredictions[c * traces.size() + t] = evaluate(specs[c], traces[t]);
+        }
+      }
+    }));
+  }
+  for (size_t j = 0; j < threads.size(); j++) {
+    threads[j].join();
+  }
+  double seconds = HostProfiler::now() - start;
+
+  printf("MPKI (mispredictions per 1000 retired instructions)\n");
+  printf("%-26s", "predictor");
+  for (size_t t = 0; t < traces.size(); t++) {
+    printf(" %12.12s", traces[t].name.c_str());
+  }
+  printf(" %12s\n", "all");
+  size_t best = 0;
+  std::vector<std::uint64_t> total(specs.size(), 0);
+  for (size_t c = 0; c < specs.size(); c++) {
+    printf("%-26s", specs[c].c_str());
+    for (size_t t = 0; t < traces.size(); t++) {
+      total[c] += mispredictions[c * traces.size() + t];
+      printf(" %12.3f", mpki(mispredictions[c * traces.size() + t], traces[t].retired));
+    }
+    printf(" %12.3f\n", mpki(total[c], numRetired));
+    best = (total[c] < total[best]) ? c : best;
+  }
+  printf("best: %s (%.3f MPKI, %.2f%% accuracy)\n", specs[best].c_str(), mpki(total[best], numRetired),
+         (numBranches > 0) ? 100.0 * (1.0 - (double)total[best] / numBranches) : 100.0);
+  double replayed = (double)numBranches * specs.size();
+  printf("%zu configurations x %llu branches in %.3f s on %zu threads: %.1f M branches/s\n", specs.size(),
+         (unsigned long long)numBranches, seconds, threads.size(), (seconds > 0) ? replayed / seconds / 1e6 : 0.0);
+  return 0;
+}
@@ -0,0 +1,422 @@
+#include "SingleCycleCPU.hpp"
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+// Synthetic instruction-stream generator
+//   - Emits a random straight-line program (with forward branches) in the memory image format,
+//     then runs it on SingleCycleCPU to produce the expected final state:
+//       <prefix>_instMemFile, <prefix>_dataMemFile, <prefix>_regFile, <prefix>_expectedState
+//   - The same seed and knobs always produce the same program
+
+#define NUM_POOL_REGISTERS 18   // $t0..$t7, $s0..$s7, $t8, $t9 hold the generated values
+#define FIRST_POOL_REGISTER 8
+#define REG_GP 28               // base of the working set
+#define GP_VALUE 0x8000         // so that the 16-bit offsets cover 64 KB of data memory
+#define NOP_INSTRUCTION 0x00000020
+
+struct Knobs {
+  unsigned numInstructions;
+  double loadFraction;
+  double storeFraction;
+  double mulDivFraction;         // mult/multu/div/divu, each followed by mfhi and/or mflo
+  double meanDependencyDistance; // mean of the geometric distance distribution (in instructions)
+  double dependentFraction;      // fraction of the source operands that read an earlier result
+  double loadUseFraction;        // probability that the instruction after a load uses its result
+  double branchDensity;
+  double takenRate;
+  unsigned workingSetWords;
+  unsigned branchPadding;        // nops after each branch (as in mipsasm -p)
+  std::uint64_t seed;
+};
+
+// xorshift64*; std::mt19937 is portable but the std distributions are not
+class Random {
+  public:
+    Random(std::uint64_t seed) : m_state(seed * 2685821657736338717ULL + 1) { }
+    std::uint64_t next() {
+      m_state ^= m_state >> 12;
+      m_state ^= m_state << 25;
+      m_state ^= m_state >> 27;
+      return m_state * 2685821657736338717ULL;
+    }
+    unsigned below(unsigned bound) { return (unsigned)(next() % bound); }
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+    bool chance(double probability) { return uniform() < probability; }
+  private:
+    std::uint64_t m_state;
+};
+
+class Generator {
+  public:
+    Generator(const Knobs &knobs) : m_knobs(knobs), m_random(knobs.seed), m_lastLoadDest(0),
+                                    m_numLoads(0), m_numStores(0), m_numBranches(0), m_numTaken(0),
+                                    m_numLoadUses(0), m_numMulDivs(0) {
+      for (unsigned i = 0; i < 32; i++) { m_regs[i] = 0; }
+      for (unsigned i = 0; i < NUM_POOL_REGISTERS; i++) {
+        m_regs[FIRST_POOL_REGISTER + i] = m_random.below(0x10000) - 0x8000;
+      }
+      m_regs[REG_GP] = GP_VALUE;
+      m_memory.resize(knobs.workingSetWords);
+      for (unsigned i = 0; i < knobs.workingSetWords; i++) {
+        m_memory[i] = m_random.below(0x10000);
+      }
+      m_initialMemory = m_memory;
+      for (unsigned i = 0; i < 32; i++) { m_initialRegs[i] = m_regs[i]; }
+    }
+    void generate();
+    bool writeImages(const std::string &prefix) const;
+    void printSummary() const;
+    void dumpState(FILE *file) const; // the final state as the generator models it (CPU::dumpState format)
+  private:
+    enum Kind { Alu, Load, Store };
+    unsigned pickSource(bool loadUse);
+    unsigned pickDest() { return FIRST_POOL_REGISTER + m_random.below(NUM_POOL_REGISTERS); }
+    std::int32_t pickOffset() { return 4 * (std::int32_t)m_random.below(m_knobs.workingSetWords) - GP_VALUE; }
+    void emitAlu(bool execute, bool loadUse);
+    void emitLoad();
+    void emitStore(bool loadUse);
+    void emitMulDiv();
+    void emitBranch();
+    void emitR(unsigned funct, unsigned rd, unsigned rs, unsigned rt) {
+      m_text.push_back((rs << 21) | (rt << 16) | (rd << 11) | funct);
+    }
+    void emitI(unsigned opcode, unsigned rt, unsigned rs, std::int32_t immediate) {
+      m_text.push_back((opcode << 26) | (rs << 21) | (rt << 16) | ((std::uint32_t)immediate & 0xFFFF));
+    }
+
+    Knobs m_knobs;
+    Random m_random;
+    std::uint32_t m_regs[32];        // architectural state along the executed path
+    std::uint32_t m_initialRegs[32];
+    std::vector<std::uint32_t> m_memory;
+    std::vector<std::uint32_t> m_initialMemory;
+    std::vector<unsigned> m_history; // destination of each executed instruction (0 = none)
+    unsigned m_lastLoadDest;         // destination of the previous instruction if it was a load
+    std::vector<std::uint32_t> m_text;
+    unsigned long m_numLoads, m_numStores, m_numBranches, m_numTaken, m_numLoadUses, m_numMulDivs;
+};
+
+unsigned Generator::pickSource(bool loadUse) {
+  if (loadUse && m_lastLoadDest != 0) {
+    return m_lastLoadDest;
+  }
+  for (int attempt = 0; attempt < 8; attempt++) {
+    unsigned reg = FIRST_POOL_REGISTER + m_random.below(NUM_POOL_REGISTERS);
+    if (!m_history.empty() && m_random.chance(m_knobs.dependentFraction)) {
+      // geometric distance >= 1 with the requested mean
+      size_t distance = 1;
+      double p = 1.0 / (m_knobs.meanDependencyDistance < 1.0 ? 1.0 : m_knobs.meanDependencyDistance);
+      while (!m_random.chance(p) && distance < m_history.size()) { distance++; }
+      if (distance <= m_history.size() && m_history[m_history.size() - distance] != 0) {
+        reg = m_history[m_history.size() - distance];
+      }
+    }
+    // a load-use pair only where the knob asked for one
+    if (reg != m_lastLoadDest) {
+      return reg;
+    }
+  }
+  return (m_lastLoadDest == FIRST_POOL_REGISTER) ? FIRST_POOL_REGISTER + 1 : FIRST_POOL_REGISTER;
+}
+
+void Generator::emitAlu(bool execute, bool loadUse) {
+  unsigned rs = execute ? pickSource(loadUse) : pickDest();
+  unsigned rt = execute ? pickSource(false) : pickDest();
+  unsigned rd = pickDest();
+  unsigned op = m_random.below(6);
+  std::uint32_t a = m_regs[rs], b = m_regs[rt], result = 0;
+  if (op == 5) { // addi
+    std::int32_t immediate = (std::int32_t)m_random.below(4096) - 2048;
+    emitI(0x08, rd, rs, immediate);
+    result = a + (std::uint32_t)immediate;
+  } else {
+    static const unsigned functs[5] = { 0x20, 0x22, 0x24, 0x25, 0x2A };
+    emitR(functs[op], rd, rs, rt);
+    result = (op == 0) ? a + b : (op == 1) ? a - b : (op == 2) ? (a & b) : (op == 3) ? (a | b)
+             : ((std::int32_t)a < (std::int32_t)b ? 1 : 0);
+  }
+  if (execute) {
+    m_regs[rd] = result;
+    m_history.push_back(rd);
+    m_lastLoadDest = 0;
+  }
+}
+
+void Generator::emitLoad() {
+  unsigned rt = pickDest();
+  std::int32_t offset = pickOffset();
+  emitI(0x23, rt, REG_GP, offset);
+  m_regs[rt] = m_memory[(offset + GP_VALUE) / 4];
+  m_history.push_back(rt);
+  m_lastLoadDest = rt;
+  m_numLoads++;
+}
+
+void Generator::emitStore(bool loadUse) {
+  unsigned rt = pickSource(loadUse);
+  std::int32_t offset = pickOffset();
+  emitI(0x2B, rt, REG_GP, offset);
+  m_memory[(offset + GP_VALUE) / 4] = m_regs[rt];
+  m_history.push_back(0);
+  m_lastLoadDest = 0;
+  m_numStores++;
+}
+
+void Generator::emitMulDiv() {
+  // the moves right after the operation: the worst case for the latency of the unit
+  unsigned rs = pickSource(false), rt = pickSource(false);
+  unsigned op = m_random.below(4);
+  std::uint32_t a = m_regs[rs], b = m_regs[rt], hi = 0, lo = 0;
+  emitR(0x18 + op, 0, rs, rt);
+  if (op <= 1) { // mult, multu
+    std::uint64_t product = (op == 0) ? (std::uint64_t)((std::int64_t)(std::int32_t)a * (std::int32_t)b)
+                                      : (std::uint64_t)a * b;
+    hi = (std::uint32_t)(product >> 32);
+    lo = (std::uint32_t)product;
+  } else if (b == 0) { // div, divu by zero
+    hi = a;
+    lo = 0xFFFFFFFF;
+  } else if (op == 2) {
+    bool overflow = (a == 0x80000000 && b == 0xFFFFFFFF);
+    hi = overflow ? 0 : (std::uint32_t)((std::int32_t)a % (std::int32_t)b);
+    lo = overflow ? a : (std::uint32_t)((std::int32_t)a / (std::int32_t)b);
+  } else {
+    hi = a % b;
+    lo = a / b;
+  }
+  m_history.push_back(0);
+  m_lastLoadDest = 0;
+  m_numMulDivs++;
+  unsigned moves = 1 + m_random.below(3); // mfhi, mflo, or both
+  for (unsigned i = 0; i < 2; i++) {
+    if ((moves & (1u << i)) == 0) { continue; }
+    unsigned rd = pickDest();
+    emitR((i == 0) ? 0x10 : 0x12, rd, 0, 0);
+    m_regs[rd] = (i == 0) ? hi : lo;
+    m_history.push_back(rd);
+  }
+}
+
+void Generator::emitBranch() {
+  // beq rs, rt, skip: rt = rs is always taken, a register holding another value never is
+  unsigned skip = 1 + m_random.below(4);
+  bool taken = m_random.chance(m_knobs.takenRate);
+  unsigned rs = pickSource(false), rt = rs;
+  if (!taken) {
+    rt = 0;
+    for (int attempt = 0; attempt < 8 && m_regs[rt] == m_regs[rs]; attempt++) {
+      rt = pickSource(false);
+    }
+    if (m_regs[rt] == m_regs[rs]) {
+      taken = true;
+      rt = rs;
+    }
+  }
+  emitI(0x04, rt, rs, (std::int32_t)(m_knobs.branchPadding + skip));
+  for (unsigned i = 0; i < m_knobs.branchPadding; i++) {
+    m_text.push_back(NOP_INSTRUCTION);
+  }
+  m_history.push_back(0);
+  m_lastLoadDest = 0;
+  m_numBranches++;
+  if (taken) {
+    // the skipped instructions are never executed
+    m_numTaken++;
+    for (unsigned i = 0; i < skip; i++) {
+      emitAlu(false, false);
+    }
+  }
+}
+
+void Generator::generate() {
+  bool loadUse = false;
+  while (m_text.size() < m_knobs.numInstructions) {
+    double r = m_random.uniform();
+    if (loadUse) {
+      // the consumer of the previous load: an ALU op, or a store of the loaded value
+      m_numLoadUses++;
+      if (r < m_knobs.storeFraction / (m_knobs.storeFraction + 1.0)) { emitStore(true); }
+      else { emitAlu(true, true); }
+    } else if (r < m_knobs.branchDensity) {
+      emitBranch();
+    } else if (r < m_knobs.branchDensity + m_knobs.loadFraction) {
+      emitLoad();
+    } else if (r < m_knobs.branchDensity + m_knobs.loadFraction + m_knobs.storeFraction) {
+      emitStore(false);
+    } else if (r < m_knobs.branchDensity + m_knobs.loadFraction + m_knobs.storeFraction + m_knobs.mulDivFraction) {
+      emitMulDiv();
+    } else {
+      emitAlu(true, false);
+    }
+    loadUse = (m_lastLoadDest != 0) && m_random.chance(m_knobs.loadUseFraction);
+  }
+  emitI(0x08, 2, 0, 10); // li $v0, 10
+  m_regs[2] = 10;
+  m_text.push_back(0x0000000C); // syscall (exit)
+}
+
+bool Generator::writeImages(const std::string &prefix) const {
+  FILE *instFile = fopen((prefix + "_instMemFile").c_str(), "w");
+  FILE *dataFile = fopen((prefix + "_dataMemFile").c_str(), "w");
+  FILE *regFile = fopen((prefix + "_regFile").c_str(), "w");
+  if (instFile == NULL || dataFile == NULL || regFile == NULL) {
+    fprintf(stderr, "ERROR: cannot write the images of `%s'\n", prefix.c_str());
+    return false;
+  }
+  for (size_t i = 0; i < m_text.size(); i++) {
+    fprintf(instFile, "%x %08lx\n", (unsigned)(4 * i), (unsigned long)m_text[i]);
+  }
+  for (size_t i = 0; i < m_initialMemory.size(); i++) {
+    if (m_initialMemory[i] != 0) {
+      fprintf(dataFile, "%x %08lx\n", (unsigned)(4 * i), (unsigned long)m_initialMemory[i]);
+    }
+  }
+  for (unsigned i = 1; i < 32; i++) {
+    if (m_initialRegs[i] != 0) {
+      fprintf(regFile, "%u %08lx\n", i, (unsigned long)m_initialRegs[i]);
+    }
+  }
+  fclose(instFile);
+  fclose(dataFile);
+  fclose(regFile);
+  return true;
+}
+
+void Generator::dumpState(FILE *file) const {
+  fprintf(file, "# registers\n");
+  for (unsigned i = 1; i < 32; i++) {
+    if (m_regs[i] != 0) {
+      fprintf(file, "%u %08lx\n", i, (unsigned long)m_regs[i]);
+    }
+  }
+  fprintf(file, "# data memory\n");
+  for (size_t i = 0; i < m_memory.size(); i++) {
+    if (m_memory[i] != 0) {
+      fprintf(file, "%x %08lx\n", (unsigned)(4 * i), (unsigned long)m_memory[i]);
+    }
+  }
+}
+
+static bool sameContents(FILE *file0, FILE *file1) {
+  rewind(file0);
+  rewind(file1);
+  int c0, c1;
+  do {
+    c0 = fgetc(file0);
+    c1 = fgetc(file1);
+  } while (c0 == c1 && c0 != EOF);
+  return c0 == c1;
+}
+
+void Generator::printSummary() const {
+  unsigned long executed = m_history.size();
+  printf("seed %llu: %lu instructions emitted, %lu executed (+%u nops per branch)\n",
+         (unsigned long long)m_knobs.seed, (unsigned long)m_text.size(), executed, m_knobs.branchPadding);
+  printf("  loads %.3f, stores %.3f, branches %.3f (taken %.3f), load-use pairs %.3f of the loads\n",
+         (double)m_numLoads / executed, (double)m_numStores / executed, (double)m_numBranches / executed,
+         m_numBranches ? (double)m_numTaken / m_numBranches : 0.0,
+         m_numLoads ? (double)m_numLoadUses / m_numLoads : 0.0);
+  if (m_numMulDivs > 0) {
+    printf("  mul/div %.3f\n", (double)m_numMulDivs / executed);
+  }
+}
+
+int main(int argc, char **argv) {
+  Knobs knobs;
+  knobs.numInstructions = 10000;
+  knobs.loadFraction = 0.2;
+  knobs.storeFraction = 0.1;
+  knobs.mulDivFraction = 0.0;
+  knobs.meanDependencyDistance = 3.0;
+  knobs.dependentFraction = 0.7;
+  knobs.loadUseFraction = 0.3;
+  knobs.branchDensity = 0.1;
+  knobs.takenRate = 0.5;
+  knobs.workingSetWords = 1024;
+  knobs.branchPadding = 2;
+  knobs.seed = 1;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "n:l:S:m:d:D:u:b:t:w:p:s:")) != -1) {
+    switch (opt) {
+      case 'n': knobs.numInstructions = (unsigned)atoi(optarg); break;
+      case 'l': knobs.loadFraction = atof(optarg); break;
+      case 'S': knobs.storeFraction = atof(optarg); break;
+      case 'm': knobs.mulDivFraction = atof(optarg); break;
+      case 'd': knobs.meanDependencyDistance = atof(optarg); break;
+      case 'D': knobs.dependentFraction = atof(optarg); break;
+      case 'u': knobs.loadUseFraction = atof(optarg); break;
+      case 'b': knobs.branchDensity = atof(optarg); break;
+      case 't': knobs.takenRate = atof(optarg); break;
+      case 'w': knobs.workingSetWords = (unsigned)atoi(optarg); break;
+      case 'p': knobs.branchPadding = (unsigned)atoi(optarg); break;
+      case 's': knobs.seed = strtoull(optarg, nullptr, 0); break;
+      default: argc = 0; break;
+    }
+  }
+  if (argc - optind != 1 || knobs.workingSetWords == 0 || knobs.workingSetWords > 16384
+      || knobs.loadFraction + knobs.storeFraction + knobs.mulDivFraction + knobs.branchDensity > 1.0) {
+    fprintf(stderr, "Usage: %s [options] outputPrefix\n", argv[0]);
+    fprintf(stderr, "  -n instructions         (10000)\n");
+    fprintf(stderr, "  -l loadFraction         (0.2)\n");
+    fprintf(stderr, "  -S storeFraction        (0.1)\n");
+    fprintf(stderr, "  -m mulDivFraction       (0.0)\n");
+    fprintf(stderr, "  -d meanDependencyDist   (3.0)\n");
+    fprintf(stderr, "  -D dependentFraction    (0.7)\n");
+    fprintf(stderr, "  -u loadUseFraction      (0.3)\n");
+    fprintf(stderr, "  -b branchDensity        (0.1)\n");
+    fprintf(stderr, "  -t takenRate            (0.5)\n");
+    fprintf(stderr, "  -w workingSetWords      (1024, at most 16384)\n");
+    fprintf(stderr, "  -p branchPadding        (2)\n");
+    fprintf(stderr, "  -s seed                 (1)\n");
+    exit(-1);
+  }
+  std::string prefix(argv[optind]);
+
+  Generator generator(knobs);
+  generator.generate();
+  if (!generator.writeImages(prefix)) {
+    return 1;
+  }
+  generator.printSummary();
+
+  // the functional reference
+  quietMode() = true;
+  SingleCycleCPU *cpu = new SingleCycleCPU(0, (prefix + "_regFile").c_str(), (prefix + "_instMemFile").c_str(),
+                                           (prefix + "_dataMemFile").c_str());
+  while (!cpu->isHalted() && cpu->getCurrCycle() < 4ULL * knobs.numInstructions + 16) {
+    cpu->advanceCycle();
+  }
+  if (!cpu->isHalted()) {
+    fprintf(stderr, "ERROR: the reference run did not reach the exit\n");
+    delete cpu;
+    return 1;
+  }
+  FILE *stateFile = fopen((prefix + "_expectedState").c_str(), "w");
+  assert(stateFile != NULL);
+  cpu->dumpState(stateFile);
+  fclose(stateFile);
+  printf("  reference: %llu instructions retired\n", cpu->getNumRetired());
+
+  // the generator picks branch operands from its own model; it has to agree with the reference
+  FILE *referenceState = tmpfile(), *modelState = tmpfile();
+  assert(referenceState != NULL && modelState != NULL);
+  cpu->dumpState(referenceState);
+  generator.dumpState(modelState);
+  bool agree = sameContents(referenceState, modelState);
+  fclose(referenceState);
+  fclose(modelState);
+  delete cpu;
+  if (!agree) {
+    fprintf(stderr, "ERROR: the generator's model and the reference disagree on the final state\n");
+    return 1;
+  }
+  return 0;
+}
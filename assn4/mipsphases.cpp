@@ -0,0 +1,275 @@
+#include "IntervalStats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+// Phase analysis of an interval time series (see IntervalStats.hpp)
+//   - Each interval is described by its rates per cycle (IPC, bubbles, forwards, branches, memory
+//     reads and writes) and its touched pages relative to the busiest interval
+//   - Consecutive intervals stay in one segment while they are within `threshold' (L1 distance) of
+//     the mean of the segment; segments that look alike (again within `threshold') get the same phase
+//   - Prints the segments in order, then the CPI and the event rates of each phase
+
+typedef std::vector<std::uint64_t> Record; // indexed by IntervalStats::Field
+
+#define NUM_FEATURES 7
+
+static bool readCSV(FILE *file, std::vector<std::string> &names, std::vector<std::vector<std::uint64_t> > &rows) {
+  char line[4096];
+  if (fgets(line, sizeof(line), file) == NULL) {
+    return false;
+  }
+  for (char *name = strtok(line, ",\r\n"); name != NULL; name = strtok(NULL, ",\r\n")) {
+    names.push_back(name);
+  }
+  while (fgets(line, sizeof(line), file) != NULL) {
+    std::vector<std::uint64_t> row;
+    for (char *value = strtok(line, ",\r\n"); value != NULL; value = strtok(NULL, ",\r\n")) {
+      row.push_back(strtoull(value, nullptr, 10));
+    }
+    if (row.size() != names.size()) {
+      printf("ERROR: %zu values in a record of %zu fields\n", row.size(), names.size());
+      return false;
+    }
+    rows.push_back(row);
+  }
+  return true;
+}
+
+static bool readBinary(FILE *file, std::vector<std::string> &names, std::vector<std::vector<std::uint64_t> > &rows) {
+  std::uint32_t numFields, reserved;
+  std::uint64_t period;
+  if (fread(&numFields, sizeof(numFields), 1, file) != 1 || fread(&reserved, sizeof(reserved), 1, file) != 1
+      || fread(&period, sizeof(period), 1, file) != 1) {
+    return false;
+  }
+  for (std::uint32_t i = 0; i < numFields; i++) {
+    std::string name;
+    int c;
+    while ((c = fgetc(file)) > 0) {
+      name += (char)c;
+    }
+    if (c < 0) {
+      return false;
+    }
+    names.push_back(name);
+  }
+  std::vector<std::uint64_t> row(numFields);
+  while (fread(&row[0], sizeof(std::uint64_t), numFields, file) == numFields) {
+    rows.push_back(row);
+  }
+  return true;
+}
+
+// reorders the columns by IntervalStats::Field; fields missing from the file read as zero
+static bool readIntervals(const char *fileName, std::vector<Record> &records) {
+  FILE *file = fopen(fileName, "rb");
+  if (file == NULL) {
+    printf("ERROR: cannot open `%s'\n", fileName);
+    return false;
+  }
+  char magic[8];
+  std::vector<std::string> names;
+  std::vector<std::vector<std::uint64_t> > rows;
+  bool ok;
+  if (fread(magic, 1, sizeof(magic), file) == sizeof(magic) && memcmp(magic, "IVLSTAT1", sizeof(magic)) == 0) {
+    ok = readBinary(file, names, rows);
+  } else {
+    rewind(file);
+    ok = readCSV(file, names, rows);
+  }
+  fclose(file);
+  if (!ok) {
+    printf("ERROR: `%s' is not an interval stats file\n", fileName);
+    return false;
+  }
+  std::vector<int> columns(IntervalStats::NUM_FIELDS, -1);
+  for (int field = 0; field < IntervalStats::NUM_FIELDS; field++) {
+    for (size_t i = 0; i < names.size(); i++) {
+      if (names[i] == IntervalStats::fieldName((IntervalStats::Field)field)) {
+        columns[field] = (int)i;
+      }
+    }
+  }
+  if (columns[IntervalStats::Cycles] < 0 || columns[IntervalStats::Retired] < 0) {
+    printf("ERROR: `%s' has no cycles or retired column\n", fileName);
+    return false;
+  }
+  for (size_t r = 0; r < rows.size(); r++) {
+    Record record(IntervalStats::NUM_FIELDS, 0);
+    for (int field = 0; field < IntervalStats::NUM_FIELDS; field++) {
+      if (columns[field] >= 0) {
+        record[field] = rows[r][columns[field]];
+      }
+    }
+    if (record[IntervalStats::Cycles] > 0) {
+      records.push_back(record);
+    }
+  }
+  return true;
+}
+
+struct Totals {
+  std::uint64_t fields[IntervalStats::NUM_FIELDS];
+  unsigned intervals;
+  Totals() : intervals(0) { memset(fields, 0, sizeof(fields)); }
+  void add(const Record &record) {
+    for (int i = 0; i < IntervalStats::NUM_FIELDS; i++) { fields[i] += record[i]; }
+    intervals++;
+  }
+  void add(const Totals &totals) {
+    for (int i = 0; i < IntervalStats::NUM_FIELDS; i++) { fields[i] += totals.fields[i]; }
+    intervals += totals.intervals;
+  }
+  std::uint64_t get(const IntervalStats::Field field) const { return fields[field]; }
+  double cpi() const {
+    return (get(IntervalStats::Retired) > 0) ? (double)get(IntervalStats::Cycles) / get(IntervalStats::Retired) : 0.0;
+  }
+  // the pages are averaged over the intervals and scaled by the busiest interval
+  void features(const double maxPages, double *feature) const {
+    double cycles = (double)get(IntervalStats::Cycles);
+    feature[0] = get(IntervalStats::Retired) / cycles;
+    feature[1] = (get(IntervalStats::LoadUseBubbles) + get(IntervalStats::SyscallBubbles)) / cycles;
+    feature[2] = get(IntervalStats::Forwards) / cycles;
+    feature[3] = get(IntervalStats::Branches) / cycles;
+    feature[4] = get(IntervalStats::MemReads) / cycles;
+    feature[5] = get(IntervalStats::MemWrites) / cycles;
+    feature[6] = (maxPages > 0) ? get(IntervalStats::TouchedPages) / (double)intervals / maxPages : 0.0;
+  }
+};
+
+static double distance(const double *a, const double *b) {
+  double sum = 0;
+  for (int i = 0; i < NUM_FEATURES; i++) { sum += fabs(a[i] - b[i]); }
+  return sum;
+}
+
+struct Segment {
+  Totals totals;
+  std::uint64_t startCycle;
+  unsigned phase;
+};
+
+int main(int argc, char **argv) {
+  double threshold = 0.15;
+  unsigned minIntervals = 2;
+  int opt;
+  while ((opt = getopt(argc, argv, "t:m:")) != -1) {
+    switch (opt) {
+      case 't': threshold = atof(optarg); break;
+      case 'm': minIntervals = (unsigned)atoi(optarg); break;
+      default: argc = 0; break;
+    }
+  }
+  if (argc - optind != 1) {
+    fprintf(stderr, "Usage: %s [-t threshold] [-m minIntervals] intervalFileName\n", argv[0]);
+    fprintf(stderr, "  -t threshold     L1 distance of the per-cycle rates that starts a new segment (0.15)\n");
+    fprintf(stderr, "  -m minIntervals  shortest segment, in intervals (2)\n");
+    exit(-1);
+  }
+
+  std::vector<Record> records;
+  if (!readIntervals(argv[optind], records)) {
+    return 1;
+  }
+  if (records.empty()) {
+    printf("no intervals\n");
+    return 0;
+  }
+  double maxPages = 0;
+  for (size_t i = 0; i < records.size(); i++) {
+    maxPages = std::max(maxPages, (double)records[i][IntervalStats::TouchedPages]);
+  }
+
+  // 1. segments of similar consecutive intervals
+  std::vector<Segment> segments;
+  for (size_t i = 0; i < records.size(); i++) {
+    Totals interval;
+    interval.add(records[i]);
+    double feature[NUM_FEATURES], mean[NUM_FEATURES];
+    interval.features(maxPages, feature);
+    if (!segments.empty()) {
+      segments.back().totals.features(maxPages, mean);
+    }
+    if (segments.empty()
+        || (segments.back().totals.intervals >= minIntervals && distance(feature, mean) > threshold)) {
+      Segment segment;
+      segment.startCycle = records[i][IntervalStats::StartCycle];
+      segment.phase = 0;
+      segments.push_back(segment);
+    }
+    segments.back().totals.add(records[i]);
+  }
+
+  // 2. phases: the segments that look alike
+  std::vector<Totals> phases;
+  for (size_t s = 0; s < segments.size(); s++) {
+    double feature[NUM_FEATURES];
+    segments[s].totals.features(maxPages, feature);
+    double best = threshold;
+    int bestPhase = -1;
+    for (size_t p = 0; p < phases.size(); p++) {
+      double centroid[NUM_FEATURES];
+      phases[p].features(maxPages, centroid);
+      double d = distance(feature, centroid);
+      if (d <= best) {
+        best = d;
+        bestPhase = (int)p;
+      }
+    }
+    if (bestPhase < 0) {
+      bestPhase = (int)phases.size();
+      phases.push_back(Totals());
+    }
+    phases[bestPhase].add(segments[s].totals);
+    segments[s].phase = (unsigned)bestPhase;
+  }
+
+  // neighbouring segments of the same phase are one segment
+  std::vector<Segment> merged;
+  for (size_t s = 0; s < segments.size(); s++) {
+    if (!merged.empty() && merged.back().phase == segments[s].phase) {
+      merged.back().totals.add(segments[s].totals);
+    } else {
+      merged.push_back(segments[s]);
+    }
+  }
+  segments.swap(merged);
+
+  Totals all;
+  for (size_t p = 0; p < phases.size(); p++) { all.add(phases[p]); }
+  printf("# %zu intervals, %llu cycles, %llu retired, CPI %.3f; %zu segments, %zu phases (threshold %.3f)\n",
+         records.size(), (unsigned long long)all.get(IntervalStats::Cycles),
+         (unsigned long long)all.get(IntervalStats::Retired), all.cpi(), segments.size(), phases.size(), threshold);
+  printf("\n# segments\n");
+  printf("#  start cycle       cycles  phase    CPI\n");
+  for (size_t s = 0; s < segments.size(); s++) {
+    printf("%13llu %12llu %6u %6.3f\n", (unsigned long long)segments[s].startCycle,
+           (unsigned long long)segments[s].totals.get(IntervalStats::Cycles), segments[s].phase,
+           segments[s].totals.cpi());
+  }
+  printf("\n# phases (rates per 1000 retired instructions; pages per interval)\n");
+  printf("# phase intervals      cycles  cycles%%    CPI  bubbles forwards branches redirect   reads  writes"
+         "   pages new-pages\n");
+  for (size_t p = 0; p < phases.size(); p++) {
+    const Totals &phase = phases[p];
+    double perKilo = (phase.get(IntervalStats::Retired) > 0) ? 1000.0 / phase.get(IntervalStats::Retired) : 0.0;
+    printf("%7zu %9u %11llu %7.1f%% %6.3f %8.1f %8.1f %8.1f %8.1f %7.1f %7.1f %7.1f %9.1f\n", p, phase.intervals,
+           (unsigned long long)phase.get(IntervalStats::Cycles),
+           100.0 * phase.get(IntervalStats::Cycles) / all.get(IntervalStats::Cycles), phase.cpi(),
+           (phase.get(IntervalStats::LoadUseBubbles) + phase.get(IntervalStats::SyscallBubbles)) * perKilo,
+           phase.get(IntervalStats::Forwards) * perKilo, phase.get(IntervalStats::Branches) * perKilo,
+           phase.get(IntervalStats::RedirectPenalty) * perKilo, phase.get(IntervalStats::MemReads) * perKilo,
+           phase.get(IntervalStats::MemWrites) * perKilo,
+           (double)phase.get(IntervalStats::TouchedPages) / phase.intervals,
+           (double)phase.get(IntervalStats::NewPages) / phase.intervals);
+  }
+  return 0;
+}
@@ -0,0 +1,140 @@
+#include "HostProfiler.hpp"
+#include "Telemetry.hpp"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// top-style viewer of the running simulators (see Telemetry.hpp)
+//   - Attaches to every /dev/shm/mipssim.<pid> segment and prints the progress and throughput of
+//     each run, refreshed every `delay' seconds
+//   - The segments of simulators that were killed (and could not unlink theirs) show as "dead";
+//     -c removes them
+
+struct Run {
+  std::string name;
+  TelemetryBlock *block;
+};
+
+static void attach(std::vector<Run> &runs) {
+  DIR *dir = opendir("/dev/shm");
+  if (dir == NULL) {
+    return;
+  }
+  for (struct dirent *entry = readdir(dir); entry != NULL; entry = readdir(dir)) {
+    if (strncmp(entry->d_name, TELEMETRY_PREFIX, strlen(TELEMETRY_PREFIX)) != 0) {
+      continue;
+    }
+    std::string name = std::string("/") + entry->d_name;
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+      continue;
+    }
+    void *address = mmap(nullptr, sizeof(TelemetryBlock), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+      continue;
+    }
+    Run run;
+    run.name = name;
+    run.block = (TelemetryBlock *)address;
+    runs.push_back(run);
+  }
+  closedir(dir);
+}
+
+static void detach(std::vector<Run> &runs) {
+  for (size_t i = 0; i < runs.size(); i++) {
+    munmap(runs[i].block, sizeof(TelemetryBlock));
+  }
+  runs.clear();
+}
+
+static bool isAlive(const int pid) {
+  return kill(pid, 0) == 0 || errno == EPERM;
+}
+
+static void show(std::vector<Run> &runs, const bool clean) {
+  double now = HostProfiler::now();
+  double totalCyclesPerSecond = 0;
+  unsigned numRunning = 0;
+  printf("%7s %-14s %-28s %12s %12s %6s %6s %6s %6s %9s %8s %s\n", "PID", "CPU", "PROGRAM", "CYCLES", "RETIRED",
+         "CPI", "LDUSE%", "SYSC%", "REDIR%", "KCYC/S", "ELAPSED", "STATE");
+  for (size_t i = 0; i < runs.size(); i++) {
+    const TelemetryBlock *block = runs[i].block;
+    if (block->magic != TELEMETRY_MAGIC) {
+      continue; // not initialized yet
+    }
+    TelemetryCounters counters;
+    Telemetry::read(block, &counters);
+    const char *state = counters.halted ? "halted" : "running";
+    if (!isAlive(block->pid)) {
+      state = "dead";
+      if (clean) {
+        shm_unlink(runs[i].name.c_str());
+        state = "dead (removed)";
+      }
+    } else if (!counters.halted) {
+      totalCyclesPerSecond += counters.cyclesPerSecond;
+      numRunning++;
+    }
+    double cycles = (counters.cycles > 0) ? (double)counters.cycles : 1.0;
+    const char *program = strrchr(block->program, '/');
+    program = (program != NULL) ? program + 1 : block->program;
+    printf("%7d %-14.14s %-28.28s %12llu %12llu %6.3f %6.2f %6.2f %6.2f %9.1f %7.1fs %s\n", (int)block->pid,
+           block->cpu, program, (unsigned long long)counters.cycles, (unsigned long long)counters.retired,
+           counters.cpi, 100.0 * counters.loadUseBubbles / cycles, 100.0 * counters.syscallBubbles / cycles,
+           100.0 * counters.redirectPenalty / cycles, counters.cyclesPerSecond / 1e3,
+           ((state[0] == 'r') ? now : counters.updateTime) - counters.startTime, state);
+  }
+  printf("%u running, %.1f K cycles/s in total\n", numRunning, totalCyclesPerSecond / 1e3);
+}
+
+int main(int argc, char **argv) {
+  double delay = 1.0;
+  unsigned iterations = 0;
+  bool batch = false, clean = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "d:n:bc")) != -1) {
+    switch (opt) {
+      case 'd': delay = atof(optarg); break;
+      case 'n': iterations = (unsigned)atoi(optarg); break;
+      case 'b': batch = true; break;
+      case 'c': clean = true; break;
+      default: argc = 0; break;
+    }
+  }
+  if (argc - optind != 0) {
+    fprintf(stderr, "Usage: %s [-d delay] [-n iterations] [-b] [-c]\n", argv[0]);
+    fprintf(stderr, "  -d delay       seconds between refreshes (1)\n");
+    fprintf(stderr, "  -n iterations  refreshes before exiting; 0 runs until interrupted (0)\n");
+    fprintf(stderr, "  -b             batch mode: append the tables instead of redrawing the screen\n");
+    fprintf(stderr, "  -c             remove the segments of dead simulators\n");
+    exit(-1);
+  }
+
+  for (unsigned i = 0; iterations == 0 || i < iterations; i++) {
+    if (i > 0) {
+      usleep((useconds_t)(delay * 1e6));
+    }
+    // simulators come and go, so the segments are attached again on every refresh
+    std::vector<Run> runs;
+    attach(runs);
+    if (!batch) {
+      printf("\033[H\033[2J");
+    }
+    show(runs, clean);
+    fflush(stdout);
+    detach(runs);
+  }
+  return 0;
+}
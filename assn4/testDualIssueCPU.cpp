@@ -0,0 +1,132 @@
+#include "DualIssueCPU.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <unistd.h>
+
+int main(int argc, char **argv) {
+  // options: -q (quiet; print only the final state), -s finalStateFileName (see CPU::dumpState),
+  //          -c countersFileName (the performance counters in JSON; see PerfCounters.hpp),
+  //          -i intervalFileName, -I intervalCycles, -b (the counters of every interval, in CSV or with -b
+  //          in binary; see IntervalStats.hpp),
+  //          -l (publish the counters live for mipstop; see Telemetry.hpp),
+  //          -r branchTraceFileName (the branch stream for mipsbpsweep; see BranchTrace.hpp),
+  //          -X multiplierTiming, -Y dividerTiming (e.g., 4p or 32: the cycles of mult/div, pipelined or
+  //          iterative; see DualIssueCPU::setMultiplier and MulDivUnit::parseTiming)
+  bool quiet = false;
+  const char *finalStateFileName = nullptr;
+  const char *countersFileName = nullptr;
+  const char *intervalFileName = nullptr;
+  unsigned long long intervalCycles = 10000;
+  bool binaryIntervals = false;
+  bool liveTelemetry = false;
+  const char *branchTraceFileName = nullptr;
+  const char *multiplierTiming = nullptr;
+  const char *dividerTiming = nullptr;
+  int opt;
+  while ((opt = getopt(argc, argv, "qs:c:i:I:blr:X:Y:")) != -1) {
+    switch (opt) {
+      case 'q': quiet = true; break;
+      case 's': finalStateFileName = optarg; break;
+      case 'c': countersFileName = optarg; break;
+      case 'i': intervalFileName = optarg; break;
+      case 'I': intervalCycles = strtoull(optarg, nullptr, 0); break;
+      case 'b': binaryIntervals = true; break;
+      case 'l': liveTelemetry = true; break;
+      case 'r': branchTraceFileName = optarg; break;
+      case 'X': multiplierTiming = optarg; break;
+      case 'Y': dividerTiming = optarg; break;
+      default: argc = 0; break;
+    }
+  }
+  if (argc - optind != 5 && argc - optind != 7) {
+    fprintf(stderr, "Usage: %s [-q] [-s finalStateFileName] [-c countersFileName]", argv[0]);
+    fprintf(stderr, " [-i intervalFileName [-I intervalCycles] [-b]] [-l] [-r branchTraceFileName]");
+    fprintf(stderr, " [-X multiplierTiming] [-Y dividerTiming] initialPC regFileName");
+    fprintf(stderr, " instMemFileName dataMemFileName numCycles [enableDataForwarding enableHazardDetection]\n");
+    fflush(stdout);
+    exit(-1);
+  }
+  argv += optind - 1;
+
+  // IF adds 4 to the PC before fetching, as in PipelinedCPU
+  const std::int32_t initialPC = (std::int32_t)(atoll(argv[1])) - 4;
+  const char *regFileName = argv[2];
+  const char *instMemFileName = argv[3];
+  const char *dataMemFileName = argv[4];
+  const std::uint64_t numCycles = (std::uint64_t)atoll(argv[5]);
+  // both on unless given, as the dual-issue pipeline always had them
+  const bool enableDataForwarding = (argc - optind != 7) || (atol(argv[6]) != 0);
+  const bool enableHazardDetection = (argc - optind != 7) || (atol(argv[7]) != 0);
+
+  quietMode() = quiet;
+  DualIssueCPU *cpu = new DualIssueCPU(initialPC, regFileName, instMemFileName, dataMemFileName,
+                                       enableDataForwarding, enableHazardDetection);
+  const char *mulDivTimings[2] = {multiplierTiming, dividerTiming};
+  for (int i = 0; i < 2; i++) {
+    unsigned cycles;
+    bool pipelined;
+    if (mulDivTimings[i] == nullptr) {
+      continue;
+    }
+    if (!MulDivUnit::parseTiming(mulDivTimings[i], &cycles, &pipelined)) {
+      fprintf(stderr, "ERROR: malformed %s timing `%s'\n", (i == 0) ? "multiplier" : "divider", mulDivTimings[i]);
+      exit(-1);
+    }
+    if (i == 0) {
+      cpu->setMultiplier(cycles, pipelined);
+    } else {
+      cpu->setDivider(cycles, pipelined);
+    }
+  }
+
+  FILE *intervalFile = nullptr;
+  if (intervalFileName != nullptr) {
+    intervalFile = fopen(intervalFileName, binaryIntervals ? "wb" : "w");
+    assert(intervalFile != NULL);
+    cpu->enableIntervalStats(new IntervalStats(intervalFile, binaryIntervals ? IntervalStats::Binary : IntervalStats::CSV,
+                                               intervalCycles));
+  }
+  if (liveTelemetry) {
+    cpu->enableTelemetry(new Telemetry(instMemFileName, "DualIssueCPU"));
+  }
+  FILE *branchTraceFile = nullptr;
+  if (branchTraceFileName != nullptr) {
+    branchTraceFile = fopen(branchTraceFileName, "wb");
+    assert(branchTraceFile != NULL);
+    cpu->enableBranchTrace(new BranchTraceWriter(branchTraceFile));
+  }
+
+  // numCycles = 0 runs the program until it calls exit
+  if (!quiet) { cpu->printPVS(); }
+  for (size_t i = 0; (numCycles == 0 || i < numCycles) && !cpu->isHalted(); i++) {
+    cpu->advanceCycle();
+    if (!quiet) { cpu->printPVS(); }
+  }
+  if (quiet) { cpu->printPVS(); }
+
+  if (finalStateFileName != nullptr) {
+    FILE *finalStateFile = fopen(finalStateFileName, "w");
+    assert(finalStateFile != NULL);
+    cpu->dumpState(finalStateFile);
+    fclose(finalStateFile);
+  }
+  if (countersFileName != nullptr) {
+    FILE *countersFile = fopen(countersFileName, "w");
+    assert(countersFile != NULL);
+    cpu->getPerfCounters().writeJSON(countersFile);
+    fclose(countersFile);
+  }
+
+  const int exitCode = cpu->exitCode();
+  delete cpu;
+  if (intervalFile != nullptr) {
+    fclose(intervalFile);
+  }
+  if (branchTraceFile != nullptr) {
+    fclose(branchTraceFile);
+  }
+
+  return exitCode;
+}
@@ -1,15 +1,104 @@
 #include "PipelinedCPU.hpp"
+#include "KonataTracer.hpp"
+#include "ChromeTracer.hpp"
 
 #include <cstdio>
 #include <cstdlib>
 
+#include <unistd.h>
+
 int main(int argc, char **argv) {
-  if (argc != 8) {
-    fprintf(stderr, "Usage: %s initialPC regFileName instMemFileName dataMemFileName numCycles", argv[0]);
-    fprintf(stderr, " enableDataForwarding enableHazardDetection\n");
+  // options: -q (quiet; print only the final state), -s finalStateFileName (see CPU::dumpState),
+  //          -c countersFileName (the performance counters in JSON; see PerfCounters.hpp),
+  //          -p profileFileName (the per-PC stall attribution report; see PCProfiler.hpp),
+  //          -t traceFileName (a pipeline trace for the Konata viewer; see KonataTracer.hpp),
+  //          -j chromeTraceFileName (a Chrome trace_event timeline; see ChromeTracer.hpp),
+  //          -W windowCycles, -N samplePeriod (the counter window and span sampling of -j),
+  //          -i intervalFileName, -I intervalCycles, -b (the counters of every interval, in CSV or with -b
+  //          in binary; see IntervalStats.hpp),
+  //          -l (publish the counters live for mipstop; see Telemetry.hpp),
+  //          -B predictorSpec (predict the branches and flush the wrong path; see BranchPredictor::create),
+  //          -e (resolve the branches in ID; see PipelinedCPU::enableEarlyBranchResolution),
+  //          -d (execute the instruction after each branch; see PipelinedCPU::enableDelaySlot),
+  //          -r branchTraceFileName (the branch stream for mipsbpsweep; see BranchTrace.hpp),
+  //          -Q fetchQueueEntries (decouple IF from ID; see PipelinedCPU::enableFetchQueue),
+  //          -L instMemLatency (cycles to fetch from a new block; see PipelinedCPU::setInstMemLatency),
+  //          -D dataMemLatency (cycles of each load and store; see PipelinedCPU::setDataMemLatency),
+  //          -C dataCacheSpec (an L1 data cache in front of the data memory; see DataCache::create),
+  //          -U loopBufferEntries (stream short loops decoded; see PipelinedCPU::enableLoopBuffer),
+  //          -M (forward a loaded value to the store data in MEM; see PipelinedCPU::enableStoreDataForwarding),
+  //          -V valuePredictorSpec (predict the loaded values; see LoadValuePredictor::create),
+  //          -X multiplierTiming, -Y dividerTiming (e.g., 4p or 32: the cycles of mult/div, pipelined or
+  //          iterative; see PipelinedCPU::setMultiplier and MulDivUnit::parseTiming)
+  bool quiet = false;
+  const char *finalStateFileName = nullptr;
+  const char *countersFileName = nullptr;
+  const char *profileFileName = nullptr;
+  const char *traceFileName = nullptr;
+  const char *chromeTraceFileName = nullptr;
+  unsigned long long windowCycles = 1000;
+  unsigned samplePeriod = 1;
+  const char *intervalFileName = nullptr;
+  unsigned long long intervalCycles = 10000;
+  bool binaryIntervals = false;
+  bool liveTelemetry = false;
+  const char *predictorSpec = nullptr;
+  bool earlyBranchResolution = false;
+  bool delaySlot = false;
+  const char *branchTraceFileName = nullptr;
+  unsigned fetchQueueEntries = 0;
+  unsigned instMemLatency = 1;
+  unsigned dataMemLatency = 1;
+  const char *dataCacheSpec = nullptr;
+  unsigned loopBufferEntries = 0;
+  bool storeDataForwarding = false;
+  const char *valuePredictorSpec = nullptr;
+  const char *multiplierTiming = nullptr;
+  const char *dividerTiming = nullptr;
+  int opt;
+  while ((opt = getopt(argc, argv, "qs:c:p:t:j:W:N:i:I:blB:edr:Q:L:D:C:U:MV:X:Y:")) != -1) {
+    switch (opt) {
+      case 'q': quiet = true; break;
+      case 's': finalStateFileName = optarg; break;
+      case 'c': countersFileName = optarg; break;
+      case 'p': profileFileName = optarg; break;
+      case 't': traceFileName = optarg; break;
+      case 'j': chromeTraceFileName = optarg; break;
+      case 'W': windowCycles = strtoull(optarg, nullptr, 0); break;
+      case 'N': samplePeriod = (unsigned)strtoul(optarg, nullptr, 0); break;
+      case 'i': intervalFileName = optarg; break;
+      case 'I': intervalCycles = strtoull(optarg, nullptr, 0); break;
+      case 'b': binaryIntervals = true; break;
+      case 'l': liveTelemetry = true; break;
+      case 'B': predictorSpec = optarg; break;
+      case 'e': earlyBranchResolution = true; break;
+      case 'd': delaySlot = true; break;
+      case 'r': branchTraceFileName = optarg; break;
+      case 'Q': fetchQueueEntries = (unsigned)strtoul(optarg, nullptr, 0); break;
+      case 'L': instMemLatency = (unsigned)strtoul(optarg, nullptr, 0); break;
+      case 'D': dataMemLatency = (unsigned)strtoul(optarg, nullptr, 0); break;
+      case 'C': dataCacheSpec = optarg; break;
+      case 'U': loopBufferEntries = (unsigned)strtoul(optarg, nullptr, 0); break;
+      case 'M': storeDataForwarding = true; break;
+      case 'V': valuePredictorSpec = optarg; break;
+      case 'X': multiplierTiming = optarg; break;
+      case 'Y': dividerTiming = optarg; break;
+      default: argc = 0; break;
+    }
+  }
+  if (argc - optind != 7) {
+    fprintf(stderr, "Usage: %s [-q] [-s finalStateFileName] [-c countersFileName] [-p profileFileName]", argv[0]);
+    fprintf(stderr, " [-t traceFileName] [-j chromeTraceFileName] [-W windowCycles] [-N samplePeriod]");
+    fprintf(stderr, " [-i intervalFileName [-I intervalCycles] [-b]] [-l]");
+    fprintf(stderr, " [-B predictorSpec] [-e] [-d] [-r branchTraceFileName]");
+    fprintf(stderr, " [-Q fetchQueueEntries] [-L instMemLatency] [-D dataMemLatency] [-C dataCacheSpec]");
+    fprintf(stderr, " [-U loopBufferEntries] [-M] [-V valuePredictorSpec] [-X multiplierTiming] [-Y dividerTiming]");
+    fprintf(stderr, " initialPC regFileName instMemFileName dataMemFileName numCycles enableDataForwarding");
+    fprintf(stderr, " enableHazardDetection\n");
     fflush(stdout);
     exit(-1);
   }
+  argv += optind - 1;
 
   const std::int32_t initialPC = (std::int32_t)(atoll(argv[1])) - 4;
   const char *regFileName = argv[2];
@@ -19,17 +108,156 @@ int main(int argc, char **argv) {
   const bool enableDataForwarding = (atol(argv[6]) != 0);
   const bool enableHazardDetection = (atol(argv[7]) != 0);
 
+  quietMode() = quiet;
   PipelinedCPU *cpu = new PipelinedCPU(initialPC, regFileName, instMemFileName, dataMemFileName,
                                        enableDataForwarding, enableHazardDetection);
+  if (predictorSpec != nullptr && delaySlot) {
+    fprintf(stderr, "ERROR: -B and -d do not go together\n");
+    exit(-1);
+  }
+  if ((fetchQueueEntries > 0 || instMemLatency > 1) && delaySlot) {
+    fprintf(stderr, "ERROR: -Q and -L do not go together with -d\n");
+    exit(-1);
+  }
+  if (loopBufferEntries > 0 && delaySlot) {
+    fprintf(stderr, "ERROR: -U and -d do not go together\n");
+    exit(-1);
+  }
+  if (valuePredictorSpec != nullptr && delaySlot) {
+    fprintf(stderr, "ERROR: -V and -d do not go together\n");
+    exit(-1);
+  }
+  if (predictorSpec != nullptr) {
+    BranchPredictor *predictor = BranchPredictor::create(predictorSpec);
+    if (predictor == nullptr) {
+      fprintf(stderr, "ERROR: unknown branch predictor `%s'\n", predictorSpec);
+      exit(-1);
+    }
+    cpu->setBranchPredictor(predictor);
+  }
+  if (earlyBranchResolution) {
+    cpu->enableEarlyBranchResolution();
+  }
+  if (delaySlot) {
+    cpu->enableDelaySlot();
+  }
+  if (fetchQueueEntries > 0) {
+    cpu->enableFetchQueue(fetchQueueEntries);
+  }
+  if (loopBufferEntries > 0) {
+    cpu->enableLoopBuffer(loopBufferEntries);
+  }
+  if (storeDataForwarding) {
+    cpu->enableStoreDataForwarding();
+  }
+  if (valuePredictorSpec != nullptr) {
+    LoadValuePredictor *predictor = LoadValuePredictor::create(valuePredictorSpec);
+    if (predictor == nullptr) {
+      fprintf(stderr, "ERROR: unknown load value predictor `%s'\n", valuePredictorSpec);
+      exit(-1);
+    }
+    cpu->setLoadValuePredictor(predictor);
+  }
+  const char *mulDivTimings[2] = {multiplierTiming, dividerTiming};
+  for (int i = 0; i < 2; i++) {
+    unsigned cycles;
+    bool pipelined;
+    if (mulDivTimings[i] == nullptr) {
+      continue;
+    }
+    if (!MulDivUnit::parseTiming(mulDivTimings[i], &cycles, &pipelined)) {
+      fprintf(stderr, "ERROR: malformed %s timing `%s'\n", (i == 0) ? "multiplier" : "divider", mulDivTimings[i]);
+      exit(-1);
+    }
+    if (i == 0) {
+      cpu->setMultiplier(cycles, pipelined);
+    } else {
+      cpu->setDivider(cycles, pipelined);
+    }
+  }
+  cpu->setInstMemLatency(instMemLatency);
+  cpu->setDataMemLatency(dataMemLatency);
+  if (dataCacheSpec != nullptr) {
+    DataCache *cache = DataCache::create(dataCacheSpec);
+    if (cache == nullptr) {
+      fprintf(stderr, "ERROR: unknown data cache `%s'\n", dataCacheSpec);
+      exit(-1);
+    }
+    cpu->setDataCache(cache);
+  }
+  if (profileFileName != nullptr) {
+    cpu->enableProfiler();
+  }
+  FILE *traceFile = nullptr;
+  if (traceFileName != nullptr) {
+    traceFile = fopen(traceFileName, "w");
+    assert(traceFile != NULL);
+    cpu->addTracer(new KonataTracer(traceFile));
+  }
+  FILE *chromeTraceFile = nullptr;
+  if (chromeTraceFileName != nullptr) {
+    chromeTraceFile = fopen(chromeTraceFileName, "w");
+    assert(chromeTraceFile != NULL);
+    cpu->addTracer(new ChromeTracer(chromeTraceFile, windowCycles, samplePeriod));
+  }
+  FILE *intervalFile = nullptr;
+  if (intervalFileName != nullptr) {
+    intervalFile = fopen(intervalFileName, binaryIntervals ? "wb" : "w");
+    assert(intervalFile != NULL);
+    cpu->enableIntervalStats(new IntervalStats(intervalFile, binaryIntervals ? IntervalStats::Binary : IntervalStats::CSV,
+                                               intervalCycles));
+  }
+  if (liveTelemetry) {
+    cpu->enableTelemetry(new Telemetry(instMemFileName, "PipelinedCPU"));
+  }
+  FILE *branchTraceFile = nullptr;
+  if (branchTraceFileName != nullptr) {
+    branchTraceFile = fopen(branchTraceFileName, "wb");
+    assert(branchTraceFile != NULL);
+    cpu->enableBranchTrace(new BranchTraceWriter(branchTraceFile));
+  }
 
-  cpu->printPVS();
-  for (size_t i = 0; i < numCycles; i++) {
+  // numCycles = 0 runs the program until it calls exit
+  if (!quiet) { cpu->printPVS(); }
+  for (size_t i = 0; (numCycles == 0 || i < numCycles) && !cpu->isHalted(); i++) {
     cpu->advanceCycle();
-    cpu->printPVS();
+    if (!quiet) { cpu->printPVS(); }
   }
+  if (quiet) { cpu->printPVS(); }
 
+  if (finalStateFileName != nullptr) {
+    FILE *finalStateFile = fopen(finalStateFileName, "w");
+    assert(finalStateFile != NULL);
+    cpu->dumpState(finalStateFile);
+    fclose(finalStateFile);
+  }
+  if (countersFileName != nullptr) {
+    FILE *countersFile = fopen(countersFileName, "w");
+    assert(countersFile != NULL);
+    cpu->getPerfCounters().writeJSON(countersFile);
+    fclose(countersFile);
+  }
+  if (profileFileName != nullptr) {
+    FILE *profileFile = fopen(profileFileName, "w");
+    assert(profileFile != NULL);
+    cpu->writeProfile(profileFile);
+    fclose(profileFile);
+  }
+
+  const int exitCode = cpu->exitCode();
   delete cpu;
+  if (intervalFile != nullptr) {
+    fclose(intervalFile);
+  }
+  if (traceFile != nullptr) {
+    fclose(traceFile);
+  }
+  if (chromeTraceFile != nullptr) {
+    fclose(chromeTraceFile);
+  }
+  if (branchTraceFile != nullptr) {
+    fclose(branchTraceFile);
+  }
 
-  return 0;
+  return exitCode;
 }
-
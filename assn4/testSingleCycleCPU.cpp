@@ -0,0 +1,114 @@
+#include "SingleCycleCPU.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <unistd.h>
+
+int main(int argc, char **argv) {
+  // options: -q (quiet; print only the final state), -s finalStateFileName (see CPU::dumpState),
+  //          -c countersFileName (the performance counters in JSON; see PerfCounters.hpp),
+  //          -i intervalFileName, -I intervalCycles, -b (the counters of every interval, in CSV or with -b
+  //          in binary; see IntervalStats.hpp),
+  //          -l (publish the counters live for mipstop; see Telemetry.hpp),
+  //          -d (execute the instruction after each branch; see SingleCycleCPU::enableDelaySlot),
+  //          -r branchTraceFileName (the branch stream for mipsbpsweep; see BranchTrace.hpp)
+  bool quiet = false;
+  const char *finalStateFileName = nullptr;
+  const char *countersFileName = nullptr;
+  const char *intervalFileName = nullptr;
+  unsigned long long intervalCycles = 10000;
+  bool binaryIntervals = false;
+  bool liveTelemetry = false;
+  bool delaySlot = false;
+  const char *branchTraceFileName = nullptr;
+  int opt;
+  while ((opt = getopt(argc, argv, "qs:c:i:I:bldr:")) != -1) {
+    switch (opt) {
+      case 'q': quiet = true; break;
+      case 's': finalStateFileName = optarg; break;
+      case 'c': countersFileName = optarg; break;
+      case 'i': intervalFileName = optarg; break;
+      case 'I': intervalCycles = strtoull(optarg, nullptr, 0); break;
+      case 'b': binaryIntervals = true; break;
+      case 'l': liveTelemetry = true; break;
+      case 'd': delaySlot = true; break;
+      case 'r': branchTraceFileName = optarg; break;
+      default: argc = 0; break;
+    }
+  }
+  if (argc - optind != 5) {
+    fprintf(stderr, "Usage: %s [-q] [-s finalStateFileName] [-c countersFileName]", argv[0]);
+    fprintf(stderr, " [-i intervalFileName [-I intervalCycles] [-b]] [-l] [-d] [-r branchTraceFileName]");
+    fprintf(stderr, " initialPC regFileName");
+    fprintf(stderr, " instMemFileName dataMemFileName numCycles\n");
+    fflush(stdout);
+    exit(-1);
+  }
+  argv += optind - 1;
+
+  const std::uint32_t initialPC = (std::uint32_t)atoll(argv[1]);
+  const char *regFileName = argv[2];
+  const char *instMemFileName = argv[3];
+  const char *dataMemFileName = argv[4];
+  const std::uint64_t numCycles = (std::uint64_t)atoll(argv[5]);
+
+  quietMode() = quiet;
+  SingleCycleCPU *cpu = new SingleCycleCPU(initialPC, regFileName, instMemFileName, dataMemFileName);
+  if (delaySlot) {
+    cpu->enableDelaySlot();
+  }
+
+  std::bitset<32> input0(0x11111111), input1(0x00101010), output0, output1;
+  cpu->ShiftLeft2<32>(&input1, &output0);
+  assert(output0.to_ulong() == 0x00404040);
+
+  FILE *intervalFile = nullptr;
+  if (intervalFileName != nullptr) {
+    intervalFile = fopen(intervalFileName, binaryIntervals ? "wb" : "w");
+    assert(intervalFile != NULL);
+    cpu->enableIntervalStats(new IntervalStats(intervalFile, binaryIntervals ? IntervalStats::Binary : IntervalStats::CSV,
+                                               intervalCycles));
+  }
+  if (liveTelemetry) {
+    cpu->enableTelemetry(new Telemetry(instMemFileName, "SingleCycleCPU"));
+  }
+  FILE *branchTraceFile = nullptr;
+  if (branchTraceFileName != nullptr) {
+    branchTraceFile = fopen(branchTraceFileName, "wb");
+    assert(branchTraceFile != NULL);
+    cpu->enableBranchTrace(new BranchTraceWriter(branchTraceFile));
+  }
+
+  // numCycles = 0 runs the program until it calls exit
+  if (!quiet) { cpu->printPVS(); }
+  for (size_t i = 0; (numCycles == 0 || i < numCycles) && !cpu->isHalted(); i++) {
+    cpu->advanceCycle();
+    if (!quiet) { cpu->printPVS(); }
+  }
+  if (quiet) { cpu->printPVS(); }
+
+  if (finalStateFileName != nullptr) {
+    FILE *finalStateFile = fopen(finalStateFileName, "w");
+    assert(finalStateFile != NULL);
+    cpu->dumpState(finalStateFile);
+    fclose(finalStateFile);
+  }
+  if (countersFileName != nullptr) {
+    FILE *countersFile = fopen(countersFileName, "w");
+    assert(countersFile != NULL);
+    cpu->getPerfCounters().writeJSON(countersFile);
+    fclose(countersFile);
+  }
+
+  const int exitCode = cpu->exitCode();
+  delete cpu;
+  if (intervalFile != nullptr) {
+    fclose(intervalFile);
+  }
+  if (branchTraceFile != nullptr) {
+    fclose(branchTraceFile);
+  }
+
+  return exitCode;
+}
@@ -0,0 +1,53 @@
+# assn1 Q1 (fibonacci) for the simulated subset: the recursion
+#   fib(n) = (n < 2) ? 1 : fib(n - 1) + fib(n - 2)
+# is unrolled with an explicit stack of pending arguments (no jal/jr).
+
+.data
+
+str2:
+  .asciiz "INFO: fibonacci returned "
+newline:
+  .asciiz "\n"
+stack:
+  .space 1024
+
+.text
+
+main:
+  li $s0, 18              # n
+  li $s1, 0               # result
+  li $s3, 2
+  la $s2, stack           # bottom of the stack
+  la $sp, stack           # the stack grows upwards
+  sw $s0, 0($sp)          # push(n)
+  addi $sp, $sp, 4
+
+fib_loop:
+  beq $sp, $s2, fib_done
+  addi $sp, $sp, -4
+  lw $a0, 0($sp)          # n = pop()
+  slt $t0, $a0, $s3
+  beq $t0, $zero, fib_recurse
+  addi $s1, $s1, 1        # fib(0) = fib(1) = 1
+  b fib_loop
+
+fib_recurse:
+  addi $a0, $a0, -1
+  sw $a0, 0($sp)          # push(n - 1)
+  addi $a0, $a0, -1
+  sw $a0, 4($sp)          # push(n - 2)
+  addi $sp, $sp, 8
+  b fib_loop
+
+fib_done:
+  li $v0, 4
+  la $a0, str2
+  syscall
+  li $v0, 1
+  move $a0, $s1
+  syscall
+  li $v0, 4
+  la $a0, newline
+  syscall
+  li $v0, 10
+  syscall
@@ -0,0 +1,46 @@
+# assn1 Q2 (findIndex) for the simulated subset: there is no lb, so the
+# string holds one character per word.
+
+.data
+
+str:
+  .word 'T', 'e', 's', 't', 'S', 't', 'r', 'i', 'n', 'g', '0', 0
+char:
+  .word '0'
+log_str0:
+  .asciiz "INFO: findIndex returned: "
+log_newline:
+  .asciiz "\n"
+
+.text
+
+main:
+  la $a0, str
+  lw $t1, char
+  li $v0, -1              # return -1 if not found
+  li $t2, 0               # index
+
+loop:
+  lw $t0, 0($a0)
+  beq $t0, $zero, end
+  beq $t0, $t1, found
+  addi $a0, $a0, 4
+  addi $t2, $t2, 1
+  b loop
+
+found:
+  move $v0, $t2
+
+end:
+  move $t0, $v0
+  li $v0, 4
+  la $a0, log_str0
+  syscall
+  li $v0, 1
+  move $a0, $t0
+  syscall
+  li $v0, 4
+  la $a0, log_newline
+  syscall
+  li $v0, 10
+  syscall
@@ -0,0 +1,41 @@
+# assn1 Q3 (lcm) for the simulated subset: there is no multu/div, so the
+# LCM is found by stepping the multiples of both integers until they meet.
+
+.data
+
+str1:
+  .asciiz "The LCM of the two integers is: "
+newline:
+  .asciiz "\n"
+
+.text
+
+main:
+  li $a0, 1234
+  li $a1, 5678
+  move $t0, $a0           # multiple of $a0
+  move $t1, $a1           # multiple of $a1
+
+loop:
+  beq $t0, $t1, done
+  slt $t2, $t0, $t1
+  beq $t2, $zero, step_a1
+  add $t0, $t0, $a0
+  b loop
+
+step_a1:
+  add $t1, $t1, $a1
+  b loop
+
+done:
+  li $v0, 4
+  la $a0, str1
+  syscall
+  li $v0, 1
+  move $a0, $t0
+  syscall
+  li $v0, 4
+  la $a0, newline
+  syscall
+  li $v0, 10
+  syscall
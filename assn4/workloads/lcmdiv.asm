@@ -0,0 +1,56 @@
+# assn1 Q3 (lcm) with the multiplier/divider: the GCD by Euclid's algorithm
+# (divu, mfhi), then LCM = a / GCD * b (divu, mflo, multu, mflo), for the
+# 300 pairs a = 1234 * i, b = 5678 + i; prints the sum of the LCMs (mod 2^32).
+
+.data
+
+str1:
+  .asciiz "The sum of the LCMs is: "
+newline:
+  .asciiz "\n"
+
+.text
+
+main:
+  li $s0, 1               # i
+  li $s1, 301             # the last i + 1
+  li $s2, 0               # sum of the LCMs
+  li $s3, 1234
+  li $s4, 5678
+
+pair:
+  multu $s0, $s3
+  mflo $a0                # a = 1234 * i
+  add $a1, $s4, $s0       # b = 5678 + i
+  move $t0, $a0
+  move $t1, $a1
+
+gcd:
+  beq $t1, $zero, found   # gcd(t0, t1) = gcd(t1, t0 mod t1)
+  divu $t0, $t1
+  move $t0, $t1
+  mfhi $t1
+  b gcd
+
+found:
+  divu $a0, $t0
+  mflo $t2                # a / GCD
+  multu $t2, $a1
+  mflo $t2                # LCM
+  add $s2, $s2, $t2
+  addi $s0, $s0, 1
+  beq $s0, $s1, done
+  b pair
+
+done:
+  li $v0, 4
+  la $a0, str1
+  syscall
+  li $v0, 1
+  move $a0, $s2
+  syscall
+  li $v0, 4
+  la $a0, newline
+  syscall
+  li $v0, 10
+  syscall
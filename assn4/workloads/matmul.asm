@@ -0,0 +1,119 @@
+# Matrix multiply kernel: C = A * B for 16x16 matrices of 3-bit values,
+# A[i][j] = (i + j) & 7 and B[i][j] = (i + 2j) & 7. There is no mult, so
+# each product is a three-step shift-and-add. Prints the sum of C.
+
+.data
+
+msg:
+  .asciiz "matmul checksum: "
+newline:
+  .asciiz "\n"
+A:
+  .space 1024
+B:
+  .space 1024
+C:
+  .space 1024
+
+.text
+
+main:
+  li $s7, 7
+  li $s6, 16
+  la $s0, A
+  la $s1, B
+  li $t0, 0               # i
+
+init_i:
+  beq $t0, $s6, init_done
+  li $t1, 0               # j
+
+init_j:
+  beq $t1, $s6, init_next_i
+  add $t2, $t0, $t1
+  and $t3, $t2, $s7
+  sw $t3, 0($s0)          # A[i][j]
+  add $t2, $t2, $t1
+  and $t3, $t2, $s7
+  sw $t3, 0($s1)          # B[i][j]
+  addi $s0, $s0, 4
+  addi $s1, $s1, 4
+  addi $t1, $t1, 1
+  b init_j
+
+init_next_i:
+  addi $t0, $t0, 1
+  b init_i
+
+init_done:
+  la $s0, A               # &A[i][0]
+  la $s2, C               # &C[i][j]
+  li $s5, 0               # checksum
+  li $t0, 0               # i
+
+mm_i:
+  beq $t0, $s6, mm_done
+  la $s1, B               # &B[0][j]
+  li $t1, 0               # j
+
+mm_j:
+  beq $t1, $s6, mm_next_i
+  move $t4, $s0           # &A[i][k]
+  move $t5, $s1           # &B[k][j]
+  li $t6, 0               # C[i][j]
+  li $t2, 0               # k
+
+mm_k:
+  beq $t2, $s6, mm_store
+  lw $a0, 0($t4)
+  lw $a1, 0($t5)
+  li $t7, 1
+  and $t8, $a1, $t7
+  beq $t8, $zero, bit1
+  add $t6, $t6, $a0
+
+bit1:
+  add $a0, $a0, $a0
+  add $t7, $t7, $t7
+  and $t8, $a1, $t7
+  beq $t8, $zero, bit2
+  add $t6, $t6, $a0
+
+bit2:
+  add $a0, $a0, $a0
+  add $t7, $t7, $t7
+  and $t8, $a1, $t7
+  beq $t8, $zero, bit3
+  add $t6, $t6, $a0
+
+bit3:
+  addi $t4, $t4, 4
+  addi $t5, $t5, 64
+  addi $t2, $t2, 1
+  b mm_k
+
+mm_store:
+  sw $t6, 0($s2)
+  add $s5, $s5, $t6
+  addi $s2, $s2, 4
+  addi $s1, $s1, 4
+  addi $t1, $t1, 1
+  b mm_j
+
+mm_next_i:
+  addi $s0, $s0, 64
+  addi $t0, $t0, 1
+  b mm_i
+
+mm_done:
+  li $v0, 4
+  la $a0, msg
+  syscall
+  li $v0, 1
+  move $a0, $s5
+  syscall
+  li $v0, 4
+  la $a0, newline
+  syscall
+  li $v0, 10
+  syscall
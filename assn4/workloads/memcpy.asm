@@ -0,0 +1,70 @@
+# memcpy kernel: copies 2048 words word-by-word (each store uses the value
+# its load just produced) and prints a checksum of the destination.
+
+.data
+
+msg:
+  .asciiz "memcpy checksum: "
+newline:
+  .asciiz "\n"
+src:
+  .space 8192
+dst:
+  .space 8192
+
+.text
+
+main:
+  la $s0, src             # src[i] = 3 * i + 1
+  li $t0, 1
+  li $t1, 2048
+
+fill:
+  beq $t1, $zero, fill_done
+  sw $t0, 0($s0)
+  addi $t0, $t0, 3
+  addi $s0, $s0, 4
+  addi $t1, $t1, -1
+  b fill
+
+fill_done:
+  la $s0, src
+  la $s1, dst
+  li $t1, 1024            # two words per iteration
+
+copy:
+  beq $t1, $zero, copy_done
+  lw $t2, 0($s0)
+  sw $t2, 0($s1)
+  lw $t3, 4($s0)
+  sw $t3, 4($s1)
+  addi $s0, $s0, 8
+  addi $s1, $s1, 8
+  addi $t1, $t1, -1
+  b copy
+
+copy_done:
+  la $s1, dst
+  li $t1, 2048
+  li $s2, 0               # checksum
+
+sum:
+  beq $t1, $zero, sum_done
+  lw $t2, 0($s1)
+  add $s2, $s2, $t2
+  addi $s1, $s1, 4
+  addi $t1, $t1, -1
+  b sum
+
+sum_done:
+  li $v0, 4
+  la $a0, msg
+  syscall
+  li $v0, 1
+  move $a0, $s2
+  syscall
+  li $v0, 4
+  la $a0, newline
+  syscall
+  li $v0, 10
+  syscall
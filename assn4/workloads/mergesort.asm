@@ -0,0 +1,135 @@
+# Sort kernel: bottom-up merge sort of 2048 words holding the permutation
+# array[i] = (i * 1237) mod 2048, followed by a check that array[i] == i.
+
+.data
+
+okmsg:
+  .asciiz "mergesort: sorted 2048 elements\n"
+badmsg:
+  .asciiz "mergesort: FAILED at index "
+newline:
+  .asciiz "\n"
+array:
+  .space 8192
+temp:
+  .space 8192
+
+.text
+
+main:
+  la $s0, array
+  li $t0, 0               # (i * 1237) mod 2048
+  li $t1, 2048
+  li $s6, 2048
+  li $s5, 1
+
+gen:
+  beq $t1, $zero, gen_done
+  sw $t0, 0($s0)
+  addi $t0, $t0, 1237
+  slt $t2, $t0, $s6
+  beq $t2, $s5, gen_next
+  sub $t0, $t0, $s6
+
+gen_next:
+  addi $s0, $s0, 4
+  addi $t1, $t1, -1
+  b gen
+
+gen_done:
+  la $s0, array           # src
+  la $s1, temp            # dst
+  li $s2, 4               # width of a run (in bytes)
+  li $s3, 8192            # size of the array (in bytes)
+
+pass:
+  slt $t0, $s2, $s3
+  beq $t0, $zero, sorted
+  li $s4, 0               # offset of the run pair
+
+run:
+  beq $s4, $s3, pass_done
+  add $t1, $s0, $s4       # p = &src[lo]
+  add $t2, $t1, $s2       # q = &src[lo + width]
+  move $t3, $t2           # end of p
+  add $t4, $t2, $s2       # end of q
+  add $t5, $s1, $s4       # out = &dst[lo]
+
+merge:
+  beq $t1, $t3, drain_q
+  beq $t2, $t4, drain_p
+  lw $t6, 0($t1)
+  lw $t7, 0($t2)
+  slt $t8, $t7, $t6
+  beq $t8, $zero, take_p
+  sw $t7, 0($t5)
+  addi $t2, $t2, 4
+  addi $t5, $t5, 4
+  b merge
+
+take_p:
+  sw $t6, 0($t5)
+  addi $t1, $t1, 4
+  addi $t5, $t5, 4
+  b merge
+
+drain_p:
+  beq $t1, $t3, run_done
+  lw $t6, 0($t1)
+  sw $t6, 0($t5)
+  addi $t1, $t1, 4
+  addi $t5, $t5, 4
+  b drain_p
+
+drain_q:
+  beq $t2, $t4, run_done
+  lw $t7, 0($t2)
+  sw $t7, 0($t5)
+  addi $t2, $t2, 4
+  addi $t5, $t5, 4
+  b drain_q
+
+run_done:
+  add $s4, $s4, $s2
+  add $s4, $s4, $s2
+  b run
+
+pass_done:
+  move $t0, $s0           # swap(src, dst)
+  move $s0, $s1
+  move $s1, $t0
+  add $s2, $s2, $s2
+  b pass
+
+sorted:
+  move $t1, $s0
+  li $t0, 0
+
+check:
+  beq $t0, $s6, check_ok
+  lw $t2, 0($t1)
+  beq $t2, $t0, check_next
+  li $v0, 4
+  la $a0, badmsg
+  syscall
+  li $v0, 1
+  move $a0, $t0
+  syscall
+  li $v0, 4
+  la $a0, newline
+  syscall
+  li $v0, 17
+  li $a0, 1
+  syscall
+
+check_next:
+  addi $t0, $t0, 1
+  addi $t1, $t1, 4
+  b check
+
+check_ok:
+  li $v0, 4
+  la $a0, okmsg
+  syscall
+  li $v0, 10
+  syscall
@@ -0,0 +1,104 @@
+# assn1 Q4 (quickSort) for the simulated subset: the recursion is replaced
+# by an explicit stack of (left, right) ranges and the string holds one
+# character per word (there is no lb/sb).
+
+.data
+
+info1:
+  .asciiz "The sorted string is: "
+newline:
+  .asciiz "\n"
+str_buf:
+  .word 't', 'h', 'i', 's', ' ', 'i', 's', ' ', 'a', ' ', 's', 't', 'r', 'i', 'n', 'g', '.'
+str_len:
+  .word 17
+stack:
+  .space 1024
+
+.text
+
+main:
+  la $a0, str_buf
+  la $s7, stack           # bottom of the stack
+  la $sp, stack           # the stack grows upwards
+  sw $zero, 0($sp)        # push(left = 0)
+  lw $t0, str_len
+  sw $t0, 4($sp)          # push(right = str_len)
+  addi $sp, $sp, 8
+
+qs_loop:
+  beq $sp, $s7, qs_done
+  addi $sp, $sp, -8
+  lw $a1, 0($sp)          # left
+  lw $a2, 4($sp)          # right
+  slt $t0, $a1, $a2
+  beq $t0, $zero, qs_loop
+
+  # partition(str, left, right) with pivot = str[right - 1]
+  addi $t0, $a2, -1
+  add $s0, $t0, $t0
+  add $s0, $s0, $s0
+  add $s0, $a0, $s0       # &str[right - 1]
+  lw $t1, 0($s0)          # pivot
+  addi $t2, $a1, -1       # index = left - 1
+  move $t3, $a1           # i = left
+  add $s2, $a1, $a1
+  add $s2, $s2, $s2
+  add $s2, $a0, $s2       # &str[i]
+  addi $s1, $s2, -4       # &str[index]
+
+part_loop:
+  slt $t4, $t3, $a2
+  beq $t4, $zero, part_end
+  lw $t6, 0($s2)
+  slt $t6, $t6, $t1       # if str[i] < pivot
+  beq $t6, $zero, part_next
+  addi $t2, $t2, 1        # index += 1
+  addi $s1, $s1, 4
+  lw $t7, 0($s1)          # swap(str[index], str[i])
+  lw $t8, 0($s2)
+  sw $t8, 0($s1)
+  sw $t7, 0($s2)
+
+part_next:
+  addi $t3, $t3, 1        # i++
+  addi $s2, $s2, 4
+  b part_loop
+
+part_end:
+  addi $t2, $t2, 1        # index += 1
+  addi $s1, $s1, 4
+  lw $t7, 0($s1)          # swap(str[index], str[right - 1])
+  lw $t8, 0($s0)
+  sw $t8, 0($s1)
+  sw $t7, 0($s0)
+  addi $t5, $t2, 1
+  sw $t5, 0($sp)          # push(index + 1, right)
+  sw $a2, 4($sp)
+  sw $a1, 8($sp)          # push(left, index)
+  sw $t2, 12($sp)
+  addi $sp, $sp, 16
+  b qs_loop
+
+qs_done:
+  li $v0, 4
+  la $a0, info1
+  syscall
+  la $s0, str_buf
+  lw $s1, str_len
+
+print_loop:
+  beq $s1, $zero, print_done
+  li $v0, 11
+  lw $a0, 0($s0)
+  syscall
+  addi $s0, $s0, 4
+  addi $s1, $s1, -1
+  b print_loop
+
+print_done:
+  li $v0, 4
+  la $a0, newline
+  syscall
+  li $v0, 10
+  syscall